@@ -36,6 +36,7 @@ TEST_DEPENDENCIES = \
 LINUX_DEPENDENCIES = \
   LIBPTHREAD \
   LIBDL \
+  LIBRT \
   LIBSNDFILE \
   LIBGSTREAMER_AUDIO
 
@@ -0,0 +1,336 @@
+/*
+ * Copyright (C) 2024 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2024 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of damage-detector
+ * Created on: 18 окт. 2026 г.
+ *
+ * damage-detector is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * damage-detector is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with damage-detector. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef DAMAGE_DETECTOR_DAMAGE_DETECTOR_H_
+#define DAMAGE_DETECTOR_DAMAGE_DETECTOR_H_
+
+/*
+ * Plain C interface of the damage detector for embedding it outside GStreamer.
+ *
+ * All functions taking the detector handle are not thread-safe for the same handle,
+ * different handles can be used by different threads simultaneously. Audio buffers
+ * are owned by the caller and are accessed only during the call.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(__GNUC__) && (__GNUC__ >= 4)
+    #define DD_API                      __attribute__((visibility("default")))
+#else
+    #define DD_API
+#endif
+
+/* Version of the interface, changed only on incompatible changes of the ABI */
+#define DD_ABI_VERSION              1
+
+/* Units of the rate-independent time per second, see dd_time() */
+#define DD_TIME_UNITS               705600000
+
+/* NUMA nodes of the arena, see dd_arena_create() */
+#define DD_NODE_CURRENT             (-1)    /* Node of the calling thread */
+#define DD_NODE_ANY                 (-2)    /* Memory is not placed on the specific node */
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+typedef struct dd_detector dd_detector_t;
+typedef struct dd_arena dd_arena_t;
+
+/* Status codes */
+enum
+{
+    DD_OK               = 0,        /* Success */
+    DD_EBADARG          = -1,       /* Invalid argument */
+    DD_ENOMEM           = -2        /* Not enough memory */
+};
+
+/* Flags of the arena, see dd_arena_create() */
+enum
+{
+    DD_ARENA_HUGE_PAGES = 1 << 0,   /* Back the arena with huge pages if the system allows */
+    DD_ARENA_NUMA_BIND  = 1 << 1    /* Place the memory of the arena on its NUMA node */
+};
+
+/* Types of the stream corruption state notification */
+typedef enum dd_event_type_t
+{
+    DD_EVENT_NONE       = 0,        /* No event */
+    DD_EVENT_ABOVE      = 1,        /* The number of corruption events is above the threshold */
+    DD_EVENT_BELOW      = 2         /* The number of corruption events is below the threshold */
+} dd_event_type_t;
+
+/* Parameters of the detector, the value range matches the GStreamer element properties */
+typedef enum dd_param_t
+{
+    DD_PARAM_THRESHOLD      = 0,    /* RMS signal trigger threshold, dB */
+    DD_PARAM_REACTIVITY     = 1,    /* Time period of the RMS value calculation, ms */
+    DD_PARAM_DETECT_TIME    = 2,    /* Corruption detection time, s */
+    DD_PARAM_ESTIMATE_TIME  = 3,    /* Estimation time window of the number of events, s */
+    DD_PARAM_EV_THRESHOLD   = 4,    /* Number of events which triggers the notification */
+    DD_PARAM_EV_PERIOD      = 5,    /* Notification repeat period, s */
+    DD_PARAM_BYPASS         = 6,    /* Pass the input signal to the output: 0 or 1 */
+    DD_PARAM_CLICKS         = 7,    /* Detection of clicks and discontinuities: 0 or 1 */
+    DD_PARAM_CLICK_RATIO    = 8,    /* Click detection ratio, dB */
+    DD_PARAM_FLAT_TIME      = 9,    /* Minimum duration of the flatline, s */
+    DD_PARAM_GAP_EVENTS     = 10,   /* Count gaps as corruption events: 0 or 1 */
+    DD_PARAM_ADAPTIVE       = 11,   /* Adaptive threshold: 0 or 1 */
+    DD_PARAM_ADAPT_QUANTILE = 12,   /* Quantile of the noise floor, % */
+    DD_PARAM_ADAPT_OFFSET   = 13,   /* Offset of the adaptive threshold, dB */
+    DD_PARAM_ADAPT_TIME     = 14,   /* Time window of the noise floor estimation, s */
+    DD_PARAM_LINKED         = 15,   /* Analyze adjacent channels as linked pairs: 0 or 1 */
+    DD_PARAM_HYSTERESIS     = 16,   /* Close threshold relative to the open threshold, dB */
+    DD_PARAM_OPEN_DEBOUNCE  = 17,   /* Time above the threshold to open the trigger, ms, negative for 1/10 of reactivity */
+    DD_PARAM_CLOSE_DEBOUNCE = 18    /* Time below the close threshold to close the trigger, ms, negative for 1/10 of reactivity */
+} dd_param_t;
+
+/* Notification about the stream corruption state */
+typedef struct dd_event_t
+{
+    int32_t             type;       /* Type of the event, dd_event_type_t */
+    uint32_t            events;     /* Number of events for the estimation time */
+    uint64_t            timestamp;  /* Timestamp of the notification in samples */
+} dd_event_t;
+
+/* Notification about the flatline */
+typedef struct dd_flatline_t
+{
+    uint32_t            channel;    /* Audio channel */
+    int32_t             active;     /* 1 if the flatline has started, 0 if it has finished */
+    float               value;      /* Constant value of the signal */
+    uint32_t            reserved;   /* Reserved, always zero */
+    uint64_t            start;      /* Start of the flatline in samples */
+} dd_flatline_t;
+
+/*
+ * Callback for immediate delivery of the notifications, called from the processing
+ * function, see dd_set_event_callback()
+ */
+typedef void (*dd_event_callback_t)(void *arg, const dd_event_t *event);
+
+/**
+ * Get the version of the library
+ * @return version in the form of (major << 16) | (minor << 8) | micro
+ */
+DD_API uint32_t dd_version(void);
+
+/**
+ * Get the version of the interface
+ * @return DD_ABI_VERSION the library has been built with
+ */
+DD_API uint32_t dd_abi_version(void);
+
+/**
+ * Create the detector with default settings
+ * @param channels number of audio channels, should be positive
+ * @param sample_rate sample rate, should be positive
+ * @return the detector or NULL on error
+ */
+DD_API dd_detector_t *dd_create(uint32_t channels, uint32_t sample_rate);
+
+/**
+ * Create the detector with default settings, the state of the detector is allocated
+ * from the arena, so many detectors processed by the same thread share few memory pages
+ * placed on the NUMA node of that thread
+ * @param arena the arena, NULL to allocate the state from the heap like dd_create()
+ * @param channels number of audio channels, should be positive
+ * @param sample_rate sample rate, should be positive
+ * @return the detector or NULL on error
+ */
+DD_API dd_detector_t *dd_create_in_arena(dd_arena_t *arena, uint32_t channels, uint32_t sample_rate);
+
+/**
+ * Destroy the detector
+ * @param dd the detector, may be NULL
+ */
+DD_API void dd_destroy(dd_detector_t *dd);
+
+/**
+ * Create the arena for the state of detectors. Memory is mapped by chunks of 2 MiB and is
+ * returned to the system only when the arena is destroyed. The arena is thread-safe, but
+ * for the best locality each processing thread should use its own arena created by this
+ * thread with DD_NODE_CURRENT.
+ * @param node NUMA node to place the memory on, DD_NODE_CURRENT for the node of the calling
+ *   thread or DD_NODE_ANY
+ * @param flags combination of DD_ARENA_HUGE_PAGES and DD_ARENA_NUMA_BIND
+ * @return the arena or NULL on error
+ */
+DD_API dd_arena_t *dd_arena_create(int32_t node, uint32_t flags);
+
+/**
+ * Destroy the arena, all detectors created in the arena should be destroyed before
+ * @param arena the arena, may be NULL
+ */
+DD_API void dd_arena_destroy(dd_arena_t *arena);
+
+/**
+ * Get the NUMA node of the arena
+ * @param arena the arena
+ * @return the NUMA node or DD_NODE_ANY if the node is unknown
+ */
+DD_API int32_t dd_arena_node(const dd_arena_t *arena);
+
+/**
+ * Get the amount of memory mapped by the arena
+ * @param arena the arena
+ * @return number of bytes mapped
+ */
+DD_API uint64_t dd_arena_mapped(const dd_arena_t *arena);
+
+/**
+ * Get number of audio channels
+ * @param dd the detector
+ * @return number of audio channels
+ */
+DD_API uint32_t dd_channels(const dd_detector_t *dd);
+
+/**
+ * Change the sample rate, the state of the detector and detected events are kept,
+ * the timestamp is converted to the new sample rate
+ * @param dd the detector
+ * @param sample_rate the sample rate
+ * @return status code
+ */
+DD_API int dd_set_sample_rate(dd_detector_t *dd, uint32_t sample_rate);
+
+/**
+ * Set the parameter, the value is limited to the allowed range
+ * @param dd the detector
+ * @param param the parameter
+ * @param value the value of the parameter
+ * @return status code
+ */
+DD_API int dd_set_param(dd_detector_t *dd, dd_param_t param, double value);
+
+/**
+ * Get the parameter
+ * @param dd the detector
+ * @param param the parameter
+ * @param value pointer to store the value
+ * @return status code
+ */
+DD_API int dd_get_param(const dd_detector_t *dd, dd_param_t param, double *value);
+
+/**
+ * Process planar audio data. Output buffers are filled with the input signal if the
+ * bypass is enabled, the trigger state otherwise. Output buffers may be the same as
+ * input buffers. If the output is not needed, NULL may be passed instead of the list,
+ * the output is then written to the internal buffer by the chunks of the limited size.
+ * @param dd the detector
+ * @param in list of input buffers, one per channel
+ * @param out list of output buffers, one per channel, may be NULL
+ * @param samples number of samples in each buffer
+ * @return status code
+ */
+DD_API int dd_process_planar(dd_detector_t *dd, const float * const *in, float * const *out, size_t samples);
+
+/**
+ * Process interleaved audio data, the output may be the same as the input or NULL
+ * if the output is not needed
+ * @param dd the detector
+ * @param in interleaved input buffer
+ * @param out interleaved output buffer, may be NULL
+ * @param frames number of frames in the buffer
+ * @return status code
+ */
+DD_API int dd_process_interleaved(dd_detector_t *dd, const float *in, float *out, size_t frames);
+
+/**
+ * Account the gap in the stream
+ * @param dd the detector
+ * @param samples the length of the gap in samples
+ * @return status code
+ */
+DD_API int dd_process_gap(dd_detector_t *dd, size_t samples);
+
+/**
+ * Poll the pending notification about the stream corruption state
+ * @param dd the detector
+ * @param event pointer to store the notification
+ * @return 1 if the notification has been stored, 0 if there is no pending notification,
+ *   negative status code on error
+ */
+DD_API int dd_poll_event(dd_detector_t *dd, dd_event_t *event);
+
+/**
+ * Set the callback for immediate delivery of notifications. The crossing of the event
+ * threshold is delivered with the timestamp of the sample which has generated the event.
+ * The callback is called from the processing function, so it should not block.
+ * Notifications are not available for polling while the callback is set.
+ * @param dd the detector
+ * @param callback the callback, NULL to deliver notifications by polling
+ * @param arg the argument passed to the callback
+ * @return status code
+ */
+DD_API int dd_set_event_callback(dd_detector_t *dd, dd_event_callback_t callback, void *arg);
+
+/**
+ * Poll the pending notification about the flatline
+ * @param dd the detector
+ * @param event pointer to store the notification
+ * @return 1 if the notification has been stored, 0 if there is no pending notification,
+ *   negative status code on error
+ */
+DD_API int dd_poll_flatline(dd_detector_t *dd, dd_flatline_t *event);
+
+/**
+ * Get the position of the stream in samples of the current sample rate
+ * @param dd the detector
+ * @return position of the stream in samples
+ */
+DD_API uint64_t dd_timestamp(const dd_detector_t *dd);
+
+/**
+ * Get the monotonic time of processing which does not depend on the sample rate
+ * @param dd the detector
+ * @return processing time in DD_TIME_UNITS per second
+ */
+DD_API uint64_t dd_time(const dd_detector_t *dd);
+
+/**
+ * Get the current number of corruption events for the estimation time
+ * @param dd the detector
+ * @return number of events
+ */
+DD_API uint32_t dd_events_count(const dd_detector_t *dd);
+
+/**
+ * Get the total number of corruption events since the creation of the detector
+ * @param dd the detector
+ * @return number of events
+ */
+DD_API uint64_t dd_total_events(const dd_detector_t *dd);
+
+/**
+ * Get the number of corruption events coalesced in the event storm mode since the creation
+ * of the detector, these events are included into the total number of events
+ * @param dd the detector
+ * @return number of coalesced events
+ */
+DD_API uint64_t dd_coalesced_events(const dd_detector_t *dd);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* DAMAGE_DETECTOR_DAMAGE_DETECTOR_H_ */
@@ -0,0 +1,143 @@
+/*
+ * Copyright (C) 2024 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2024 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of damage-detector
+ * Created on: 18 окт. 2026 г.
+ *
+ * damage-detector is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * damage-detector is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with damage-detector. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef PRIVATE_ARENA_H_
+#define PRIVATE_ARENA_H_
+
+#include <lsp-plug.in/common/types.h>
+#include <lsp-plug.in/common/status.h>
+#include <lsp-plug.in/ipc/Mutex.h>
+
+namespace dd
+{
+    enum arena_flags_t
+    {
+        ARENA_HUGE_PAGES    = 1 << 0,   // Back chunks with huge pages if the system allows
+        ARENA_NUMA_BIND     = 1 << 1    // Place chunks on the NUMA node of the arena
+    };
+
+    /**
+     * Arena for the state of many detectors. Memory is mapped by large chunks which
+     * can be backed by huge pages and placed on the NUMA node of the thread that
+     * processes the detectors, so hundreds of instances share few TLB entries and
+     * do not access the remote memory.
+     *
+     * The size of allocated blocks is rounded up to the power of two, released blocks
+     * are reused by the next allocations of the same size. Memory is returned to the
+     * system only when the arena is destroyed. The arena is thread-safe.
+     */
+    class Arena
+    {
+        public:
+            static constexpr size_t     CHUNK_SIZE      = 0x200000; // Size of the chunk, the size of the huge page on x86
+            static constexpr size_t     MIN_BLOCK       = 0x1000;   // Minimum size of the block
+            static constexpr size_t     ALIGN           = 0x40;     // Alignment of allocated memory
+            static constexpr ssize_t    NODE_CURRENT    = -1;       // NUMA node of the calling thread
+            static constexpr ssize_t    NODE_ANY        = -2;       // Do not place memory on the specific node
+
+        private:
+            static constexpr size_t     CLASSES         = 9;        // Number of size classes from MIN_BLOCK to CHUNK_SIZE / 2
+
+            typedef struct chunk_t
+            {
+                chunk_t            *pNext;      // Next chunk
+                size_t              nSize;      // Size of the chunk
+                void               *pData;      // Pointer to release the chunk
+            } chunk_t;
+
+            typedef struct block_t
+            {
+                block_t            *pNext;      // Next free block of the same size class
+                size_t              nSize;      // Size of the block including the header
+            } block_t;
+
+        private:
+            lsp::ipc::Mutex     sLock;
+            chunk_t            *pChunks;        // List of mapped chunks
+            uint8_t            *pHead;          // Free space of the last chunk
+            size_t              nLeft;          // Size of the free space of the last chunk
+            block_t            *vFree[CLASSES]; // Released blocks by size classes
+            block_t            *pLarge;         // Released blocks larger than the chunk
+            ssize_t             nNode;          // NUMA node
+            size_t              nFlags;         // Flags
+            size_t              nMapped;        // Number of mapped bytes
+            size_t              nHuge;          // Number of bytes backed by huge pages
+            size_t              nUsed;          // Number of bytes in allocated blocks
+
+        protected:
+            chunk_t            *map_chunk(size_t size);
+            void                unmap_chunk(chunk_t *chunk);
+            void                release_tail();
+            static size_t       size_class(size_t size);
+
+        public:
+            Arena();
+            Arena(const Arena &) = delete;
+            Arena(Arena &&) = delete;
+            ~Arena();
+
+            Arena & operator = (const Arena &) = delete;
+            Arena & operator = (Arena &&) = delete;
+
+        public:
+            /**
+             * Initialize the arena
+             * @param node NUMA node to place memory on, NODE_CURRENT for the node of the calling thread
+             * @param flags combination of arena_flags_t
+             * @return status of operation
+             */
+            lsp::status_t       init(ssize_t node, size_t flags);
+
+            /**
+             * Destroy the arena and release all memory, allocated blocks become invalid
+             */
+            void                destroy();
+
+            /**
+             * Allocate the block aligned to ALIGN bytes
+             * @param size size of the block
+             * @return pointer to the block or NULL if there is not enough memory
+             */
+            void               *alloc(size_t size);
+
+            /**
+             * Release the block allocated by this arena
+             * @param ptr pointer to the block, may be NULL
+             */
+            void                free(void *ptr);
+
+        public:
+            inline ssize_t      node() const        { return nNode; }
+            inline size_t       flags() const       { return nFlags; }
+            inline size_t       mapped() const      { return nMapped; }
+            inline size_t       huge() const        { return nHuge; }
+            inline size_t       used() const        { return nUsed; }
+
+            /**
+             * Get the NUMA node of the calling thread
+             * @return the NUMA node or NODE_ANY if it is unknown
+             */
+            static ssize_t      current_node();
+    };
+
+} /* namespace dd */
+
+#endif /* PRIVATE_ARENA_H_ */
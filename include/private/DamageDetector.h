@@ -25,6 +25,14 @@
 #include <lsp-plug.in/common/types.h>
 #include <lsp-plug.in/dsp-units/util/Sidechain.h>
 
+#include <private/types.h>
+#include <private/Arena.h>
+#include <private/EnvelopeIndex.h>
+#include <private/EventJournal.h>
+#include <private/EventWindows.h>
+#include <private/LogHistogram.h>
+#include <private/P2Quantile.h>
+
 namespace dd
 {
     enum event_type_t
@@ -34,7 +42,46 @@ namespace dd
         EVENT_BELOW     // The number of stream corruptions is below the threshold
     };
 
-    typedef uint64_t            timestamp_t;
+    enum histogram_t
+    {
+        HIST_DROPOUT,   // Duration of dropouts: from the level drop to the level recovery
+        HIST_INTERVAL,  // Interval between two consecutive events of the channel
+        HIST_DELAY,     // Delay between the level drop and the dropout event
+
+        HIST_TOTAL
+    };
+
+    typedef struct flatline_t
+    {
+        uint32_t        nChannel;       // Audio channel
+        bool            bActive;        // true if flatline has started, false if it has finished
+        float           fValue;         // Constant value of the signal
+        timestamp_t     nStart;         // Start of the flatline in samples
+    } flatline_t;
+
+    typedef struct notification_t
+    {
+        event_type_t    enType;         // Type of the event
+        uint32_t        nEvents;        // Number of events for the estimation time
+        timestamp_t     nTimestamp;     // Sample at which the event has been generated
+    } notification_t;
+
+    /**
+     * Listener of changes of the stream corruption state. The listener is called by the
+     * processing thread right from the processing routine, so it should not block
+     */
+    class IEventListener
+    {
+        public:
+            virtual ~IEventListener();
+
+        public:
+            /**
+             * Handle the change of the stream corruption state
+             * @param event the notification
+             */
+            virtual void    on_event(const notification_t *event) = 0;
+    };
 
     class DamageDetector
     {
@@ -63,7 +110,62 @@ namespace dd
 
             static constexpr size_t DFL_EV_TRHESHOLD    = 10;
 
+            static constexpr float  MIN_CLICK_RATIO     = 6.0f;
+            static constexpr float  MAX_CLICK_RATIO     = 60.0f;
+            static constexpr float  DFL_CLICK_RATIO     = 30.0f;
+
+            static constexpr float  MIN_FLAT_TIME       = 0.1f;
+            static constexpr float  MAX_FLAT_TIME       = 600.0f;
+            static constexpr float  DFL_FLAT_TIME       = 2.0f;
+
+            static constexpr float  MIN_ADAPT_QUANTILE  = 1.0f;
+            static constexpr float  MAX_ADAPT_QUANTILE  = 50.0f;
+            static constexpr float  DFL_ADAPT_QUANTILE  = 10.0f;
+
+            static constexpr float  MIN_ADAPT_OFFSET    = -60.0f;
+            static constexpr float  MAX_ADAPT_OFFSET    = 0.0f;
+            static constexpr float  DFL_ADAPT_OFFSET    = -20.0f;
+
+            static constexpr float  MIN_ADAPT_TIME      = 1.0f;
+            static constexpr float  MAX_ADAPT_TIME      = 600.0f;
+            static constexpr float  DFL_ADAPT_TIME      = 60.0f;
+
+            static constexpr float  MIN_HYSTERESIS      = 0.0f;
+            static constexpr float  MAX_HYSTERESIS      = 20.0f;
+            static constexpr float  DFL_HYSTERESIS      = 0.0f;
+
+            static constexpr float  MIN_DEBOUNCE        = 0.0f;
+            static constexpr float  MAX_DEBOUNCE        = 500.0f;
+            static constexpr float  DFL_DEBOUNCE        = -1.0f;    // Derived from the reactivity
+
+            static constexpr float  MIN_HIST_PERIOD     = 0.0f;
+            static constexpr float  MAX_HIST_PERIOD     = 3600.0f;
+            static constexpr float  DFL_HIST_PERIOD     = 0.0f;
+
+            static constexpr size_t STORM_FACTOR        = 16;       // Events of the channel relative to the event threshold to enter the storm mode
+            static constexpr size_t STORM_MIN_EVENTS    = 0x100;    // Minimum number of events of the channel to enter the storm mode
+
         private:
+            enum flat_state_t
+            {
+                FLAT_NONE,      // Signal is not constant
+                FLAT_RUN,       // Signal is constant for less than flatline time
+                FLAT_ACTIVE     // Signal is constant for more than flatline time, flatline reported
+            };
+
+            enum flat_notify_t
+            {
+                FLAT_NOTIFY_START   = 1 << 0,
+                FLAT_NOTIFY_END     = 1 << 1
+            };
+
+            enum link_state_t
+            {
+                LINK_NONE,      // Channels of the pair are consistent
+                LINK_IMBALANCE, // One channel of the pair has dropped while the other one stays active
+                LINK_PHASE      // Channels of the pair are in the opposite phase
+            };
+
             enum trg_state_t
             {
                 TRG_CLOSED,
@@ -75,6 +177,7 @@ namespace dd
             typedef struct event_t
             {
                 timestamp_t             nTimestamp;
+                uint32_t                nWeight;        // Number of events coalesced into the entry
             } event_t;
 
             typedef struct event_buf_t
@@ -82,51 +185,147 @@ namespace dd
                 event_t    *vData;
                 uint32_t    nHead;
                 uint32_t    nTail;
-                uint32_t    nCount;
+                uint32_t    nItems;     // Number of entries in the buffer
+                uint32_t    nCount;     // Number of events in the buffer, sum of weights of entries
             } event_buf_t;
 
+            // Cold per-channel data
             typedef struct channel_t
             {
                 lsp::dspu::Sidechain    sSC;
                 event_buf_t             sEvBuf;
-                timestamp_t             nOpenTime;
-                timestamp_t             nCloseTime;
-                timestamp_t             nRaiseTime;     // Last time the signal went above threshold
-                timestamp_t             nFallTime;      // Last time the signal went below threshold
-                uint32_t                nEvents;        // Number of computed events
-                trg_state_t             enState;        // State of the trigger
+                P2Quantile              sFloor;         // Estimator of the noise floor of the RMS envelope
+
+                LogHistogram            vHistograms[HIST_TOTAL];    // Histograms of event timings in microseconds
+                timestamp_t             nLastEvent;     // Timestamp of the last event of the channel
+                uint32_t                nStorm;         // Number of events coalesced in the current block, saturating
+                bool                    bEvent;         // At least one event has been detected
+                bool                    bDropout;       // The dropout event is waiting for the level recovery
+                bool                    bStorm;         // The channel is in the event storm mode
 
+                float                   fEnvSum;        // Sum of the envelope since the last floor update
+                uint32_t                nEnvCount;      // Number of samples since the last floor update
                 const float            *vIn;            // Input buffer
                 float                  *vOut;           // Output buffer
             } channel_t;
 
+            // Hot trigger state of all channels, one contiguous array per field
+            typedef struct trigger_t
+            {
+                trg_state_t            *vState;         // State of the trigger
+                float                  *vThreshold;     // Trigger threshold
+                timestamp_t            *vRaiseTime;     // Last time the signal went above threshold
+                timestamp_t            *vFallTime;      // Last time the signal went below threshold
+                timestamp_t            *vOpenTime;      // Last time the trigger has opened
+                timestamp_t            *vCloseTime;     // Last time the trigger has closed
+                float                  *vDepth;         // Minimum RMS level after the signal went below threshold
+                uint32_t               *vEvents;        // Number of computed events
+                float                  *vClickLevel;    // Average level of the third-order difference
+                float                  *vClickSum;      // Sum of the difference magnitude for the current level period
+                timestamp_t            *vClickHold;     // Time until which the next click is not reported
+                float                  *vClickHist;     // Last three input samples, stride is CLICK_HIST_STRIDE
+                uint32_t               *vFlatState;     // State of the flatline detector, see flat_state_t
+                uint32_t               *vFlatNotify;    // Pending flatline notifications, see flat_notify_t
+                float                  *vFlatValue;     // Value of the constant signal
+                timestamp_t            *vFlatStart;     // Start of the constant signal
+            } trigger_t;
+
+            // State of the linked pair of channels
+            typedef struct link_t
+            {
+                link_state_t            enState;        // State of the pair
+                uint32_t                nChannel;       // Channel which has caused the anomaly
+                timestamp_t             nStart;         // Start of the anomaly
+                float                   fCorr;          // Smoothed correlation of channels
+                float                   fValue;         // Extreme value of the metric during the anomaly
+                float                   fSumL;          // Sum of squares of the left channel for the current window
+                float                   fSumR;          // Sum of squares of the right channel for the current window
+                float                   fSumLR;         // Sum of products of channels for the current window
+                uint32_t                nCount;         // Number of samples accumulated for the current window
+                bool                    bActive;        // Both channels were above the threshold in the last window
+            } link_t;
+
         private:
             channel_t      *vChannels;      // Audio channels
+            trigger_t       sTrigger;       // Trigger state of audio channels
+            link_t         *vLinks;         // State of linked pairs of channels
+            EventWindows    sWindows;       // Event counters for multiple time windows
             float          *vBuffer;        // Temporary buffer for processing
+            float          *vDiff;          // Third-order difference of the input signal
+            float          *vHist;          // Input signal prepended with the history for computing difference
+            float          *vZero;          // Buffer of zeros used as input during gaps
+            float          *vScratch;       // Output buffer used during gaps
+            float          *vMid;           // Mid signal of the linked pair of channels
+            EventJournal   *pJournal;       // Event journal
+            EnvelopeIndex  *pIndex;         // Envelope index
+            IEventListener *pListener;      // Listener of immediate notifications
             timestamp_t     nTimestamp;     // Audio processing timestamp
+            timestamp_t     nTimeBase;      // Rate-independent time at the last sample rate change
+            timestamp_t     nTimeStart;     // Timestamp at the last sample rate change
+            timestamp_t     nSettleTime;    // The trigger does not close until this timestamp
             timestamp_t     nLastNotify;    // Last notification time
+            timestamp_t     nGapStart;      // Start of the current gap in the stream
+            timestamp_t     nLastEvent;     // Timestamp of the last event
+            timestamp_t     nLastHist;      // Last time the histograms were exported
+            uint64_t        nTotalEvents;   // Total number of events since the start
+            uint64_t        nCoalesced;     // Total number of events coalesced in the storm mode
             uint32_t        nChannels;      // Number of channels
             uint32_t        nSampleRate;    // Sample rate
             uint32_t        nDetectTime;    // Detection time in samples
-            uint32_t        nBounceTime;    // Raise/Fall detection time
+            uint32_t        nOpenTime;      // Time the signal should stay above the open threshold to open the trigger
+            uint32_t        nCloseTime;     // Time the signal should stay below the close threshold to close the trigger
             uint32_t        nEstimateTime;  // Overall estimation time
             uint32_t        nEventPeriod;   // Event period
             uint32_t        nEventThreshold;// Event threshold
+            uint32_t        nStormEvents;   // Number of events of the channel to enter the storm mode
+            uint32_t        nClickHold;     // Minimum interval between two clicks in samples
+            uint32_t        nFlatTime;      // Flatline detection time in samples
+            uint32_t        nFlatSkip;      // Length of constant signal after which the envelope is not computed
+            uint32_t        nAdaptPeriod;   // Period of the noise floor estimator update in samples
+            uint32_t        nHistPeriod;    // Histogram export period in samples
+            float           fClickRatioDB;  // Click detection ratio (in decibels)
+            float           fClickRatio;    // Click detection ratio
+            float           fClickLevelTime;// Averaging time of the difference level in samples
+            float           fClickLevelK;   // Smoothing factor of the difference level per level period
+            float           fFlatTime;      // Flatline detection time
+            float           fAdaptQuantile; // Noise floor quantile (in percents)
+            float           fAdaptOffsetDB; // Threshold offset relative to the noise floor (in decibels)
+            float           fAdaptOffset;   // Threshold offset relative to the noise floor
+            float           fAdaptTime;     // Noise floor estimation window in seconds
+            float           fThresholdMin;  // Minimum possible threshold
+            float           fHistPeriod;    // Histogram export period in seconds
             float           fDetectTime;    // Detection time in milliseconds
             float           fThresholdDB;   // Threshold (in decibels)
             float           fThreshold;     // Threshold
+            float           fHysteresisDB;  // Close threshold relative to the open threshold (in decibels)
+            float           fHysteresis;    // Ratio of the close threshold to the open threshold
+            float           fOpenDebounce;  // Open debounce time in milliseconds, negative if derived from the reactivity
+            float           fCloseDebounce; // Close debounce time in milliseconds, negative if derived from the reactivity
             float           fReactivity;    // Reactivity
             float           fEstimateTime;  // Estimation time
             float           fEventPeriod;   // Event period
             event_type_t    enLastEvent;    // Last delivered event
             event_type_t    enPendingEvent; // Pending event
             bool            bBypass;        // Bypass
+            bool            bClicks;        // Click detection
+            bool            bGapEvents;     // Count gaps as corruption events
+            bool            bGap;           // Gap in the stream is in progress
+            bool            bAdaptive;      // Adaptive threshold
+            bool            bAdaptReset;    // Reset the noise floor estimators
+            bool            bLinked;        // Linked pairs of channels
             bool            bUpdate;        // Update data
 
+            Arena          *pArena;         // Arena the state has been allocated from
             uint8_t        *pData;
 
         public:
-            DamageDetector(size_t channels);
+            /**
+             * Create the detector
+             * @param channels number of channels
+             * @param arena arena to allocate the state from, NULL to allocate it from the heap,
+             *   the arena should outlive the detector
+             */
+            explicit DamageDetector(size_t channels, Arena *arena = NULL);
             DamageDetector(const DamageDetector &) = delete;
             DamageDetector(DamageDetector &&) = delete;
             ~DamageDetector();
@@ -136,9 +335,38 @@ namespace dd
 
         private:
             void            update_settings();
-            void            generate_events(channel_t *c, size_t to_do);
-            size_t          push_event(event_buf_t *buf, timestamp_t ts);
+            void            generate_events(size_t channel, size_t samples);
+            void            compute_diff(size_t channel, const float *src, size_t samples);
+            void            detect_clicks(size_t channel, size_t samples);
+            bool            submit_event(size_t channel, timestamp_t ts);
+            void            submit_dropout(size_t channel, timestamp_t start, timestamp_t ts, float depth);
+            void            finish_dropout(size_t channel, timestamp_t start, timestamp_t end);
+            inline uint64_t to_micros(timestamp_t samples) const   { return (samples * 1000000) / nSampleRate; }
+            timestamp_t     rescale(timestamp_t ts, timestamp_t now, size_t old_rate, size_t new_rate) const;
+            void            report_flatline(size_t channel, timestamp_t now);
+            void            start_flatline(size_t channel, float value, timestamp_t start);
+            bool            check_flatline(size_t channel, const float *src, size_t samples);
+            void            process_flatline(size_t channel, size_t samples);
+            void            process_pair(size_t channel, size_t samples);
+            void            analyze_link(size_t channel, const float *left, const float *right, size_t samples);
+            void            evaluate_link(size_t channel, timestamp_t ts);
+            bool            phase_flip(size_t channel) const;
+            void            finish_link(link_t *link, timestamp_t ts);
+            void            reset_links();
+            static void     clear_link_window(link_t *link);
+            void            decay_clicks(size_t channel, size_t samples);
+            float           update_click_level(float level, float sum) const;
+            void            advance_silence(size_t channel, size_t samples);
+            void            finish_gap();
+            void            update_notification();
+            void            notify(event_type_t type, timestamp_t ts);
+            void            update_threshold(size_t channel, size_t samples);
+            float           adaptive_threshold(size_t channel) const;
+            size_t          push_event(event_buf_t *buf, timestamp_t ts, uint32_t weight);
             void            update_event_buf(event_buf_t *buf, timestamp_t ts);
+            void            finish_events(size_t channel);
+
+            void            process_channels(size_t samples);
 
         private:
             static void     clear_event_buf(event_buf_t *buf);
@@ -151,7 +379,21 @@ namespace dd
             inline timestamp_t timestamp() const        { return nTimestamp; }
 
             /**
-             * Set processing sample rate
+             * Get rate-independent time of processing. Unlike the timestamp, the time
+             * is monotonic and does not jump when the sample rate changes
+             * @return processing time in TIME_UNITS per second
+             */
+            timestamp_t     time() const;
+
+            /**
+             * Get number of audio channels
+             * @return number of audio channels
+             */
+            inline size_t   channels() const            { return nChannels; }
+
+            /**
+             * Set processing sample rate. The history of the detector is kept: the timestamp
+             * and stored timestamps of events are converted to the new sample rate
              * @param sample_rate processing sample rate
              */
             void            set_sample_rate(size_t sample_rate);
@@ -169,7 +411,7 @@ namespace dd
              * @param est_time estimation time window in seconds
              */
             void            set_estimation_time(float est_time);
-            inline float    estimation_time() const { return nEstimateTime; }
+            inline float    estimation_time() const { return fEstimateTime; }
 
             /**
              * Set trigger threshold
@@ -178,6 +420,45 @@ namespace dd
             void            set_threshold(float thresh);
             inline float    threshold() const { return fThresholdDB; }
 
+            /**
+             * Get actual trigger threshold of the audio channel. It differs from the
+             * configured threshold when the adaptive threshold is enabled
+             * @param channel audio channel index
+             * @return actual trigger threshold in decibels
+             */
+            float           channel_threshold(size_t channel) const;
+
+            /**
+             * Enable/disable adaptive threshold. The adaptive threshold tracks the low quantile
+             * of the RMS envelope (the noise floor of the programme) for each channel and is placed
+             * at the specified offset relative to it. The configured threshold is used until the
+             * estimator collects enough data
+             * @param enable enable adaptive threshold
+             */
+            void            set_adaptive(bool enable);
+            inline bool     adaptive() const { return bAdaptive; }
+
+            /**
+             * Set the quantile of the RMS envelope considered to be the noise floor
+             * @param quantile quantile in percents
+             */
+            void            set_adaptive_quantile(float quantile);
+            inline float    adaptive_quantile() const { return fAdaptQuantile; }
+
+            /**
+             * Set the offset of the adaptive threshold relative to the noise floor
+             * @param offset offset in decibels
+             */
+            void            set_adaptive_offset(float offset);
+            inline float    adaptive_offset() const { return fAdaptOffsetDB; }
+
+            /**
+             * Set the time window of the noise floor estimation
+             * @param time time window in seconds
+             */
+            void            set_adaptive_time(float time);
+            inline float    adaptive_time() const { return fAdaptTime; }
+
             /**
              * Enable/disable bypass
              * @param bypass bypass flag
@@ -192,6 +473,29 @@ namespace dd
             void            set_reactivity(float reactivity);
             inline float    reactivity() const { return fReactivity; }
 
+            /**
+             * Set the hysteresis of the trigger: the trigger opens when the RMS value goes above
+             * the threshold and closes when it goes below the threshold lowered by the hysteresis,
+             * so the signal fluctuating around the threshold does not cause chatter
+             * @param hysteresis hysteresis in decibels
+             */
+            void            set_hysteresis(float hysteresis);
+            inline float    hysteresis() const { return fHysteresisDB; }
+
+            /**
+             * Set the time the RMS value should stay above the open threshold to open the trigger
+             * @param debounce debounce time in milliseconds, negative value sets the 1/10 of the reactivity
+             */
+            void            set_open_debounce(float debounce);
+            inline float    open_debounce() const { return fOpenDebounce; }
+
+            /**
+             * Set the time the RMS value should stay below the close threshold to close the trigger
+             * @param debounce debounce time in milliseconds, negative value sets the 1/10 of the reactivity
+             */
+            void            set_close_debounce(float debounce);
+            inline float    close_debounce() const { return fCloseDebounce; }
+
             /**
              * Set stream corruption event shipping period in seconds
              * @param period period
@@ -206,12 +510,95 @@ namespace dd
             void            set_event_threshold(size_t threshold);
             inline float    event_threshold() const { return nEventThreshold; }\
 
+            /**
+             * Enable/disable detection of clicks and discontinuities. Clicks are detected
+             * as peaks of the third-order difference of the signal exceeding the running average
+             * level of the difference by the click ratio, and are counted as events together
+             * with dropouts
+             * @param enable enable click detection
+             */
+            void            set_click_detection(bool enable);
+            inline bool     click_detection() const { return bClicks; }
+
+            /**
+             * Set the ratio between the peak and the average level of the third-order
+             * difference of the signal that is considered to be a click
+             * @param ratio click detection ratio in decibels
+             */
+            void            set_click_ratio(float ratio);
+            inline float    click_ratio() const { return fClickRatioDB; }
+
+            /**
+             * Set the time the signal should stay at the constant value (digital silence
+             * or frozen DC level) to be reported as flatline
+             * @param time flatline detection time in seconds
+             */
+            void            set_flatline_time(float time);
+            inline float    flatline_time() const { return fFlatTime; }
+
+            /**
+             * Enable/disable counting of gaps in the stream as corruption events. Each
+             * continuous gap is counted as one event of the first audio channel
+             * @param enable enable counting of gaps
+             */
+            void            set_gap_events(bool enable);
+            inline bool     gap_events() const { return bGapEvents; }
+
+            /**
+             * Enable/disable the linked mode. Adjacent channels are processed as pairs: the trigger
+             * of the first channel of the pair works on the RMS envelope of the mid signal, so only one
+             * envelope is computed per pair. Additionally, the drop of one channel while the other
+             * stays active is counted as the event of the dropped channel, and the change of the
+             * correlation between channels to negative is counted as the event of the second channel.
+             * The envelope index receives the mid envelope for both channels of the pair. The last
+             * channel of odd number of channels is processed independently.
+             * @param linked enable the linked mode
+             */
+            void            set_linked(bool linked);
+            inline bool     linked() const { return bLinked; }
+
+            /**
+             * Set the journal for logging detected dropouts. The journal should be
+             * accessed only by the processing thread while it is bound.
+             * @param journal event journal, NULL to disable logging
+             */
+            inline void     set_journal(EventJournal *journal)  { pJournal = journal; }
+            inline EventJournal *journal() const                { return pJournal; }
+
+            /**
+             * Set the envelope index for storing the decimated RMS envelope of all channels.
+             * The index should be created for the same number of channels and accessed only
+             * by the processing thread while it is bound.
+             * @param index envelope index, NULL to disable storing the envelope
+             */
+            inline void     set_envelope_index(EnvelopeIndex *index)    { pIndex = index; }
+            inline EnvelopeIndex *envelope_index() const                { return pIndex; }
+
+            /**
+             * Set the listener for immediate delivery of notifications. The crossing of the event
+             * threshold is delivered at the sample which has generated the event, while the processing
+             * is in progress. Periodic repeats of the notification and the return below the threshold
+             * are delivered at the end of the process() call. Notifications are not merged and not
+             * available for polling while the listener is set.
+             * @param listener the listener, NULL to deliver notifications by polling
+             */
+            inline void     set_event_listener(IEventListener *listener) { pListener = listener; }
+            inline IEventListener *event_listener() const               { return pListener; }
+
             /**
              * Poll current pending event and cleanup
              * @return the pending event
              */
             event_type_t    poll_event();
 
+            /**
+             * Poll pending flatline start or finish notification. The notification is
+             * generated once per flatline start and once per flatline finish for each channel
+             * @param event pointer to store the flatline notification
+             * @return true if notification has been stored, false if there are no pending notifications
+             */
+            bool            poll_flatline(flatline_t *event);
+
             /**
              * Bind input buffer
              * @param channel audio channel index
@@ -232,6 +619,22 @@ namespace dd
              */
             void            process(size_t samples);
 
+            /**
+             * Process the gap in the stream: advance the timestamp and the detector state
+             * as if silence arrived without processing any audio data
+             * @param samples the length of the gap in samples
+             */
+            void            process_gap(size_t samples);
+
+            /**
+             * Process the RMS envelope instead of audio data: bound inputs should contain the
+             * envelope computed with the same reactivity, for example restored from the envelope
+             * index. Only the level trigger is processed, the flatline and click detectors are not
+             * updated. Outputs should be bound unless the bypass is enabled.
+             * @param samples number of envelope samples to process
+             */
+            void            process_envelope(size_t samples);
+
             /**
              * Return number of events detected for the audio channel
              * @param channel audio channel index
@@ -245,6 +648,93 @@ namespace dd
              * @return number of events detected for all audio channels
              */
             size_t          events_count() const;
+
+            /**
+             * Return number of events detected for all audio channels within the time window.
+             * All windows are maintained simultaneously with the resolution of 1/10 of the window
+             * length and do not depend on the estimation time
+             * @param window time window
+             * @return number of events detected for all audio channels within the time window
+             */
+            inline size_t   window_events(event_window_t window) const  { return sWindows.count(window); }
+
+            /**
+             * Return total number of events detected for all audio channels since the start
+             * @return total number of events
+             */
+            inline uint64_t total_events() const        { return nTotalEvents; }
+
+            /**
+             * Return total number of events coalesced since the start. When the number of events of
+             * the channel exceeds the event threshold by STORM_FACTOR times, the channel enters the
+             * storm mode: events are only counted and accounted once per processed block as a single
+             * entry, they are not written to the journal and do not update histograms
+             * @return total number of coalesced events, included into the total number of events
+             */
+            inline uint64_t coalesced_events() const    { return nCoalesced; }
+
+            /**
+             * Check that the audio channel is in the event storm mode
+             * @param channel audio channel index
+             * @return true if events of the channel are coalesced
+             */
+            bool            storm_active(size_t channel) const;
+
+            /**
+             * Return timestamp of the last detected event
+             * @return timestamp of the last event in samples, valid only if total number of events is not zero
+             */
+            inline timestamp_t last_event() const       { return nLastEvent; }
+
+            /**
+             * Check that the number of events is above the event threshold
+             * @return true if the number of events is above the event threshold
+             */
+            inline bool     corrupted() const           { return events_count() > nEventThreshold; }
+
+            /**
+             * Return state of the level trigger of the audio channel: 0 - closed (signal is below
+             * the threshold), 1 - opening, 2 - open (signal is above the threshold), 3 - closing
+             * @param channel audio channel index
+             * @return state of the level trigger
+             */
+            size_t          trigger_state(size_t channel) const;
+
+            /**
+             * Check that the flatline is reported for the audio channel
+             * @param channel audio channel index
+             * @return true if the flatline is active
+             */
+            bool            flatline_active(size_t channel) const;
+
+            /**
+             * Set the period of histogram export. Histograms of dropout durations, intervals between
+             * events and detection delays are collected for each channel and become available for
+             * export once per period
+             * @param period export period in seconds, 0 to disable export
+             */
+            void            set_histogram_period(float period);
+            inline float    histogram_period() const    { return fHistPeriod; }
+
+            /**
+             * Check that the histogram export period has elapsed. If the method returns true, the caller
+             * should export histograms and clear them
+             * @return true if histograms should be exported
+             */
+            bool            poll_histograms();
+
+            /**
+             * Get histogram of the audio channel, values are in microseconds
+             * @param channel audio channel index
+             * @param type histogram type
+             * @return histogram or NULL if channel index is invalid
+             */
+            const LogHistogram *histogram(size_t channel, histogram_t type) const;
+
+            /**
+             * Clear histograms of all channels
+             */
+            void            clear_histograms();
     };
 
 } /* namespace dd */
@@ -0,0 +1,193 @@
+/*
+ * Copyright (C) 2024 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2024 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of damage-detector
+ * Created on: 18 окт. 2026 г.
+ *
+ * damage-detector is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * damage-detector is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with damage-detector. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef PRIVATE_ENVELOPEINDEX_H_
+#define PRIVATE_ENVELOPEINDEX_H_
+
+#include <lsp-plug.in/common/types.h>
+#include <lsp-plug.in/common/status.h>
+
+#include <private/types.h>
+
+#include <stdio.h>
+
+namespace dd
+{
+    /**
+     * Envelope index file layout (all values are little-endian):
+     *   - envelope_header_t
+     *   - nEntries frames, each frame holds one envelope_entry_t per channel
+     *
+     * Each entry describes DECIMATION samples of the RMS envelope computed by the detector:
+     * the minimum and the maximum of the envelope stored in the order they occurred. The
+     * layout is fixed, so the file can be memory-mapped and the entry of the frame can be
+     * addressed directly by its sample offset.
+     */
+    static constexpr uint32_t   ENVELOPE_MAGIC      = 0x31454444;   // 'DDE1'
+    static constexpr uint16_t   ENVELOPE_VERSION    = 1;
+
+    #pragma pack(push, 1)
+    typedef struct envelope_header_t
+    {
+        uint32_t            nMagic;         // Magic number
+        uint16_t            nVersion;       // Format version
+        uint16_t            nChannels;      // Number of channels
+        uint32_t            nSampleRate;    // Sample rate of the source
+        uint32_t            nDecimation;    // Number of envelope samples per entry
+        float               fReactivity;    // Reactivity of the RMS envelope in milliseconds
+        uint32_t            nReserved;      // Reserved, should be zero
+        uint64_t            nSamples;       // Number of samples covered by the index
+        uint64_t            nEntries;       // Number of frames in the index
+        uint8_t             vReserved[24];  // Reserved, should be zero
+    } envelope_header_t;
+
+    typedef struct envelope_entry_t
+    {
+        float               fFirst;         // The extremum of the envelope which occurred first
+        float               fSecond;        // The extremum of the envelope which occurred second
+    } envelope_entry_t;
+    #pragma pack(pop)
+
+    /**
+     * Decimated RMS envelope of the audio file, the sidecar similar to peak files of
+     * audio editors. The writer is fed by the detector with the envelope of each channel,
+     * the reader provides frames of entries for re-analysis without decoding the audio.
+     */
+    class EnvelopeIndex
+    {
+        public:
+            static constexpr size_t     MIN_DECIMATION  = 4;
+            static constexpr size_t     MAX_DECIMATION  = 0x10000;
+            static constexpr size_t     DFL_DECIMATION  = 64;
+            static constexpr size_t     DFL_CAPACITY    = 0x400;    // Number of buffered frames
+
+        private:
+            typedef struct accum_t
+            {
+                float               fMin;           // Minimum of the envelope
+                float               fMax;           // Maximum of the envelope
+                uint32_t            nMinPos;        // Position of the minimum within the entry
+                uint32_t            nMaxPos;        // Position of the maximum within the entry
+                uint32_t            nCount;         // Number of accumulated samples
+                uint32_t            nFrames;        // Number of complete entries in the frame buffer
+            } accum_t;
+
+        private:
+            FILE               *hFile;          // Index file
+            accum_t            *vAccum;         // Per-channel accumulators, writer only
+            envelope_entry_t   *vFrames;        // Buffered frames, writer only
+            envelope_header_t   sHeader;        // Header in native byte order
+            uint32_t            nCapacity;      // Capacity of the frame buffer
+            uint32_t            nLost;          // Number of entries lost due to the buffer overflow
+            bool                bWrite;         // Index is opened for writing
+
+            uint8_t            *pData;
+
+        public:
+            EnvelopeIndex();
+            EnvelopeIndex(const EnvelopeIndex &) = delete;
+            EnvelopeIndex(EnvelopeIndex &&) = delete;
+            ~EnvelopeIndex();
+
+            EnvelopeIndex & operator = (const EnvelopeIndex &) = delete;
+            EnvelopeIndex & operator = (EnvelopeIndex &&) = delete;
+
+        private:
+            void            emit(size_t channel);
+            lsp::status_t   flush(bool all);
+            lsp::status_t   write_header();
+
+        public:
+            /**
+             * Create the index file for writing
+             * @param path path to the index file, the file is overwritten if it exists
+             * @param channels number of channels
+             * @param sample_rate sample rate of the source
+             * @param decimation number of envelope samples per entry
+             * @param reactivity reactivity of the RMS envelope in milliseconds
+             * @return status of operation
+             */
+            lsp::status_t   create(const char *path, size_t channels, size_t sample_rate, size_t decimation, float reactivity);
+
+            /**
+             * Open the index file for reading
+             * @param path path to the index file
+             * @return status of operation
+             */
+            lsp::status_t   open(const char *path);
+
+            /**
+             * Flush pending data, update the header and close the index
+             * @return status of operation
+             */
+            lsp::status_t   close();
+
+            /**
+             * Check that the index is opened
+             * @return true if the index is opened
+             */
+            inline bool     opened() const              { return hFile != NULL; }
+
+            inline size_t   channels() const            { return sHeader.nChannels; }
+            inline size_t   sample_rate() const         { return sHeader.nSampleRate; }
+            inline size_t   decimation() const          { return sHeader.nDecimation; }
+            inline float    reactivity() const          { return sHeader.fReactivity; }
+            inline uint64_t samples() const             { return sHeader.nSamples; }
+            inline uint64_t entries() const             { return sHeader.nEntries; }
+
+            /**
+             * Get number of entries lost due to the frame buffer overflow. Entries are lost
+             * only if one channel runs ahead of others by more than half of the buffer capacity
+             * @return number of lost entries
+             */
+            inline size_t   lost() const                { return nLost; }
+
+            /**
+             * Append the envelope of the channel. All channels should be appended with
+             * the same number of samples, the lead of any channel should not exceed
+             * half of the frame buffer capacity
+             * @param channel audio channel index
+             * @param env envelope samples
+             * @param samples number of samples
+             */
+            void            append(size_t channel, const float *env, size_t samples);
+
+            /**
+             * Append the constant envelope of the channel
+             * @param channel audio channel index
+             * @param env the value of envelope
+             * @param samples number of samples
+             */
+            void            append_const(size_t channel, float env, size_t samples);
+
+            /**
+             * Read frames from the index opened for reading
+             * @param dst destination buffer to store frames, should fit frames * channels() entries
+             * @param frames maximum number of frames to read
+             * @return number of frames read
+             */
+            size_t          read(envelope_entry_t *dst, size_t frames);
+    };
+
+} /* namespace dd */
+
+#endif /* PRIVATE_ENVELOPEINDEX_H_ */
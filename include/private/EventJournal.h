@@ -0,0 +1,250 @@
+/*
+ * Copyright (C) 2024 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2024 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of damage-detector
+ * Created on: 18 окт. 2026 г.
+ *
+ * damage-detector is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * damage-detector is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with damage-detector. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef PRIVATE_EVENTJOURNAL_H_
+#define PRIVATE_EVENTJOURNAL_H_
+
+#include <lsp-plug.in/common/types.h>
+#include <lsp-plug.in/common/status.h>
+#include <lsp-plug.in/ipc/Thread.h>
+
+#include <private/types.h>
+
+#include <stdio.h>
+
+namespace dd
+{
+    /**
+     * Journal file layout (all values are little-endian):
+     *   - journal_header_t
+     *   - sequence of journal_record_t until the end of file
+     */
+    static constexpr uint32_t   JOURNAL_MAGIC       = 0x314a4444;   // 'DDJ1'
+    static constexpr uint16_t   JOURNAL_VERSION     = 1;
+
+    static constexpr int64_t    JOURNAL_NO_PTS      = -1;
+
+    enum journal_record_type_t
+    {
+        JR_DROPOUT,     // Detected dropout: start, end samples, depth in decibels
+        JR_FORMAT,      // Format change: start = sample rate, end = number of channels
+        JR_OVERFLOW,    // Records lost due to the ring buffer overflow: start = number of lost records
+        JR_CLICK,       // Detected click: start = end = time of the click, ratio of the peak to the average difference level in decibels
+        JR_FLATLINE,    // Detected flatline: start of the constant signal, start + flatline time, level of the signal in decibels
+        JR_GAP,         // Gap in the stream: start and end of the gap in samples
+        JR_IMBALANCE,   // One channel of the linked pair has dropped: start, end samples, level relative to the other channel in decibels
+        JR_PHASE        // Channels of the linked pair in the opposite phase: start, end samples, minimum correlation
+    };
+
+    #pragma pack(push, 1)
+    typedef struct journal_header_t
+    {
+        uint32_t            nMagic;         // Magic number
+        uint16_t            nVersion;       // Format version
+        uint16_t            nRecordSize;    // Size of the record in bytes
+    } journal_header_t;
+
+    typedef struct journal_record_t
+    {
+        uint64_t            nStart;         // Start of the event in samples
+        uint64_t            nEnd;           // End of the event in samples
+        int64_t             nPts;           // Presentation timestamp of the event start (ns), JOURNAL_NO_PTS if unknown
+        float               fValue;         // Value associated with the event (depth for dropouts, ratio for clicks, level for flatlines)
+        uint16_t            nChannel;       // Audio channel index
+        uint16_t            nType;          // Type of record, see journal_record_type_t
+    } journal_record_t;
+    #pragma pack(pop)
+
+    /**
+     * Append-only binary journal of detected events. Records are submitted by the
+     * streaming thread into the pre-allocated single-producer/single-consumer ring
+     * buffer and written to the file by the background thread. If the ring buffer
+     * is full, the record is dropped and accounted by the JR_OVERFLOW record, so
+     * the submission never blocks and the memory usage is always bounded.
+     */
+    class EventJournal
+    {
+        public:
+            static constexpr size_t     DFL_CAPACITY    = 0x1000;
+            static constexpr size_t     FLUSH_PERIOD    = 20;       // Period of flushing data to file, milliseconds
+
+        private:
+            class Writer: public lsp::ipc::Thread
+            {
+                private:
+                    EventJournal       *pJournal;
+
+                public:
+                    explicit Writer(EventJournal *journal);
+                    virtual ~Writer() override;
+
+                public:
+                    virtual lsp::status_t run() override;
+            };
+
+        private:
+            journal_record_t   *vRecords;       // Ring buffer of records
+            uint32_t            nCapacity;      // Capacity of ring buffer, power of 2
+            uint32_t            nHead;          // Write position, modified only by producer
+            uint32_t            nTail;          // Read position, modified only by consumer
+            uint32_t            nLost;          // Number of records lost since last overflow record
+            uint32_t            bStop;          // Stop request for the writer thread
+            FILE               *hFile;          // Output file
+            Writer             *pWriter;        // Writer thread
+
+            timestamp_t         nSyncSample;    // Sample that corresponds to the synchronization PTS
+            int64_t             nSyncPts;       // Synchronization PTS
+            uint32_t            nSampleRate;    // Sample rate used for PTS computation
+
+            uint8_t            *pData;
+
+        public:
+            EventJournal();
+            EventJournal(const EventJournal &) = delete;
+            EventJournal(EventJournal &&) = delete;
+            ~EventJournal();
+
+            EventJournal & operator = (const EventJournal &) = delete;
+            EventJournal & operator = (EventJournal &&) = delete;
+
+        private:
+            size_t          flush();
+            bool            enqueue(const journal_record_t *rec);
+            bool            submit_event(journal_record_type_t type, size_t channel, timestamp_t start, timestamp_t end, float value);
+
+        public:
+            /**
+             * Open the journal and start the writer thread
+             * @param path path to the journal file, the data is appended to the file if it exists
+             * @param capacity the capacity of the ring buffer in records
+             * @return status of operation
+             */
+            lsp::status_t   open(const char *path, size_t capacity = DFL_CAPACITY);
+
+            /**
+             * Stop the writer thread, write all pending records and close the journal
+             * @return status of operation
+             */
+            lsp::status_t   close();
+
+            /**
+             * Check that journal is opened
+             * @return true if journal is opened
+             */
+            inline bool     opened() const          { return hFile != NULL; }
+
+            /**
+             * Synchronize sample timestamps with presentation timestamps, should be called
+             * from the streaming thread
+             * @param sample the sample timestamp
+             * @param pts presentation timestamp of the sample in nanoseconds, JOURNAL_NO_PTS if unknown
+             * @param sample_rate current sample rate
+             */
+            void            sync(timestamp_t sample, int64_t pts, size_t sample_rate);
+
+            /**
+             * Submit dropout record, should be called from the streaming thread, never blocks
+             * @param channel audio channel
+             * @param start start of the dropout in samples
+             * @param end end of the dropout in samples
+             * @param depth the depth of the dropout in decibels
+             * @return true if record has been submitted, false if it was dropped
+             */
+            bool            submit_dropout(size_t channel, timestamp_t start, timestamp_t end, float depth);
+
+            /**
+             * Submit click record, should be called from the streaming thread, never blocks
+             * @param channel audio channel
+             * @param time time of the click in samples
+             * @param ratio ratio of the click peak to the average signal difference level in decibels
+             * @return true if record has been submitted, false if it was dropped
+             */
+            bool            submit_click(size_t channel, timestamp_t time, float ratio);
+
+            /**
+             * Submit flatline record, should be called from the streaming thread, never blocks
+             * @param channel audio channel
+             * @param start start of the constant signal in samples
+             * @param end time in samples when the signal has stayed constant for the flatline time
+             * @param level level of the constant signal in decibels
+             * @return true if record has been submitted, false if it was dropped
+             */
+            bool            submit_flatline(size_t channel, timestamp_t start, timestamp_t end, float level);
+
+            /**
+             * Submit stream gap record, should be called from the streaming thread, never blocks
+             * @param start start of the gap in samples
+             * @param end end of the gap in samples
+             * @return true if record has been submitted, false if it was dropped
+             */
+            bool            submit_gap(timestamp_t start, timestamp_t end);
+
+            /**
+             * Submit record about the drop of one channel of the linked pair, should be called
+             * from the streaming thread, never blocks
+             * @param channel the dropped audio channel
+             * @param start start of the drop in samples
+             * @param end end of the drop in samples
+             * @param level minimum level of the dropped channel relative to the other channel in decibels
+             * @return true if record has been submitted, false if it was dropped
+             */
+            bool            submit_imbalance(size_t channel, timestamp_t start, timestamp_t end, float level);
+
+            /**
+             * Submit record about the opposite phase of the linked pair of channels, should be called
+             * from the streaming thread, never blocks
+             * @param channel the second audio channel of the pair
+             * @param start start of the opposite phase in samples
+             * @param end end of the opposite phase in samples
+             * @param corr minimum correlation of channels
+             * @return true if record has been submitted, false if it was dropped
+             */
+            bool            submit_phase(size_t channel, timestamp_t start, timestamp_t end, float corr);
+
+            /**
+             * Submit format change record, should be called from the streaming thread, never blocks
+             * @param sample_rate sample rate
+             * @param channels number of channels
+             * @return true if record has been submitted, false if it was dropped
+             */
+            bool            submit_format(size_t sample_rate, size_t channels);
+
+            /**
+             * Get number of records that are currently pending in the ring buffer
+             * @return number of pending records
+             */
+            size_t          pending() const;
+
+        public:
+            /**
+             * Convert the journal file to CSV, one line per record: type, channel, start, end,
+             * presentation timestamp (empty if unknown) and value
+             * @param out output CSV stream
+             * @param in journal file opened for reading
+             * @return status of operation: STATUS_CORRUPTED if the header could not be read,
+             *   STATUS_BAD_FORMAT if the journal format is not supported
+             */
+            static lsp::status_t export_csv(FILE *out, FILE *in);
+    };
+
+} /* namespace dd */
+
+#endif /* PRIVATE_EVENTJOURNAL_H_ */
@@ -0,0 +1,119 @@
+/*
+ * Copyright (C) 2024 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2024 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of damage-detector
+ * Created on: 18 окт. 2026 г.
+ *
+ * damage-detector is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * damage-detector is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with damage-detector. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef PRIVATE_EVENTWINDOWS_H_
+#define PRIVATE_EVENTWINDOWS_H_
+
+#include <lsp-plug.in/common/types.h>
+
+#include <private/types.h>
+
+namespace dd
+{
+    enum event_window_t
+    {
+        EV_WINDOW_1S,       // Events for the last second
+        EV_WINDOW_10S,      // Events for the last 10 seconds
+        EV_WINDOW_1M,       // Events for the last minute
+        EV_WINDOW_10M,      // Events for the last 10 minutes
+
+        EV_WINDOW_TOTAL
+    };
+
+    /**
+     * Counters of events for several time windows at once. Each window is split into
+     * the ring of buckets, the event increments the current bucket of each window and
+     * buckets which went out of the window are subtracted from the running sum when the
+     * time advances. Both operations take constant time regardless of the number of events,
+     * the resolution of each window is one bucket.
+     */
+    class EventWindows
+    {
+        public:
+            static constexpr size_t BUCKETS     = 10;
+
+        private:
+            typedef struct window_t
+            {
+                timestamp_t     nBucket;        // Index of the current bucket since the start
+                uint32_t        nLength;        // Length of the bucket in samples
+                uint32_t        nSum;           // Number of events in all buckets
+                uint32_t        vCount[BUCKETS];// Number of events in each bucket
+            } window_t;
+
+        private:
+            window_t        vWindows[EV_WINDOW_TOTAL];
+
+        public:
+            EventWindows();
+
+        public:
+            /**
+             * Set sample rate and drop all events
+             * @param sample_rate sample rate
+             */
+            void            init(size_t sample_rate);
+
+            /**
+             * Change sample rate keeping events, the current bucket of each window is
+             * moved to the position of the timestamp in the new sample rate
+             * @param sample_rate new sample rate
+             * @param ts current timestamp in samples of the new sample rate
+             */
+            void            set_sample_rate(size_t sample_rate, timestamp_t ts);
+
+            /**
+             * Drop all events
+             */
+            void            clear();
+
+            /**
+             * Advance the time, drop events which went out of windows
+             * @param ts current timestamp in samples
+             */
+            void            advance(timestamp_t ts);
+
+            /**
+             * Account events
+             * @param ts timestamp of events in samples, should not be less than the last timestamp
+             * @param count number of events
+             */
+            void            submit(timestamp_t ts, size_t count = 1);
+
+            /**
+             * Get number of events in the window
+             * @param window window identifier
+             * @return number of events in the window
+             */
+            inline size_t   count(event_window_t window) const  { return vWindows[window].nSum; }
+
+        public:
+            /**
+             * Get length of the window
+             * @param window window identifier
+             * @return length of the window in seconds
+             */
+            static float    length(event_window_t window);
+    };
+
+} /* namespace dd */
+
+#endif /* PRIVATE_EVENTWINDOWS_H_ */
@@ -0,0 +1,102 @@
+/*
+ * Copyright (C) 2024 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2024 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of damage-detector
+ * Created on: 18 окт. 2026 г.
+ *
+ * damage-detector is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * damage-detector is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with damage-detector. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef PRIVATE_LOGHISTOGRAM_H_
+#define PRIVATE_LOGHISTOGRAM_H_
+
+#include <lsp-plug.in/common/types.h>
+#include <lsp-plug.in/common/bits.h>
+
+namespace dd
+{
+    /**
+     * Histogram with logarithmic buckets in the style of HDR histograms. Each octave of
+     * values is split into SUB_BUCKETS linear sub-buckets, so the relative error of the value
+     * is less than 1/SUB_BUCKETS over the whole range. Values below SUB_BUCKETS are stored
+     * exactly, values above the range are accounted by the last bucket. Adding the value takes
+     * constant time, counters saturate instead of wrapping.
+     */
+    class LogHistogram
+    {
+        public:
+            static constexpr size_t SUB_BITS        = 2;
+            static constexpr size_t SUB_BUCKETS     = 1 << SUB_BITS;
+            static constexpr size_t BUCKETS         = 128;
+
+        private:
+            uint32_t        vCount[BUCKETS];
+
+        public:
+            /**
+             * Reset all counters
+             */
+            void            clear();
+
+            /**
+             * Add value to the histogram
+             * @param value value to add
+             */
+            inline void     add(uint64_t value)
+            {
+                uint32_t *c     = &vCount[index(value)];
+                *c             += (*c < 0xffffffff) ? 1 : 0;
+            }
+
+            /**
+             * Get number of values in the bucket
+             * @param bucket bucket index
+             * @return number of values
+             */
+            inline uint32_t count(size_t bucket) const  { return vCount[bucket]; }
+
+            /**
+             * Get total number of values in the histogram
+             * @return total number of values
+             */
+            uint64_t        total() const;
+
+        public:
+            /**
+             * Get index of the bucket for the value
+             * @param value value
+             * @return index of the bucket
+             */
+            static inline size_t index(uint64_t value)
+            {
+                if (value < SUB_BUCKETS)
+                    return value;
+
+                const size_t msb    = lsp::int_log2(value);
+                const size_t idx    = (msb - SUB_BITS + 1) * SUB_BUCKETS + ((value >> (msb - SUB_BITS)) & (SUB_BUCKETS - 1));
+                return (idx < BUCKETS) ? idx : BUCKETS - 1;
+            }
+
+            /**
+             * Get the lowest value that is accounted by the bucket
+             * @param bucket bucket index
+             * @return the lowest value of the bucket
+             */
+            static uint64_t lower_bound(size_t bucket);
+    };
+
+} /* namespace dd */
+
+#endif /* PRIVATE_LOGHISTOGRAM_H_ */
@@ -0,0 +1,96 @@
+/*
+ * Copyright (C) 2024 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2024 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of damage-detector
+ * Created on: 18 окт. 2026 г.
+ *
+ * damage-detector is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * damage-detector is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with damage-detector. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef PRIVATE_P2QUANTILE_H_
+#define PRIVATE_P2QUANTILE_H_
+
+#include <lsp-plug.in/common/types.h>
+
+namespace dd
+{
+    /**
+     * Streaming quantile estimator based on the P-square algorithm (R. Jain, I. Chlamtac).
+     * Uses constant memory (five markers) and constant time per observation. To track
+     * non-stationary data, the positions of markers are rescaled when the number of
+     * observations exceeds the window, so older observations gradually lose their weight.
+     */
+    class P2Quantile
+    {
+        private:
+            static constexpr size_t MARKERS     = 5;
+
+        private:
+            float       vHeight[MARKERS];   // Heights of markers
+            float       vPos[MARKERS];      // Actual positions of markers
+            float       vDesired[MARKERS];  // Desired positions of markers
+            float       vStep[MARKERS];     // Increments of desired positions
+            float       fQuantile;          // Estimated quantile
+            float       fWindow;            // Maximum number of observations taken into account
+            uint32_t    nCount;             // Number of observations
+
+        public:
+            P2Quantile();
+
+        private:
+            float       parabolic(size_t i, float d) const;
+            float       linear(size_t i, ssize_t d) const;
+
+        public:
+            /**
+             * Initialize estimator and drop all observations
+             * @param quantile quantile to estimate, in range of 0 to 1
+             * @param window number of observations after which the older ones start to lose weight, 0 for unlimited
+             */
+            void        init(float quantile, size_t window = 0);
+
+            /**
+             * Drop all observations
+             */
+            void        reset();
+
+            /**
+             * Add observation
+             * @param x observed value
+             */
+            void        update(float x);
+
+            /**
+             * Get current estimate of the quantile
+             * @return estimate of the quantile, 0 if there were no observations
+             */
+            float       value() const;
+
+            /**
+             * Check that estimator has enough observations to provide the P-square estimate
+             * @return true if estimator has enough observations
+             */
+            inline bool ready() const   { return nCount >= MARKERS; }
+
+            /**
+             * Get number of observations
+             * @return number of observations
+             */
+            inline size_t count() const { return nCount; }
+    };
+
+} /* namespace dd */
+
+#endif /* PRIVATE_P2QUANTILE_H_ */
@@ -0,0 +1,188 @@
+/*
+ * Copyright (C) 2024 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2024 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of damage-detector
+ * Created on: 18 окт. 2026 г.
+ *
+ * damage-detector is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * damage-detector is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with damage-detector. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef PRIVATE_SCHEDULER_H_
+#define PRIVATE_SCHEDULER_H_
+
+#include <lsp-plug.in/common/types.h>
+#include <lsp-plug.in/common/status.h>
+#include <lsp-plug.in/ipc/Mutex.h>
+#include <lsp-plug.in/ipc/Thread.h>
+
+namespace dd
+{
+    class Scheduler;
+
+    /**
+     * Task executed by the scheduler. The task is never executed by several workers
+     * at the same time and may be submitted again while it is running: in this case
+     * it is executed once more after the current execution completes.
+     */
+    class Task
+    {
+        private:
+            friend class Scheduler;
+
+            enum state_t
+            {
+                S_IDLE,         // Task is not queued
+                S_QUEUED,       // Task is in the queue of some worker
+                S_RUNNING,      // Task is being executed
+                S_RESUBMIT      // Task is being executed and has been submitted again
+            };
+
+        private:
+            uint32_t            nState;     // Task state, see state_t
+
+        public:
+            Task();
+            Task(const Task &) = delete;
+            Task(Task &&) = delete;
+            virtual ~Task();
+
+            Task & operator = (const Task &) = delete;
+            Task & operator = (Task &&) = delete;
+
+        public:
+            /**
+             * Execute the task
+             * @return true if the task has more work and should be queued again
+             */
+            virtual bool        run() = 0;
+
+            /**
+             * Check that the task is neither queued nor being executed. The task that
+             * is idle and will not be submitted again can be safely destroyed
+             * @return true if the task is idle
+             */
+            bool                idle();
+    };
+
+    typedef struct scheduler_stats_t
+    {
+        wsize_t             nExecuted;      // Number of executed tasks
+        wsize_t             nStolen;        // Number of tasks stolen from other workers
+        size_t              nQueued;        // Number of currently queued tasks
+        size_t              nPeakQueued;    // Maximum number of queued tasks for a single worker
+    } scheduler_stats_t;
+
+    /**
+     * Work-stealing task scheduler. Each worker owns the queue of tasks: it takes tasks
+     * from the front of its own queue, so tasks that are requeued after execution are
+     * served in the round-robin order, and steals tasks from the back of queues of other
+     * workers when its own queue is empty, so all workers stay busy with uneven load.
+     */
+    class Scheduler
+    {
+        public:
+            static constexpr size_t     IDLE_PERIOD     = 1;        // Sleep period of the idle worker, milliseconds
+
+        private:
+            class Worker;
+
+            typedef struct queue_t
+            {
+                lsp::ipc::Mutex     sLock;      // Lock of the queue
+                Task              **vTasks;     // Ring buffer of tasks
+                size_t              nHead;      // Index of the first task
+                size_t              nCount;     // Number of tasks in the queue
+                size_t              nPeak;      // Maximum number of tasks in the queue
+                wsize_t             nExecuted;  // Number of tasks executed by worker
+                wsize_t             nStolen;    // Number of tasks stolen by worker
+                Worker             *pWorker;    // Worker thread
+            } queue_t;
+
+            class Worker: public lsp::ipc::Thread
+            {
+                private:
+                    Scheduler          *pScheduler;
+                    size_t              nIndex;
+
+                public:
+                    explicit Worker(Scheduler *scheduler, size_t index);
+                    virtual ~Worker() override;
+
+                public:
+                    virtual lsp::status_t run() override;
+            };
+
+        private:
+            queue_t            *vQueues;        // Queues of workers
+            size_t              nQueues;        // Number of workers
+            size_t              nCapacity;      // Capacity of each queue
+            uint32_t            nNext;          // Next queue for external submission
+            uint32_t            bStop;          // Stop request
+
+        public:
+            Scheduler();
+            Scheduler(const Scheduler &) = delete;
+            Scheduler(Scheduler &&) = delete;
+            ~Scheduler();
+
+            Scheduler & operator = (const Scheduler &) = delete;
+            Scheduler & operator = (Scheduler &&) = delete;
+
+        private:
+            bool            push(size_t queue, Task *task);
+            Task           *pop(size_t queue);
+            Task           *steal(size_t queue);
+            void            execute(size_t queue, Task *task);
+            bool            enqueue(size_t queue, Task *task);
+            void            destroy();
+
+        public:
+            /**
+             * Start worker threads
+             * @param workers number of workers, 0 for number of CPU cores
+             * @param tasks maximum number of tasks that may be submitted to the scheduler
+             * @return status of operation
+             */
+            lsp::status_t   start(size_t workers, size_t tasks);
+
+            /**
+             * Stop worker threads, queued tasks are not executed
+             * @return status of operation
+             */
+            lsp::status_t   stop();
+
+            /**
+             * Submit the task for execution, does nothing if task is already queued
+             * @param task task to submit
+             * @return true if task is queued or will be executed again
+             */
+            bool            submit(Task *task);
+
+            /**
+             * Get number of worker threads
+             * @return number of worker threads
+             */
+            inline size_t   workers() const     { return nQueues; }
+
+            /**
+             * Get scheduler statistics
+             * @param stats pointer to store statistics
+             */
+            void            get_stats(scheduler_stats_t *stats);
+    };
+
+} /* namespace dd */
+
+#endif /* PRIVATE_SCHEDULER_H_ */
@@ -0,0 +1,172 @@
+/*
+ * Copyright (C) 2024 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2024 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of damage-detector
+ * Created on: 18 окт. 2026 г.
+ *
+ * damage-detector is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * damage-detector is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with damage-detector. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef PRIVATE_SHMAUDIORING_H_
+#define PRIVATE_SHMAUDIORING_H_
+
+#include <lsp-plug.in/common/types.h>
+#include <lsp-plug.in/common/status.h>
+
+namespace dd
+{
+    /**
+     * Shared memory audio ring layout. The shared memory object is created by the producer
+     * and consists of the header followed by the ring buffer of interleaved 32-bit floating-point
+     * frames in native byte order:
+     *
+     *   offset  size  field
+     *   0       4     magic, SHM_RING_MAGIC
+     *   4       2     version, SHM_RING_VERSION
+     *   6       2     number of channels
+     *   8       4     sample rate
+     *   12      4     capacity of the ring buffer in frames, power of 2
+     *   16      8     total number of frames written, updated by producer after writing data
+     *   24      8     total number of frames read, updated by consumer after reading data
+     *   32      4     flags, see shm_ring_flags_t
+     *   36      28    reserved, should be zero
+     *   64      ...   capacity * channels * sizeof(float) bytes of frame data
+     *
+     * The frame with the index N is stored at the position (N % capacity) of the ring buffer.
+     * There is exactly one producer and one consumer for each ring.
+     */
+    static constexpr uint32_t   SHM_RING_MAGIC      = 0x48534444;   // 'DDSH'
+    static constexpr uint16_t   SHM_RING_VERSION    = 1;
+
+    enum shm_ring_flags_t
+    {
+        SHM_RING_EOS        = 1 << 0    // Producer has finished writing the stream
+    };
+
+    typedef struct shm_ring_header_t
+    {
+        uint32_t            nMagic;
+        uint16_t            nVersion;
+        uint16_t            nChannels;
+        uint32_t            nSampleRate;
+        uint32_t            nCapacity;
+        uint64_t            nWritten;
+        uint64_t            nRead;
+        uint32_t            nFlags;
+        uint8_t             vReserved[28];
+    } shm_ring_header_t;
+
+    /**
+     * Single-producer single-consumer audio ring buffer in POSIX shared memory
+     */
+    class ShmAudioRing
+    {
+        private:
+            shm_ring_header_t  *pHeader;    // Mapped header
+            float              *vData;      // Mapped frame data
+            size_t              nMapSize;   // Size of the mapping
+            char               *sName;      // Name of the shared memory object
+            bool                bOwner;     // This instance has created the shared memory object
+
+        public:
+            ShmAudioRing();
+            ShmAudioRing(const ShmAudioRing &) = delete;
+            ShmAudioRing(ShmAudioRing &&) = delete;
+            ~ShmAudioRing();
+
+            ShmAudioRing & operator = (const ShmAudioRing &) = delete;
+            ShmAudioRing & operator = (ShmAudioRing &&) = delete;
+
+        public:
+            /**
+             * Create the shared memory ring, the existing object with the same name is replaced
+             * @param name name of the shared memory object, should start with '/'
+             * @param channels number of channels
+             * @param sample_rate sample rate
+             * @param capacity capacity of the ring buffer in frames, rounded up to the power of 2
+             * @return status of operation
+             */
+            lsp::status_t       create(const char *name, size_t channels, size_t sample_rate, size_t capacity);
+
+            /**
+             * Open the existing shared memory ring
+             * @param name name of the shared memory object
+             * @return status of operation, STATUS_NOT_FOUND if the object does not exist
+             */
+            lsp::status_t       open(const char *name);
+
+            /**
+             * Close the ring, the shared memory object is removed if it has been created by this instance
+             */
+            void                close();
+
+            inline bool         opened() const          { return pHeader != NULL; }
+            inline const char  *name() const            { return sName; }
+            size_t              channels() const;
+            size_t              sample_rate() const;
+            size_t              capacity() const;
+
+        public: // Producer interface
+            /**
+             * Write interleaved frames to the ring buffer, never blocks
+             * @param frames frames to write
+             * @param count number of frames
+             * @return number of frames actually written
+             */
+            size_t              write(const float *frames, size_t count);
+
+            /**
+             * Get number of frames that can be written without overwriting unread data
+             * @return number of frames
+             */
+            size_t              space() const;
+
+            /**
+             * Mark the end of stream
+             */
+            void                set_eos();
+
+        public: // Consumer interface
+            /**
+             * Get the contiguous segment of frames that are available for reading
+             * @param count pointer to store number of available frames in the segment
+             * @return pointer to the first frame of the segment
+             */
+            const float        *read_segment(size_t *count) const;
+
+            /**
+             * Release frames after reading
+             * @param count number of frames to release
+             */
+            void                commit_read(size_t count);
+
+            /**
+             * Get number of frames available for reading
+             * @return number of frames
+             */
+            size_t              available() const;
+
+            /**
+             * Check that producer has finished the stream. All frames written before the end of
+             * stream are visible once it is reported, so the consumer should check the flag before
+             * reading and finish the stream only if the ring was empty after the flag was seen
+             * @return true if producer has finished the stream
+             */
+            bool                eos() const;
+    };
+
+} /* namespace dd */
+
+#endif /* PRIVATE_SHMAUDIORING_H_ */
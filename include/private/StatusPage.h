@@ -0,0 +1,162 @@
+/*
+ * Copyright (C) 2024 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2024 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of damage-detector
+ * Created on: 18 окт. 2026 г.
+ *
+ * damage-detector is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * damage-detector is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with damage-detector. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef PRIVATE_STATUSPAGE_H_
+#define PRIVATE_STATUSPAGE_H_
+
+#include <lsp-plug.in/common/types.h>
+#include <lsp-plug.in/common/status.h>
+
+#include <private/types.h>
+#include <private/EventWindows.h>
+
+namespace dd
+{
+    class DamageDetector;
+
+    /**
+     * Status page layout. The page is the memory-mapped file which is updated by the
+     * streaming thread and can be read by any number of external processes. All fields
+     * are in native byte order:
+     *
+     *   offset  size  field
+     *   0       4     magic, STATUS_PAGE_MAGIC
+     *   4       2     version, STATUS_PAGE_VERSION
+     *   6       2     number of reported channels, at most STATUS_MAX_CHANNELS
+     *   8       4     sample rate
+     *   12      4     sequence counter, odd while the page is being updated
+     *   16      8     number of processed samples
+     *   24      8     presentation timestamp of the last event (ns), STATUS_NO_PTS if unknown
+     *   32      8     timestamp of the last event in samples
+     *   40      8     total number of events since the start
+     *   48      4     number of events for the estimation time
+     *   52      4     flags, see status_flags_t
+     *   56      16    number of events for the last 1 s, 10 s, 1 min and 10 min
+     *   72      8     reserved, should be zero
+     *   80      ...   STATUS_MAX_CHANNELS channel records, 16 bytes each:
+     *                 state of the level trigger (4), number of events (4), threshold in dB (4), flags (4)
+     *
+     * The page is protected by the sequence lock: the reader reads the sequence counter, copies
+     * the page and reads the sequence counter again. The copy is consistent if both values are
+     * equal and even, otherwise the reader should retry.
+     */
+    static constexpr uint32_t   STATUS_PAGE_MAGIC       = 0x53534444;   // 'DDSS'
+    static constexpr uint16_t   STATUS_PAGE_VERSION     = 1;
+    static constexpr size_t     STATUS_MAX_CHANNELS     = 64;
+    static constexpr int64_t    STATUS_NO_PTS           = -1;
+
+    enum status_flags_t
+    {
+        STATUS_CORRUPTED        = 1 << 0,   // Number of events is above the threshold
+        STATUS_EVENTS           = 1 << 1    // At least one event has been detected
+    };
+
+    enum status_channel_flags_t
+    {
+        STATUS_CH_FLATLINE      = 1 << 0    // Flatline is active on the channel
+    };
+
+    typedef struct status_channel_t
+    {
+        uint32_t            nState;
+        uint32_t            nEvents;
+        float               fThreshold;
+        uint32_t            nFlags;
+    } status_channel_t;
+
+    typedef struct status_page_t
+    {
+        uint32_t            nMagic;
+        uint16_t            nVersion;
+        uint16_t            nChannels;
+        uint32_t            nSampleRate;
+        uint32_t            nSequence;
+        uint64_t            nSamples;
+        int64_t             nLastEventPts;
+        uint64_t            nLastEvent;
+        uint64_t            nTotalEvents;
+        uint32_t            nEvents;
+        uint32_t            nFlags;
+        uint32_t            vWindowEvents[EV_WINDOW_TOTAL];
+        uint8_t             vReserved[8];
+        status_channel_t    vChannels[STATUS_MAX_CHANNELS];
+    } status_page_t;
+
+    /**
+     * Status page writer
+     */
+    class StatusPage
+    {
+        private:
+            status_page_t      *pPage;          // Mapped page
+            timestamp_t         nSyncSample;    // Sample that corresponds to the synchronization PTS
+            int64_t             nSyncPts;       // Synchronization PTS
+
+        public:
+            StatusPage();
+            StatusPage(const StatusPage &) = delete;
+            StatusPage(StatusPage &&) = delete;
+            ~StatusPage();
+
+            StatusPage & operator = (const StatusPage &) = delete;
+            StatusPage & operator = (StatusPage &&) = delete;
+
+        public:
+            /**
+             * Create or replace the status page file and map it to memory
+             * @param path path to the file, the file in tmpfs (/dev/shm) avoids any disk I/O
+             * @return status of operation
+             */
+            lsp::status_t       open(const char *path);
+
+            /**
+             * Unmap the status page, the file is kept for readers
+             */
+            void                close();
+
+            inline bool         opened() const      { return pPage != NULL; }
+
+            /**
+             * Synchronize the sample timestamp with the presentation timestamp
+             * @param sample sample timestamp
+             * @param pts presentation timestamp of the sample in nanoseconds, STATUS_NO_PTS if unknown
+             */
+            void                sync(timestamp_t sample, int64_t pts);
+
+            /**
+             * Publish the current status of the detector, should be called only by the streaming thread
+             * @param detector the detector
+             */
+            void                publish(const DamageDetector *detector);
+
+        public:
+            /**
+             * Read the consistent copy of the status page
+             * @param dst destination to store the copy
+             * @param page the mapped status page
+             * @return true if the consistent copy has been read, false if the writer is updating the page
+             */
+            static bool         read(status_page_t *dst, const status_page_t *page);
+    };
+
+} /* namespace dd */
+
+#endif /* PRIVATE_STATUSPAGE_H_ */
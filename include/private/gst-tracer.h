@@ -0,0 +1,85 @@
+/*
+ * Copyright (C) 2024 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2024 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of damage-detector
+ * Created on: 18 окт. 2026 г.
+ *
+ * damage-detector is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * damage-detector is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with damage-detector. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef PRIVATE_GST_TRACER_H_
+#define PRIVATE_GST_TRACER_H_
+
+#include <gst/gst.h>
+
+#include <lsp-plug.in/common/atomic.h>
+#include <lsp-plug.in/common/types.h>
+
+/**
+ * Tracer of the damage detector elements. It is enabled by adding "damagedetector" to
+ * the GST_TRACERS environment variable and logs the "damage-detector" record for each
+ * processed buffer. When no tracer is instantiated, elements only check the counter of
+ * active tracers per buffer and do not measure anything.
+ */
+#define GST_TYPE_DAMAGE_DETECTOR_TRACER (gst_damage_detector_tracer_get_type())
+G_DECLARE_FINAL_TYPE( // @suppress("Unused static function")
+    GstDamageDetectorTracer,
+    gst_damage_detector_tracer,
+    GST,
+    DAMAGE_DETECTOR_TRACER,
+    GstTracer);
+
+typedef struct gst_damage_detector_trace_t
+{
+    guint64     proctime;       // Processing time of the buffer in nanoseconds
+    guint64     samples;        // Number of samples processed
+    guint       events;         // Number of events detected while processing the buffer
+    guint       queue;          // Number of events in the event queues of the detector
+    guint       journal;        // Number of records pending in the journal ring buffer
+} gst_damage_detector_trace_t;
+
+/**
+ * Number of active tracer instances
+ */
+extern uint32_t gst_damage_detector_tracers;
+
+/**
+ * Check that tracing is enabled
+ * @return true if at least one tracer is active
+ */
+static inline bool gst_damage_detector_tracing()
+{
+#ifndef GST_DISABLE_GST_TRACER_HOOKS
+    return lsp::atomic_load(&gst_damage_detector_tracers) > 0;
+#else
+    return false;
+#endif /* GST_DISABLE_GST_TRACER_HOOKS */
+}
+
+/**
+ * Log the trace record of the processed buffer
+ * @param element the element which has processed the buffer
+ * @param trace trace data
+ */
+void gst_damage_detector_trace(GstElement *element, const gst_damage_detector_trace_t *trace);
+
+/**
+ * Register the tracer in the plugin
+ * @param plugin the plugin
+ * @return true on success
+ */
+gboolean gst_damage_detector_tracer_register(GstPlugin *plugin);
+
+#endif /* PRIVATE_GST_TRACER_H_ */
@@ -0,0 +1,39 @@
+/*
+ * Copyright (C) 2024 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2024 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of damage-detector
+ * Created on: 18 окт. 2026 г.
+ *
+ * damage-detector is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * damage-detector is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with damage-detector. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef PRIVATE_TYPES_H_
+#define PRIVATE_TYPES_H_
+
+#include <lsp-plug.in/common/types.h>
+
+namespace dd
+{
+    typedef uint64_t            timestamp_t;
+
+    /**
+     * Units of the rate-independent time per second. The value is divisible by all
+     * common sample rates, so the conversion of samples to time is exact
+     */
+    static constexpr timestamp_t TIME_UNITS     = 705600000;
+
+} /* namespace dd */
+
+#endif /* PRIVATE_TYPES_H_ */
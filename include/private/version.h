@@ -23,8 +23,8 @@
 #define PRIVATE_VERSION_H_
 
 #define DAMAGE_DETECTOR_MAJOR           1
-#define DAMAGE_DETECTOR_MINOR           0
-#define DAMAGE_DETECTOR_MICRO           1
+#define DAMAGE_DETECTOR_MINOR           1
+#define DAMAGE_DETECTOR_MICRO           0
 
 #define DAMAGE_DETECTOR_PACKAGE         "damage-detector"
 #define DAMAGE_DETECTOR_LICENSE         "LGPL"
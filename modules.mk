@@ -68,6 +68,11 @@ LIBPTHREAD_NAME            := libpthread
 LIBPTHREAD_TYPE            := opt
 LIBPTHREAD_LDFLAGS         := -lpthread
 
+LIBRT_VERSION              := system
+LIBRT_NAME                 := librt
+LIBRT_TYPE                 := opt
+LIBRT_LDFLAGS              := -lrt
+
 LIBDL_VERSION              := system
 LIBDL_NAME                 := libdl
 LIBDL_TYPE                 := opt
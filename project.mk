@@ -22,5 +22,5 @@
 ARTIFACT_ID                 = DAMAGE_DETECTOR
 ARTIFACT_NAME               = damage-detector
 ARTIFACT_DESC               = Damage Detector - a GStreamer plugin for detecting audio stream corruptions
-ARTIFACT_VERSION            = 1.0.1
+ARTIFACT_VERSION            = 1.1.0
 
@@ -0,0 +1,474 @@
+/*
+ * Copyright (C) 2024 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2024 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of damage-detector
+ * Created on: 18 окт. 2026 г.
+ *
+ * damage-detector is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * damage-detector is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with damage-detector. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <lsp-plug.in/common/alloc.h>
+#include <lsp-plug.in/common/finally.h>
+#include <lsp-plug.in/common/types.h>
+#include <lsp-plug.in/dsp/dsp.h>
+
+#include <damage-detector/damage-detector.h>
+#include <private/Arena.h>
+#include <private/DamageDetector.h>
+#include <private/version.h>
+
+#include <new>
+
+namespace dd
+{
+    namespace capi
+    {
+        static constexpr size_t     BUF_SIZE        = 0x400;    // Size of the buffer per channel in samples
+
+        /**
+         * Listener which passes notifications to the user callback
+         */
+        class CallbackListener: public IEventListener
+        {
+            public:
+                dd_event_callback_t     pCallback;
+                void                   *pArg;
+
+            public:
+                CallbackListener()
+                {
+                    pCallback   = NULL;
+                    pArg        = NULL;
+                }
+
+            public:
+                virtual void on_event(const notification_t *event) override
+                {
+                    dd_event_t ev;
+                    ev.type         = (event->enType == EVENT_ABOVE) ? DD_EVENT_ABOVE : DD_EVENT_BELOW;
+                    ev.events       = uint32_t(event->nEvents);
+                    ev.timestamp    = event->nTimestamp;
+
+                    pCallback(pArg, &ev);
+                }
+        };
+
+        static bool init_dsp()
+        {
+            lsp::dsp::init();
+            return true;
+        }
+
+    } /* namespace capi */
+} /* namespace dd */
+
+struct dd_detector
+{
+    dd::DamageDetector         *pDetector;      // Detector
+    dd::capi::CallbackListener  sListener;      // Listener of immediate notifications
+    float                      *vBuffer;        // Buffer for de-interleaving, BUF_SIZE samples per channel
+    uint8_t                    *pData;          // Allocated data
+    dd::Arena                  *pArena;         // Arena the detector has been allocated from, NULL for the heap
+};
+
+struct dd_arena
+{
+    dd::Arena                   sArena;         // Arena
+};
+
+DD_API uint32_t dd_version(void)
+{
+    return (DAMAGE_DETECTOR_MAJOR << 16) | (DAMAGE_DETECTOR_MINOR << 8) | DAMAGE_DETECTOR_MICRO;
+}
+
+DD_API uint32_t dd_abi_version(void)
+{
+    return DD_ABI_VERSION;
+}
+
+DD_API dd_detector_t *dd_create(uint32_t channels, uint32_t sample_rate)
+{
+    return dd_create_in_arena(NULL, channels, sample_rate);
+}
+
+DD_API dd_detector_t *dd_create_in_arena(dd_arena_t *arena, uint32_t channels, uint32_t sample_rate)
+{
+    if ((channels <= 0) || (sample_rate <= 0))
+        return NULL;
+
+    // Thread-safe initialization of DSP on the first call
+    static const bool dsp_initialized = dd::capi::init_dsp();
+    (void)dsp_initialized;
+
+    dd::Arena *a            = (arena != NULL) ? &arena->sArena : NULL;
+    dd_detector_t *dd       = NULL;
+    if (a != NULL)
+    {
+        void *ptr               = a->alloc(sizeof(dd_detector_t));
+        if (ptr == NULL)
+            return NULL;
+        dd                      = new (ptr) dd_detector_t;
+        dd->pArena              = a;
+        dd->pData               = NULL;
+        dd->vBuffer             = static_cast<float *>(a->alloc(dd::capi::BUF_SIZE * channels * sizeof(float)));
+        ptr                     = a->alloc(sizeof(dd::DamageDetector));
+        dd->pDetector           = (ptr != NULL) ? new (ptr) dd::DamageDetector(channels, a) : NULL;
+    }
+    else
+    {
+        dd                      = new (std::nothrow) dd_detector_t;
+        if (dd == NULL)
+            return NULL;
+        dd->pArena              = NULL;
+        dd->pData               = NULL;
+        dd->vBuffer             = lsp::alloc_aligned<float>(dd->pData, dd::capi::BUF_SIZE * channels, DEFAULT_ALIGN);
+        dd->pDetector           = new (std::nothrow) dd::DamageDetector(channels);
+    }
+
+    if ((dd->vBuffer == NULL) || (dd->pDetector == NULL))
+    {
+        dd_destroy(dd);
+        return NULL;
+    }
+
+    dd->pDetector->set_sample_rate(sample_rate);
+
+    return dd;
+}
+
+DD_API void dd_destroy(dd_detector_t *dd)
+{
+    if (dd == NULL)
+        return;
+
+    dd::Arena *a            = dd->pArena;
+    if (a == NULL)
+    {
+        delete dd->pDetector;
+        lsp::free_aligned(dd->pData);
+        delete dd;
+        return;
+    }
+
+    if (dd->pDetector != NULL)
+    {
+        dd->pDetector->~DamageDetector();
+        a->free(dd->pDetector);
+    }
+    a->free(dd->vBuffer);
+    dd->~dd_detector_t();
+    a->free(dd);
+}
+
+DD_API dd_arena_t *dd_arena_create(int32_t node, uint32_t flags)
+{
+    if ((node < DD_NODE_ANY) || (flags & ~uint32_t(DD_ARENA_HUGE_PAGES | DD_ARENA_NUMA_BIND)))
+        return NULL;
+
+    size_t f                = 0;
+    if (flags & DD_ARENA_HUGE_PAGES)
+        f                      |= dd::ARENA_HUGE_PAGES;
+    if (flags & DD_ARENA_NUMA_BIND)
+        f                      |= dd::ARENA_NUMA_BIND;
+
+    dd_arena_t *arena       = new (std::nothrow) dd_arena_t;
+    if (arena == NULL)
+        return NULL;
+    if (arena->sArena.init(node, f) != lsp::STATUS_OK)
+    {
+        delete arena;
+        return NULL;
+    }
+
+    return arena;
+}
+
+DD_API void dd_arena_destroy(dd_arena_t *arena)
+{
+    delete arena;
+}
+
+DD_API int32_t dd_arena_node(const dd_arena_t *arena)
+{
+    return (arena != NULL) ? int32_t(arena->sArena.node()) : DD_NODE_ANY;
+}
+
+DD_API uint64_t dd_arena_mapped(const dd_arena_t *arena)
+{
+    return (arena != NULL) ? uint64_t(arena->sArena.mapped()) : 0;
+}
+
+DD_API uint32_t dd_channels(const dd_detector_t *dd)
+{
+    return (dd != NULL) ? uint32_t(dd->pDetector->channels()) : 0;
+}
+
+DD_API int dd_set_sample_rate(dd_detector_t *dd, uint32_t sample_rate)
+{
+    if ((dd == NULL) || (sample_rate <= 0))
+        return DD_EBADARG;
+
+    dd->pDetector->set_sample_rate(sample_rate);
+    return DD_OK;
+}
+
+DD_API int dd_set_param(dd_detector_t *dd, dd_param_t param, double value)
+{
+    if (dd == NULL)
+        return DD_EBADARG;
+
+    dd::DamageDetector *d   = dd->pDetector;
+    const float fv          = float(value);
+    const bool bv           = value >= 0.5;
+
+    switch (param)
+    {
+        case DD_PARAM_THRESHOLD:        d->set_threshold(fv); break;
+        case DD_PARAM_REACTIVITY:       d->set_reactivity(fv); break;
+        case DD_PARAM_DETECT_TIME:      d->set_detect_time(fv); break;
+        case DD_PARAM_ESTIMATE_TIME:    d->set_estimation_time(fv); break;
+        case DD_PARAM_EV_THRESHOLD:     d->set_event_threshold(size_t(lsp::lsp_limit(value, 0.0, double(UINT32_MAX)))); break;
+        case DD_PARAM_EV_PERIOD:        d->set_event_period(fv); break;
+        case DD_PARAM_BYPASS:           d->set_bypass(bv); break;
+        case DD_PARAM_CLICKS:           d->set_click_detection(bv); break;
+        case DD_PARAM_CLICK_RATIO:      d->set_click_ratio(fv); break;
+        case DD_PARAM_FLAT_TIME:        d->set_flatline_time(fv); break;
+        case DD_PARAM_GAP_EVENTS:       d->set_gap_events(bv); break;
+        case DD_PARAM_ADAPTIVE:         d->set_adaptive(bv); break;
+        case DD_PARAM_ADAPT_QUANTILE:   d->set_adaptive_quantile(fv); break;
+        case DD_PARAM_ADAPT_OFFSET:     d->set_adaptive_offset(fv); break;
+        case DD_PARAM_ADAPT_TIME:       d->set_adaptive_time(fv); break;
+        case DD_PARAM_LINKED:           d->set_linked(bv); break;
+        case DD_PARAM_HYSTERESIS:       d->set_hysteresis(fv); break;
+        case DD_PARAM_OPEN_DEBOUNCE:    d->set_open_debounce(fv); break;
+        case DD_PARAM_CLOSE_DEBOUNCE:   d->set_close_debounce(fv); break;
+        default:
+            return DD_EBADARG;
+    }
+
+    return DD_OK;
+}
+
+DD_API int dd_get_param(const dd_detector_t *dd, dd_param_t param, double *value)
+{
+    if ((dd == NULL) || (value == NULL))
+        return DD_EBADARG;
+
+    const dd::DamageDetector *d = dd->pDetector;
+
+    switch (param)
+    {
+        case DD_PARAM_THRESHOLD:        *value = d->threshold(); break;
+        case DD_PARAM_REACTIVITY:       *value = d->reactivity(); break;
+        case DD_PARAM_DETECT_TIME:      *value = d->detect_time(); break;
+        case DD_PARAM_ESTIMATE_TIME:    *value = d->estimation_time(); break;
+        case DD_PARAM_EV_THRESHOLD:     *value = d->event_threshold(); break;
+        case DD_PARAM_EV_PERIOD:        *value = d->event_period(); break;
+        case DD_PARAM_BYPASS:           *value = (d->bypass()) ? 1.0 : 0.0; break;
+        case DD_PARAM_CLICKS:           *value = (d->click_detection()) ? 1.0 : 0.0; break;
+        case DD_PARAM_CLICK_RATIO:      *value = d->click_ratio(); break;
+        case DD_PARAM_FLAT_TIME:        *value = d->flatline_time(); break;
+        case DD_PARAM_GAP_EVENTS:       *value = (d->gap_events()) ? 1.0 : 0.0; break;
+        case DD_PARAM_ADAPTIVE:         *value = (d->adaptive()) ? 1.0 : 0.0; break;
+        case DD_PARAM_ADAPT_QUANTILE:   *value = d->adaptive_quantile(); break;
+        case DD_PARAM_ADAPT_OFFSET:     *value = d->adaptive_offset(); break;
+        case DD_PARAM_ADAPT_TIME:       *value = d->adaptive_time(); break;
+        case DD_PARAM_LINKED:           *value = (d->linked()) ? 1.0 : 0.0; break;
+        case DD_PARAM_HYSTERESIS:       *value = d->hysteresis(); break;
+        case DD_PARAM_OPEN_DEBOUNCE:    *value = d->open_debounce(); break;
+        case DD_PARAM_CLOSE_DEBOUNCE:   *value = d->close_debounce(); break;
+        default:
+            return DD_EBADARG;
+    }
+
+    return DD_OK;
+}
+
+DD_API int dd_process_planar(dd_detector_t *dd, const float * const *in, float * const *out, size_t samples)
+{
+    if ((dd == NULL) || (in == NULL))
+        return DD_EBADARG;
+
+    dd::DamageDetector *d   = dd->pDetector;
+    const size_t channels   = d->channels();
+    for (size_t i=0; i<channels; ++i)
+    {
+        if ((in[i] == NULL) || ((out != NULL) && (out[i] == NULL)))
+            return DD_EBADARG;
+    }
+
+    lsp::dsp::context_t ctx;
+    lsp::dsp::start(&ctx);
+    lsp_finally { lsp::dsp::finish(&ctx); };
+
+    // Caller-owned buffers are passed to the detector directly
+    if (out != NULL)
+    {
+        for (size_t i=0; i<channels; ++i)
+        {
+            d->bind_input(i, in[i]);
+            d->bind_output(i, out[i]);
+        }
+        d->process(samples);
+        return DD_OK;
+    }
+
+    // The output is not needed, use the internal buffer
+    for (size_t offset=0; offset < samples; )
+    {
+        const size_t to_do      = lsp::lsp_min(dd::capi::BUF_SIZE, samples - offset);
+        for (size_t i=0; i<channels; ++i)
+        {
+            d->bind_input(i, &in[i][offset]);
+            d->bind_output(i, &dd->vBuffer[i * dd::capi::BUF_SIZE]);
+        }
+        d->process(to_do);
+        offset                 += to_do;
+    }
+
+    return DD_OK;
+}
+
+DD_API int dd_process_interleaved(dd_detector_t *dd, const float *in, float *out, size_t frames)
+{
+    if ((dd == NULL) || (in == NULL))
+        return DD_EBADARG;
+
+    lsp::dsp::context_t ctx;
+    lsp::dsp::start(&ctx);
+    lsp_finally { lsp::dsp::finish(&ctx); };
+
+    dd::DamageDetector *d   = dd->pDetector;
+    const size_t channels   = d->channels();
+
+    for (size_t offset=0; offset < frames; )
+    {
+        const size_t to_do      = lsp::lsp_min(dd::capi::BUF_SIZE, frames - offset);
+
+        // De-interleave data and bind audio buffers
+        for (size_t i=0; i<channels; ++i)
+        {
+            float *buf              = &dd->vBuffer[i * dd::capi::BUF_SIZE];
+            const float *s          = &in[i];
+            for (size_t j=0; j<to_do; ++j, s += channels)
+                buf[j]                  = *s;
+
+            d->bind_input(i, buf);
+            d->bind_output(i, buf);
+        }
+
+        d->process(to_do);
+
+        // Interleave data
+        if (out != NULL)
+        {
+            for (size_t i=0; i<channels; ++i)
+            {
+                const float *buf        = &dd->vBuffer[i * dd::capi::BUF_SIZE];
+                float *s                = &out[i];
+                for (size_t j=0; j<to_do; ++j, s += channels)
+                    *s                      = buf[j];
+            }
+            out                    += to_do * channels;
+        }
+
+        in                     += to_do * channels;
+        offset                 += to_do;
+    }
+
+    return DD_OK;
+}
+
+DD_API int dd_process_gap(dd_detector_t *dd, size_t samples)
+{
+    if (dd == NULL)
+        return DD_EBADARG;
+
+    dd->pDetector->process_gap(samples);
+    return DD_OK;
+}
+
+DD_API int dd_poll_event(dd_detector_t *dd, dd_event_t *event)
+{
+    if ((dd == NULL) || (event == NULL))
+        return DD_EBADARG;
+
+    dd::DamageDetector *d   = dd->pDetector;
+    const dd::event_type_t ev = d->poll_event();
+    if (ev == dd::EVENT_NONE)
+        return 0;
+
+    event->type             = (ev == dd::EVENT_ABOVE) ? DD_EVENT_ABOVE : DD_EVENT_BELOW;
+    event->events           = uint32_t(d->events_count());
+    event->timestamp        = d->timestamp();
+
+    return 1;
+}
+
+DD_API int dd_set_event_callback(dd_detector_t *dd, dd_event_callback_t callback, void *arg)
+{
+    if (dd == NULL)
+        return DD_EBADARG;
+
+    dd->sListener.pCallback = callback;
+    dd->sListener.pArg      = arg;
+    dd->pDetector->set_event_listener((callback != NULL) ? &dd->sListener : NULL);
+
+    return DD_OK;
+}
+
+DD_API int dd_poll_flatline(dd_detector_t *dd, dd_flatline_t *event)
+{
+    if ((dd == NULL) || (event == NULL))
+        return DD_EBADARG;
+
+    dd::flatline_t flat;
+    if (!dd->pDetector->poll_flatline(&flat))
+        return 0;
+
+    event->channel          = flat.nChannel;
+    event->active           = (flat.bActive) ? 1 : 0;
+    event->value            = flat.fValue;
+    event->reserved         = 0;
+    event->start            = flat.nStart;
+
+    return 1;
+}
+
+DD_API uint64_t dd_timestamp(const dd_detector_t *dd)
+{
+    return (dd != NULL) ? dd->pDetector->timestamp() : 0;
+}
+
+DD_API uint64_t dd_time(const dd_detector_t *dd)
+{
+    return (dd != NULL) ? dd->pDetector->time() : 0;
+}
+
+DD_API uint32_t dd_events_count(const dd_detector_t *dd)
+{
+    return (dd != NULL) ? uint32_t(dd->pDetector->events_count()) : 0;
+}
+
+DD_API uint64_t dd_total_events(const dd_detector_t *dd)
+{
+    return (dd != NULL) ? dd->pDetector->total_events() : 0;
+}
+
+DD_API uint64_t dd_coalesced_events(const dd_detector_t *dd)
+{
+    return (dd != NULL) ? dd->pDetector->coalesced_events() : 0;
+}
@@ -0,0 +1,302 @@
+/*
+ * Copyright (C) 2024 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2024 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of damage-detector
+ * Created on: 18 окт. 2026 г.
+ *
+ * damage-detector is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * damage-detector is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with damage-detector. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <private/Arena.h>
+
+#include <lsp-plug.in/common/alloc.h>
+#include <lsp-plug.in/common/finally.h>
+
+#ifdef PLATFORM_UNIX_COMPATIBLE
+    #include <sys/mman.h>
+    #include <unistd.h>
+#endif /* PLATFORM_UNIX_COMPATIBLE */
+
+#ifdef __linux__
+    #include <linux/mempolicy.h>
+    #include <sys/syscall.h>
+#endif /* __linux__ */
+
+namespace dd
+{
+    static constexpr ssize_t    MAX_NUMA_NODE       = sizeof(unsigned long) * 8 - 1;    // Nodes that fit into the node mask
+
+    Arena::Arena()
+    {
+        pChunks         = NULL;
+        pHead           = NULL;
+        nLeft           = 0;
+        for (size_t i=0; i<CLASSES; ++i)
+            vFree[i]        = NULL;
+        pLarge          = NULL;
+        nNode           = NODE_ANY;
+        nFlags          = 0;
+        nMapped         = 0;
+        nHuge           = 0;
+        nUsed           = 0;
+    }
+
+    Arena::~Arena()
+    {
+        destroy();
+    }
+
+    lsp::status_t Arena::init(ssize_t node, size_t flags)
+    {
+        if (node < NODE_ANY)
+            return lsp::STATUS_BAD_ARGUMENTS;
+
+        destroy();
+
+        nNode           = (node == NODE_CURRENT) ? current_node() : node;
+        nFlags          = flags;
+
+        return lsp::STATUS_OK;
+    }
+
+    void Arena::destroy()
+    {
+        sLock.lock();
+        lsp_finally { sLock.unlock(); };
+
+        for (chunk_t *c = pChunks; c != NULL; )
+        {
+            chunk_t *next   = c->pNext;
+            unmap_chunk(c);
+            c               = next;
+        }
+
+        pChunks         = NULL;
+        pHead           = NULL;
+        nLeft           = 0;
+        for (size_t i=0; i<CLASSES; ++i)
+            vFree[i]        = NULL;
+        pLarge          = NULL;
+        nMapped         = 0;
+        nHuge           = 0;
+        nUsed           = 0;
+    }
+
+    ssize_t Arena::current_node()
+    {
+    #if defined(__linux__) && defined(SYS_getcpu)
+        unsigned int cpu    = 0;
+        unsigned int node   = 0;
+        if (syscall(SYS_getcpu, &cpu, &node, NULL) == 0)
+            return ssize_t(node);
+    #endif /* SYS_getcpu */
+
+        return NODE_ANY;
+    }
+
+    size_t Arena::size_class(size_t size)
+    {
+        size_t index    = 0;
+        for (size_t bsize = MIN_BLOCK; bsize < size; bsize <<= 1)
+            ++index;
+
+        return lsp::lsp_min(index, CLASSES);
+    }
+
+    Arena::chunk_t *Arena::map_chunk(size_t size)
+    {
+        uint8_t *addr   = NULL;
+        void *data      = NULL;
+        bool huge       = false;
+
+    #ifdef PLATFORM_UNIX_COMPATIBLE
+        #ifdef MAP_HUGETLB
+        // Explicit huge pages are available only if they have been reserved in the system
+        if (nFlags & ARENA_HUGE_PAGES)
+        {
+            void *ptr       = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+            if (ptr != MAP_FAILED)
+            {
+                addr            = static_cast<uint8_t *>(ptr);
+                huge            = true;
+            }
+        }
+        #endif /* MAP_HUGETLB */
+
+        if (addr == NULL)
+        {
+            // Align the chunk to its size, so it can be backed by transparent huge pages
+            const size_t to_map = size + CHUNK_SIZE;
+            void *ptr       = mmap(NULL, to_map, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (ptr == MAP_FAILED)
+                return NULL;
+
+            uint8_t *head   = static_cast<uint8_t *>(ptr);
+            uint8_t *tail   = head + to_map;
+            addr            = lsp::align_ptr(head, CHUNK_SIZE);
+            if (addr > head)
+                munmap(head, addr - head);
+            if (tail > addr + size)
+                munmap(addr + size, tail - (addr + size));
+
+        #ifdef MADV_HUGEPAGE
+            if (nFlags & ARENA_HUGE_PAGES)
+                madvise(addr, size, MADV_HUGEPAGE);
+        #endif /* MADV_HUGEPAGE */
+        }
+        data            = addr;
+
+        #if defined(__linux__) && defined(SYS_mbind)
+        // The policy should be set before the memory is touched for the first time
+        if ((nFlags & ARENA_NUMA_BIND) && (nNode >= 0) && (nNode < MAX_NUMA_NODE))
+        {
+            const unsigned long mask = 1UL << nNode;
+            syscall(SYS_mbind, addr, size, MPOL_PREFERRED, &mask, sizeof(mask) * 8, 0);
+        }
+        #endif /* SYS_mbind */
+    #else
+        uint8_t *ptr    = NULL;
+        addr            = lsp::alloc_aligned<uint8_t>(ptr, size, CHUNK_SIZE);
+        if (addr == NULL)
+            return NULL;
+        data            = ptr;
+    #endif /* PLATFORM_UNIX_COMPATIBLE */
+
+        chunk_t *c      = reinterpret_cast<chunk_t *>(addr);
+        c->pNext        = pChunks;
+        c->nSize        = size;
+        c->pData        = data;
+        pChunks         = c;
+
+        nMapped        += size;
+        if (huge)
+            nHuge          += size;
+
+        return c;
+    }
+
+    void Arena::unmap_chunk(chunk_t *chunk)
+    {
+    #ifdef PLATFORM_UNIX_COMPATIBLE
+        munmap(chunk->pData, chunk->nSize);
+    #else
+        lsp::free_aligned(chunk->pData);
+    #endif /* PLATFORM_UNIX_COMPATIBLE */
+    }
+
+    void Arena::release_tail()
+    {
+        // Split the rest of the chunk into free blocks of the largest sizes
+        for (ssize_t i=CLASSES-1; i >= 0; --i)
+        {
+            const size_t bsize  = MIN_BLOCK << i;
+            while (nLeft >= bsize)
+            {
+                block_t *b          = reinterpret_cast<block_t *>(pHead);
+                b->nSize            = bsize;
+                b->pNext            = vFree[i];
+                vFree[i]            = b;
+                pHead              += bsize;
+                nLeft              -= bsize;
+            }
+        }
+    }
+
+    void *Arena::alloc(size_t size)
+    {
+        const size_t total  = size + ALIGN;
+        const size_t index  = size_class(total);
+
+        sLock.lock();
+        lsp_finally { sLock.unlock(); };
+
+        block_t *b          = NULL;
+        if (index >= CLASSES)
+        {
+            // Large blocks occupy dedicated chunks
+            for (block_t **pb = &pLarge; *pb != NULL; pb = &(*pb)->pNext)
+            {
+                if ((*pb)->nSize >= total)
+                {
+                    b                   = *pb;
+                    *pb                 = b->pNext;
+                    break;
+                }
+            }
+
+            if (b == NULL)
+            {
+                chunk_t *c          = map_chunk(lsp::align_size(total + ALIGN, CHUNK_SIZE));
+                if (c == NULL)
+                    return NULL;
+                b                   = reinterpret_cast<block_t *>(reinterpret_cast<uint8_t *>(c) + ALIGN);
+                b->nSize            = c->nSize - ALIGN;
+            }
+        }
+        else if (vFree[index] != NULL)
+        {
+            b                   = vFree[index];
+            vFree[index]        = b->pNext;
+        }
+        else
+        {
+            const size_t bsize  = MIN_BLOCK << index;
+            if (nLeft < bsize)
+            {
+                release_tail();
+                chunk_t *c          = map_chunk(CHUNK_SIZE);
+                if (c == NULL)
+                    return NULL;
+                pHead               = reinterpret_cast<uint8_t *>(c) + ALIGN;
+                nLeft               = CHUNK_SIZE - ALIGN;
+            }
+
+            b                   = reinterpret_cast<block_t *>(pHead);
+            b->nSize            = bsize;
+            pHead              += bsize;
+            nLeft              -= bsize;
+        }
+
+        b->pNext            = NULL;
+        nUsed              += b->nSize;
+
+        return reinterpret_cast<uint8_t *>(b) + ALIGN;
+    }
+
+    void Arena::free(void *ptr)
+    {
+        if (ptr == NULL)
+            return;
+
+        block_t *b          = reinterpret_cast<block_t *>(static_cast<uint8_t *>(ptr) - ALIGN);
+        const size_t index  = size_class(b->nSize);
+
+        sLock.lock();
+        lsp_finally { sLock.unlock(); };
+
+        nUsed              -= b->nSize;
+        if (index >= CLASSES)
+        {
+            b->pNext            = pLarge;
+            pLarge              = b;
+        }
+        else
+        {
+            b->pNext            = vFree[index];
+            vFree[index]        = b;
+        }
+    }
+
+} /* namespace dd */
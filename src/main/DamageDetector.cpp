@@ -25,50 +25,177 @@
 #include <lsp-plug.in/common/types.h>
 #include <lsp-plug.in/dsp/dsp.h>
 #include <lsp-plug.in/dsp-units/units.h>
+#include <lsp-plug.in/stdlib/math.h>
 
 namespace dd
 {
     static constexpr size_t TMP_BUFFER_SIZE     = 0x400;
+    static constexpr size_t SCAN_BLOCK_SIZE     = 0x40;
+    static constexpr size_t CLICK_HIST_STRIDE   = 4;
+    static constexpr float  CLICK_HOLD_TIME     = 5.0f;     // Minimum interval between clicks, milliseconds
+    static constexpr float  CLICK_LEVEL_TIME    = 1.0f;     // Averaging time of the difference level, seconds
+    static constexpr size_t CLICK_LEVEL_PERIOD  = 0x40;     // Period of the difference level update aligned to the timestamp, samples
+    static constexpr float  ADAPT_PERIOD        = 10.0f;    // Period of the noise floor estimator update, milliseconds
+    static constexpr size_t LINK_BLOCK_SIZE     = 0x100;    // Analysis window of linked channels aligned to the timestamp, samples
+    static constexpr float  LINK_PHASE_CORR     = 0.5f;     // Minimum correlation magnitude to detect the phase flip
+    static constexpr float  LINK_CORR_K         = 0.05f;    // Smoothing factor of the correlation per block
+
+    static inline uint32_t sat_add(uint32_t a, uint32_t b)
+    {
+        return (a > UINT32_MAX - b) ? UINT32_MAX : a + b;
+    }
+
+    IEventListener::~IEventListener()
+    {
+    }
 
-    DamageDetector::DamageDetector(size_t channels)
+    DamageDetector::DamageDetector(size_t channels, Arena *arena)
     {
         vChannels                   = NULL;
+        vLinks                      = NULL;
+        sTrigger.vState             = NULL;
+        sTrigger.vThreshold         = NULL;
+        sTrigger.vRaiseTime         = NULL;
+        sTrigger.vFallTime          = NULL;
+        sTrigger.vOpenTime          = NULL;
+        sTrigger.vCloseTime         = NULL;
+        sTrigger.vDepth             = NULL;
+        sTrigger.vEvents            = NULL;
+        sTrigger.vClickLevel        = NULL;
+        sTrigger.vClickSum          = NULL;
+        sTrigger.vClickHold         = NULL;
+        sTrigger.vClickHist         = NULL;
+        sTrigger.vFlatState         = NULL;
+        sTrigger.vFlatNotify        = NULL;
+        sTrigger.vFlatValue         = NULL;
+        sTrigger.vFlatStart         = NULL;
         vBuffer                     = NULL;
+        vDiff                       = NULL;
+        vHist                       = NULL;
+        vZero                       = NULL;
+        vScratch                    = NULL;
+        vMid                        = NULL;
+        pJournal                    = NULL;
+        pIndex                      = NULL;
+        pListener                   = NULL;
         nTimestamp                  = 0;
+        nTimeBase                   = 0;
+        nTimeStart                  = 0;
+        nSettleTime                 = 0;
         nLastNotify                 = 0;
+        nGapStart                   = 0;
+        nLastEvent                  = 0;
+        nLastHist                   = 0;
+        nTotalEvents                = 0;
+        nCoalesced                  = 0;
         nChannels                   = channels;
         nSampleRate                 = 44100;
+        sWindows.init(nSampleRate);
         nDetectTime                 = 0;
-        nBounceTime                 = 0;
+        nOpenTime                   = 0;
+        nCloseTime                  = 0;
         nEstimateTime               = 0;
         nEventPeriod                = 0;
         nEventThreshold             = DFL_EV_TRHESHOLD;
+        nStormEvents                = STORM_MIN_EVENTS;
+        nClickHold                  = 0;
+        nFlatTime                   = 0;
+        nFlatSkip                   = 0;
+        nAdaptPeriod                = 0;
+        nHistPeriod                 = 0;
+        fClickRatioDB               = DFL_CLICK_RATIO;
+        fClickRatio                 = 0.0f;
+        fClickLevelTime             = 0.0f;
+        fClickLevelK                = 0.0f;
+        fFlatTime                   = DFL_FLAT_TIME;
+        fAdaptQuantile              = DFL_ADAPT_QUANTILE;
+        fAdaptOffsetDB              = DFL_ADAPT_OFFSET;
+        fAdaptOffset                = 0.0f;
+        fAdaptTime                  = DFL_ADAPT_TIME;
+        fThresholdMin               = 0.0f;
+        fHistPeriod                 = DFL_HIST_PERIOD;
         fDetectTime                 = DFL_DETECT_TIME;
         fThresholdDB                = DFL_THRESHOLD;
         fThreshold                  = 0.0f;
+        fHysteresisDB               = DFL_HYSTERESIS;
+        fHysteresis                 = 1.0f;
+        fOpenDebounce               = DFL_DEBOUNCE;
+        fCloseDebounce              = DFL_DEBOUNCE;
         fReactivity                 = DFL_REACTIVITY;
         fEstimateTime               = DFL_ESTIMATE_TIME;
         fEventPeriod                = DFL_EV_PERIOD;
         enLastEvent                 = EVENT_NONE;
         enPendingEvent              = EVENT_NONE;
         bBypass                     = true;
+        bClicks                     = false;
+        bGapEvents                  = false;
+        bGap                        = false;
+        bAdaptive                   = false;
+        bAdaptReset                 = true;
+        bLinked                     = false;
         bUpdate                     = true;
+        pArena                      = arena;
+        pData                       = NULL;
 
         const size_t szof_channels  = lsp::align_size(channels * sizeof(channel_t), DEFAULT_ALIGN);
         const size_t szof_buffer    = lsp::align_size(sizeof(float) * TMP_BUFFER_SIZE, DEFAULT_ALIGN);
         const size_t szof_evbuf     = lsp::align_size(MAX_EVENTS * sizeof(event_t), DEFAULT_ALIGN);
+        const size_t szof_state     = lsp::align_size(channels * sizeof(trg_state_t), DEFAULT_ALIGN);
+        const size_t szof_time      = lsp::align_size(channels * sizeof(timestamp_t), DEFAULT_ALIGN);
+        const size_t szof_float     = lsp::align_size(channels * sizeof(float), DEFAULT_ALIGN);
+        const size_t szof_count     = lsp::align_size(channels * sizeof(uint32_t), DEFAULT_ALIGN);
+        const size_t szof_hist      = lsp::align_size(channels * CLICK_HIST_STRIDE * sizeof(float), DEFAULT_ALIGN);
+        const size_t szof_diff      = lsp::align_size(sizeof(float) * (TMP_BUFFER_SIZE + CLICK_HIST_STRIDE), DEFAULT_ALIGN);
+        const size_t szof_links     = lsp::align_size((channels >> 1) * sizeof(link_t), DEFAULT_ALIGN);
 
         const size_t to_alloc       =
             szof_channels +
-            szof_buffer +
+            szof_links +
+            szof_buffer * 4 +
+            szof_diff * 2 +
+            szof_state +
+            szof_time * 6 +
+            szof_float * 5 +
+            szof_count * 3 +
+            szof_hist +
             szof_evbuf * channels;
 
-        uint8_t *ptr                = lsp::alloc_aligned<uint8_t>(pData, to_alloc, DEFAULT_ALIGN);
+        uint8_t *ptr                = (arena != NULL) ?
+            static_cast<uint8_t *>(arena->alloc(to_alloc)) :
+            lsp::alloc_aligned<uint8_t>(pData, to_alloc, DEFAULT_ALIGN);
         if (ptr == NULL)
             return;
+        if (arena != NULL)
+            pData                       = ptr;
+
+        // Hot data goes first to keep it compact
+        sTrigger.vState             = lsp::advance_ptr_bytes<trg_state_t>(ptr, szof_state);
+        sTrigger.vThreshold         = lsp::advance_ptr_bytes<float>(ptr, szof_float);
+        sTrigger.vRaiseTime         = lsp::advance_ptr_bytes<timestamp_t>(ptr, szof_time);
+        sTrigger.vFallTime          = lsp::advance_ptr_bytes<timestamp_t>(ptr, szof_time);
+        sTrigger.vOpenTime          = lsp::advance_ptr_bytes<timestamp_t>(ptr, szof_time);
+        sTrigger.vCloseTime         = lsp::advance_ptr_bytes<timestamp_t>(ptr, szof_time);
+        sTrigger.vDepth             = lsp::advance_ptr_bytes<float>(ptr, szof_float);
+        sTrigger.vEvents            = lsp::advance_ptr_bytes<uint32_t>(ptr, szof_count);
+        sTrigger.vClickLevel        = lsp::advance_ptr_bytes<float>(ptr, szof_float);
+        sTrigger.vClickSum          = lsp::advance_ptr_bytes<float>(ptr, szof_float);
+        sTrigger.vClickHold         = lsp::advance_ptr_bytes<timestamp_t>(ptr, szof_time);
+        sTrigger.vClickHist         = lsp::advance_ptr_bytes<float>(ptr, szof_hist);
+        sTrigger.vFlatState         = lsp::advance_ptr_bytes<uint32_t>(ptr, szof_count);
+        sTrigger.vFlatNotify        = lsp::advance_ptr_bytes<uint32_t>(ptr, szof_count);
+        sTrigger.vFlatValue         = lsp::advance_ptr_bytes<float>(ptr, szof_float);
+        sTrigger.vFlatStart         = lsp::advance_ptr_bytes<timestamp_t>(ptr, szof_time);
+        vBuffer                     = lsp::advance_ptr_bytes<float>(ptr, szof_buffer);
+        vDiff                       = lsp::advance_ptr_bytes<float>(ptr, szof_diff);
+        vHist                       = lsp::advance_ptr_bytes<float>(ptr, szof_diff);
+        vZero                       = lsp::advance_ptr_bytes<float>(ptr, szof_buffer);
+        vScratch                    = lsp::advance_ptr_bytes<float>(ptr, szof_buffer);
+        vMid                        = lsp::advance_ptr_bytes<float>(ptr, szof_buffer);
 
+        lsp::dsp::fill_zero(vZero, TMP_BUFFER_SIZE);
         vChannels                   = lsp::advance_ptr_bytes<channel_t>(ptr, szof_channels);
-        vBuffer                     = lsp::advance_ptr_bytes<float>(ptr, szof_buffer);
+        vLinks                      = lsp::advance_ptr_bytes<link_t>(ptr, szof_links);
+        reset_links();
 
         for (size_t i=0; i<channels; ++i)
         {
@@ -80,52 +207,93 @@ namespace dd
             c->sSC.set_source(lsp::dspu::SCS_MIDDLE);
             c->sSC.set_sample_rate(nSampleRate);
 
-            c->sEvBuf.nHead             = 0.0f;
-            c->sEvBuf.nTail             = 0.0f;
-            c->sEvBuf.nCount            = 0.0f;
-
-            c->nOpenTime                = 0;
-            c->nCloseTime               = 0;
-            c->nRaiseTime               = 0;
-            c->nFallTime                = 0;
-            c->nEvents                  = 0;
-            c->enState                  = TRG_CLOSED;
-
             c->sEvBuf.vData             = lsp::advance_ptr_bytes<event_t>(ptr, szof_evbuf);
             c->sEvBuf.nHead             = 0;
             c->sEvBuf.nTail             = 0;
+            c->sEvBuf.nItems            = 0;
             c->sEvBuf.nCount            = 0;
 
+            c->sFloor.init(DFL_ADAPT_QUANTILE * 0.01f);
+            c->fEnvSum                  = 0.0f;
+            c->nEnvCount                = 0;
+            for (size_t j=0; j<HIST_TOTAL; ++j)
+                c->vHistograms[j].clear();
+            c->nLastEvent               = 0;
+            c->nStorm                   = 0;
+            c->bEvent                   = false;
+            c->bDropout                 = false;
+            c->bStorm                   = false;
+            c->vIn                      = NULL;
+            c->vOut                     = NULL;
+
             clear_event_buf(&c->sEvBuf);
+
+            sTrigger.vState[i]          = TRG_CLOSED;
+            sTrigger.vThreshold[i]      = 0.0f;
+            sTrigger.vRaiseTime[i]      = 0;
+            sTrigger.vFallTime[i]       = 0;
+            sTrigger.vOpenTime[i]       = 0;
+            sTrigger.vCloseTime[i]      = 0;
+            sTrigger.vDepth[i]          = 0.0f;
+            sTrigger.vEvents[i]         = 0;
+            sTrigger.vClickLevel[i]     = -1.0f;
+            sTrigger.vClickSum[i]       = 0.0f;
+            sTrigger.vClickHold[i]      = 0;
+            lsp::dsp::fill_zero(&sTrigger.vClickHist[i * CLICK_HIST_STRIDE], CLICK_HIST_STRIDE);
+            sTrigger.vFlatState[i]      = FLAT_NONE;
+            sTrigger.vFlatNotify[i]     = 0;
+            sTrigger.vFlatValue[i]      = 0.0f;
+            sTrigger.vFlatStart[i]      = 0;
         }
     }
 
     DamageDetector::~DamageDetector()
     {
-        lsp::free_aligned(pData);
+        if (vChannels != NULL)
+        {
+            for (size_t i=0; i<nChannels; ++i)
+                vChannels[i].sSC.destroy();
+            vChannels       = NULL;
+        }
+
+        if (pArena != NULL)
+            pArena->free(pData);
+        else
+            lsp::free_aligned(pData);
+        pData           = NULL;
     }
 
     void DamageDetector::clear_event_buf(event_buf_t *buf)
     {
         buf->nHead              = 0;
         buf->nTail              = 0;
+        buf->nItems             = 0;
         buf->nCount             = 0;
 
         for (size_t i=0; i<MAX_EVENTS; ++i)
+        {
             buf->vData[i].nTimestamp    = 0;
+            buf->vData[i].nWeight       = 0;
+        }
     }
 
-    size_t DamageDetector::push_event(event_buf_t *buf, timestamp_t ts)
+    size_t DamageDetector::push_event(event_buf_t *buf, timestamp_t ts, uint32_t weight)
     {
         // Drop last event if we don't have too much space
-        if (buf->nCount >= MAX_EVENTS)
-            buf->nTail = (buf->nTail + 1) % MAX_EVENTS;
+        if (buf->nItems >= MAX_EVENTS)
+        {
+            buf->nCount    -= buf->vData[buf->nTail].nWeight;
+            buf->nTail      = (buf->nTail + 1) % MAX_EVENTS;
+        }
         else
-            ++buf->nCount;
+            ++buf->nItems;
 
         // Push event to the buffer
-        buf->vData[buf->nHead].nTimestamp   = ts;
-        buf->nHead = (buf->nHead + 1) % MAX_EVENTS;
+        event_t *ev         = &buf->vData[buf->nHead];
+        ev->nTimestamp      = ts;
+        ev->nWeight         = weight;
+        buf->nCount         = sat_add(buf->nCount, weight);
+        buf->nHead          = (buf->nHead + 1) % MAX_EVENTS;
 
         update_event_buf(buf, ts);
 
@@ -136,18 +304,42 @@ namespace dd
     void DamageDetector::update_event_buf(event_buf_t *buf, timestamp_t ts)
     {
         // Drop events that are too late relative to the current time
-        while (buf->nCount > 0)
+        while (buf->nItems > 0)
         {
-            const size_t ev_ts = buf->vData[buf->nTail].nTimestamp;
-            if ((ev_ts + nEstimateTime) >= ts)
+            const event_t *ev   = &buf->vData[buf->nTail];
+            if ((ev->nTimestamp + nEstimateTime) >= ts)
                 break;
 
             // Remove this event
-            --buf->nCount;
+            --buf->nItems;
+            buf->nCount    -= lsp::lsp_min(buf->nCount, ev->nWeight);
             buf->nTail = (buf->nTail + 1) % MAX_EVENTS;
         }
     }
 
+    void DamageDetector::finish_events(size_t channel)
+    {
+        channel_t *c            = &vChannels[channel];
+        event_buf_t *buf        = &c->sEvBuf;
+
+        // Account events coalesced during the block as a single entry
+        if (c->nStorm > 0)
+        {
+            const size_t events     = push_event(buf, c->nLastEvent, c->nStorm);
+            sTrigger.vEvents[channel]   = lsp::lsp_max(sTrigger.vEvents[channel], uint32_t(events));
+            sWindows.submit(c->nLastEvent, c->nStorm);
+            nCoalesced             += c->nStorm;
+            c->nStorm               = 0;
+        }
+
+        // Remove old events from buffer
+        update_event_buf(buf, nTimestamp);
+
+        // Leave the storm mode with hysteresis
+        if ((c->bStorm) && (buf->nCount <= (nStormEvents >> 1)))
+            c->bStorm               = false;
+    }
+
     void DamageDetector::update_settings()
     {
         if (!bUpdate)
@@ -156,14 +348,67 @@ namespace dd
         fThreshold      = lsp::dspu::db_to_gain(fThresholdDB);
         nDetectTime     = lsp::dspu::seconds_to_samples(nSampleRate, fDetectTime);
         nEstimateTime   = lsp::dspu::seconds_to_samples(nSampleRate, fEstimateTime);
-        nBounceTime     = lsp::dspu::millis_to_samples(nSampleRate, fReactivity * 0.1f);
+        fHysteresis     = lsp::dspu::db_to_gain(-fHysteresisDB);
+        nOpenTime       = lsp::dspu::millis_to_samples(nSampleRate, (fOpenDebounce >= 0.0f) ? fOpenDebounce : fReactivity * 0.1f);
+        nCloseTime      = lsp::dspu::millis_to_samples(nSampleRate, (fCloseDebounce >= 0.0f) ? fCloseDebounce : fReactivity * 0.1f);
         nEventPeriod    = lsp::dspu::seconds_to_samples(nSampleRate, fEventPeriod);
+        nStormEvents    = lsp::lsp_limit(size_t(nEventThreshold) * STORM_FACTOR, STORM_MIN_EVENTS, MAX_EVENTS - 1);
+        nClickHold      = lsp::dspu::millis_to_samples(nSampleRate, CLICK_HOLD_TIME);
+        fClickRatio     = lsp::dspu::db_to_gain(fClickRatioDB);
+        fClickLevelTime = lsp::dspu::seconds_to_samples(nSampleRate, CLICK_LEVEL_TIME);
+        fClickLevelK    = 1.0f - expf(-float(CLICK_LEVEL_PERIOD) / fClickLevelTime);
+        nFlatTime       = lsp::dspu::seconds_to_samples(nSampleRate, fFlatTime);
+        nFlatSkip       = lsp::lsp_max(uint32_t(lsp::dspu::millis_to_samples(nSampleRate, fReactivity)), uint32_t(CLICK_HIST_STRIDE));
+        nAdaptPeriod    = lsp::lsp_max(uint32_t(lsp::dspu::millis_to_samples(nSampleRate, ADAPT_PERIOD)), uint32_t(1));
+        fAdaptOffset    = lsp::dspu::db_to_gain(fAdaptOffsetDB);
+        fThresholdMin   = lsp::dspu::db_to_gain(MIN_THRESHOLD);
+        nHistPeriod     = lsp::dspu::seconds_to_samples(nSampleRate, fHistPeriod);
+
+        // The estimator is updated once per period, so the window is specified in updates
+        const size_t window = fAdaptTime * 1000.0f / ADAPT_PERIOD;
 
         for (size_t i=0; i<nChannels; ++i)
         {
             channel_t *c                = &vChannels[i];
             c->sSC.set_reactivity(fReactivity);
+
+            if (bAdaptReset)
+            {
+                c->sFloor.init(fAdaptQuantile * 0.01f, window);
+                c->fEnvSum                  = 0.0f;
+                c->nEnvCount                = 0;
+            }
+
+            sTrigger.vThreshold[i]      = adaptive_threshold(i);
         }
+
+        bAdaptReset     = false;
+    }
+
+    float DamageDetector::adaptive_threshold(size_t channel) const
+    {
+        const P2Quantile *q     = &vChannels[channel].sFloor;
+        if ((!bAdaptive) || (!q->ready()))
+            return fThreshold;
+
+        return lsp::lsp_limit(q->value() * fAdaptOffset, fThresholdMin, GAIN_AMP_0_DB);
+    }
+
+    void DamageDetector::update_threshold(size_t channel, size_t samples)
+    {
+        channel_t *c            = &vChannels[channel];
+
+        // Feed the estimator with the average envelope at the rate independent of the block size
+        c->fEnvSum             += lsp::dsp::h_sum(vBuffer, samples);
+        c->nEnvCount           += samples;
+        if (c->nEnvCount < nAdaptPeriod)
+            return;
+
+        c->sFloor.update(c->fEnvSum / c->nEnvCount);
+        c->fEnvSum              = 0.0f;
+        c->nEnvCount            = 0;
+
+        sTrigger.vThreshold[channel]    = adaptive_threshold(channel);
     }
 
     void DamageDetector::set_sample_rate(size_t sample_rate)
@@ -171,23 +416,68 @@ namespace dd
         if (sample_rate == nSampleRate)
             return;
 
-        nTimestamp      = 0;
-        nLastNotify     = 0;
-        enLastEvent     = EVENT_NONE;
-        enPendingEvent  = EVENT_NONE;
-        nSampleRate     = sample_rate;
+        // The timestamp is re-derived from the rate-independent time, so repeated
+        // changes of the sample rate do not accumulate rounding errors
+        const timestamp_t time  = this->time();
+        const timestamp_t now   = (time / TIME_UNITS) * sample_rate + ((time % TIME_UNITS) * sample_rate) / TIME_UNITS;
+        const size_t old_rate   = nSampleRate;
+        nTimeBase       = time;
+        nTimeStart      = now;
+
+        // Stored timestamps keep their distance in time to the current moment
+        nLastNotify     = rescale(nLastNotify, now, old_rate, sample_rate);
+        nGapStart       = rescale(nGapStart, now, old_rate, sample_rate);
+        nLastEvent      = rescale(nLastEvent, now, old_rate, sample_rate);
+        nLastHist       = rescale(nLastHist, now, old_rate, sample_rate);
 
         for (size_t i=0; i<nChannels; ++i)
         {
             channel_t *c                = &vChannels[i];
-
-            c->sSC.set_sample_rate(nSampleRate);
-            clear_event_buf(&c->sEvBuf);
+            event_buf_t *buf            = &c->sEvBuf;
+
+            c->sSC.set_sample_rate(sample_rate);
+            for (size_t j=0, k=buf->nTail; j<buf->nItems; ++j, k = (k + 1) % MAX_EVENTS)
+                buf->vData[k].nTimestamp    = rescale(buf->vData[k].nTimestamp, now, old_rate, sample_rate);
+            c->nLastEvent               = rescale(c->nLastEvent, now, old_rate, sample_rate);
+            c->nEnvCount                = (uint64_t(c->nEnvCount) * sample_rate) / old_rate;
+
+            sTrigger.vRaiseTime[i]      = rescale(sTrigger.vRaiseTime[i], now, old_rate, sample_rate);
+            sTrigger.vFallTime[i]       = rescale(sTrigger.vFallTime[i], now, old_rate, sample_rate);
+            sTrigger.vOpenTime[i]       = rescale(sTrigger.vOpenTime[i], now, old_rate, sample_rate);
+            sTrigger.vCloseTime[i]      = rescale(sTrigger.vCloseTime[i], now, old_rate, sample_rate);
+            sTrigger.vClickHold[i]      = rescale(sTrigger.vClickHold[i], now, old_rate, sample_rate);
+            sTrigger.vFlatStart[i]      = rescale(sTrigger.vFlatStart[i], now, old_rate, sample_rate);
         }
 
+        for (size_t i=0, n=nChannels >> 1; i<n; ++i)
+            vLinks[i].nStart            = rescale(vLinks[i].nStart, now, old_rate, sample_rate);
+
+        // The sidechain restarts the envelope at the new sample rate, the trigger is not
+        // allowed to close until the envelope settles
+        nTimestamp      = now;
+        nSettleTime     = now + lsp::dspu::millis_to_samples(sample_rate, fReactivity);
+        nSampleRate     = sample_rate;
+        sWindows.set_sample_rate(nSampleRate, nTimestamp);
         bUpdate         = true;
     }
 
+    timestamp_t DamageDetector::rescale(timestamp_t ts, timestamp_t now, size_t old_rate, size_t new_rate) const
+    {
+        // Timestamps in the future (hold times) are rescaled relative to the current moment too
+        if (ts > nTimestamp)
+            return now + ((ts - nTimestamp) * new_rate + (old_rate >> 1)) / old_rate;
+
+        const timestamp_t age   = nTimestamp - ts;
+        const timestamp_t delta = (age / old_rate) * new_rate + ((age % old_rate) * new_rate + (old_rate >> 1)) / old_rate;
+        return (delta < now) ? now - delta : 0;
+    }
+
+    timestamp_t DamageDetector::time() const
+    {
+        const timestamp_t delta = nTimestamp - nTimeStart;
+        return nTimeBase + (delta / nSampleRate) * TIME_UNITS + ((delta % nSampleRate) * TIME_UNITS) / nSampleRate;
+    }
+
     void DamageDetector::set_detect_time(float detect_time)
     {
         detect_time     = lsp::lsp_limit(detect_time, MIN_DETECT_TIME, MAX_DETECT_TIME);
@@ -221,6 +511,36 @@ namespace dd
         bUpdate         = true;
     }
 
+    void DamageDetector::set_hysteresis(float hysteresis)
+    {
+        hysteresis      = lsp::lsp_limit(hysteresis, MIN_HYSTERESIS, MAX_HYSTERESIS);
+        if (fHysteresisDB == hysteresis)
+            return;
+
+        fHysteresisDB   = hysteresis;
+        bUpdate         = true;
+    }
+
+    void DamageDetector::set_open_debounce(float debounce)
+    {
+        debounce        = (debounce >= 0.0f) ? lsp::lsp_limit(debounce, MIN_DEBOUNCE, MAX_DEBOUNCE) : DFL_DEBOUNCE;
+        if (fOpenDebounce == debounce)
+            return;
+
+        fOpenDebounce   = debounce;
+        bUpdate         = true;
+    }
+
+    void DamageDetector::set_close_debounce(float debounce)
+    {
+        debounce        = (debounce >= 0.0f) ? lsp::lsp_limit(debounce, MIN_DEBOUNCE, MAX_DEBOUNCE) : DFL_DEBOUNCE;
+        if (fCloseDebounce == debounce)
+            return;
+
+        fCloseDebounce  = debounce;
+        bUpdate         = true;
+    }
+
     void DamageDetector::set_event_period(float period)
     {
         period          = lsp::lsp_limit(period, MIN_EV_PERIOD, MAX_EV_PERIOD);
@@ -238,6 +558,97 @@ namespace dd
         bUpdate         = true;
     }
 
+    void DamageDetector::set_click_detection(bool enable)
+    {
+        if (bClicks == enable)
+            return;
+
+        bClicks         = enable;
+
+        // Restart the estimation of the difference level
+        for (size_t i=0; i<nChannels; ++i)
+        {
+            sTrigger.vClickLevel[i]     = -1.0f;
+            sTrigger.vClickSum[i]       = 0.0f;
+            sTrigger.vClickHold[i]      = 0;
+            lsp::dsp::fill_zero(&sTrigger.vClickHist[i * CLICK_HIST_STRIDE], CLICK_HIST_STRIDE);
+        }
+    }
+
+    void DamageDetector::set_click_ratio(float ratio)
+    {
+        ratio           = lsp::lsp_limit(ratio, MIN_CLICK_RATIO, MAX_CLICK_RATIO);
+        if (fClickRatioDB == ratio)
+            return;
+
+        fClickRatioDB   = ratio;
+        bUpdate         = true;
+    }
+
+    void DamageDetector::set_flatline_time(float time)
+    {
+        time            = lsp::lsp_limit(time, MIN_FLAT_TIME, MAX_FLAT_TIME);
+        if (fFlatTime == time)
+            return;
+
+        fFlatTime       = time;
+        bUpdate         = true;
+    }
+
+    void DamageDetector::set_gap_events(bool enable)
+    {
+        bGapEvents      = enable;
+    }
+
+    void DamageDetector::set_adaptive(bool enable)
+    {
+        if (bAdaptive == enable)
+            return;
+
+        bAdaptive       = enable;
+        bAdaptReset     = true;
+        bUpdate         = true;
+    }
+
+    void DamageDetector::set_adaptive_quantile(float quantile)
+    {
+        quantile        = lsp::lsp_limit(quantile, MIN_ADAPT_QUANTILE, MAX_ADAPT_QUANTILE);
+        if (fAdaptQuantile == quantile)
+            return;
+
+        fAdaptQuantile  = quantile;
+        bAdaptReset     = true;
+        bUpdate         = true;
+    }
+
+    void DamageDetector::set_adaptive_offset(float offset)
+    {
+        offset          = lsp::lsp_limit(offset, MIN_ADAPT_OFFSET, MAX_ADAPT_OFFSET);
+        if (fAdaptOffsetDB == offset)
+            return;
+
+        fAdaptOffsetDB  = offset;
+        bUpdate         = true;
+    }
+
+    void DamageDetector::set_adaptive_time(float time)
+    {
+        time            = lsp::lsp_limit(time, MIN_ADAPT_TIME, MAX_ADAPT_TIME);
+        if (fAdaptTime == time)
+            return;
+
+        fAdaptTime      = time;
+        bAdaptReset     = true;
+        bUpdate         = true;
+    }
+
+    float DamageDetector::channel_threshold(size_t channel) const
+    {
+        if ((channel >= nChannels) || (!bAdaptive) || (bUpdate))
+            return fThresholdDB;
+        return lsp::dspu::gain_to_db(sTrigger.vThreshold[channel]);
+    }
+
     void DamageDetector::set_threshold(float thresh)
     {
         thresh          = lsp::lsp_limit(thresh, MIN_THRESHOLD, MAX_THRESHOLD);
@@ -274,100 +685,667 @@ namespace dd
         return event;
     }
 
-    void DamageDetector::generate_events(channel_t *c, size_t samples)
+    bool DamageDetector::poll_flatline(flatline_t *event)
     {
-        float s = 0.0f; // Current sample
+        trigger_t *t            = &sTrigger;
+
+        for (size_t i=0; i<nChannels; ++i)
+        {
+            const uint32_t notify   = t->vFlatNotify[i];
+            if (notify == 0)
+                continue;
+
+            // Deliver the start notification before the finish notification
+            const uint32_t flag     = (notify & FLAT_NOTIFY_START) ? FLAT_NOTIFY_START : FLAT_NOTIFY_END;
+            t->vFlatNotify[i]       = notify & (~flag);
+
+            event->nChannel         = i;
+            event->bActive          = (flag == FLAT_NOTIFY_START);
+            event->fValue           = t->vFlatValue[i];
+            event->nStart           = t->vFlatStart[i];
+
+            return true;
+        }
 
-        for (size_t i=0; i<samples; ++i)
+        return false;
+    }
+
+    void DamageDetector::generate_events(size_t channel, size_t samples)
+    {
+        channel_t *c            = &vChannels[channel];
+        trigger_t *t            = &sTrigger;
+
+        // Keep the trigger state in local variables while processing
+        trg_state_t state       = t->vState[channel];
+        timestamp_t raise_time  = t->vRaiseTime[channel];
+        timestamp_t fall_time   = t->vFallTime[channel];
+        float depth             = t->vDepth[channel];
+        const float thresh      = t->vThreshold[channel];
+        const float release     = thresh * fHysteresis;
+
+        for (size_t offset=0; offset<samples; )
         {
-            s               = vBuffer[i];
-            timestamp_t ts  = nTimestamp + i;
+            const size_t to_do  = lsp::lsp_min(samples - offset, SCAN_BLOCK_SIZE);
+            const float *buf    = &vBuffer[offset];
 
-            // Update trigger state
-            switch (c->enState)
+            // Skip the whole block if trigger is in stable state and the signal does not cross the threshold
+            // of the state, fluctuations between the close and the open threshold are rejected here
+            if (((state == TRG_CLOSED) && (lsp::dsp::max(buf, to_do) < thresh)) ||
+                ((state == TRG_OPEN) && (lsp::dsp::min(buf, to_do) >= release)))
             {
-                case TRG_CLOSED:
-                    if (s < fThreshold)
-                        break;
+                offset     += to_do;
+                continue;
+            }
 
-                    c->enState      = TRG_OPENING;
-                    c->nRaiseTime   = ts;
-                    break;
-                case TRG_OPENING:
-                    if (s < fThreshold)
-                        c->enState      = TRG_CLOSED;
-                    else if ((ts - c->nRaiseTime) > nBounceTime)
-                    {
-                        c->nOpenTime    = ts;
-                        c->enState      = TRG_OPEN;
-                    }
-                    break;
+            for (size_t i=0; i<to_do; ++i)
+            {
+                const float s       = buf[i];
+                const timestamp_t ts= nTimestamp + offset + i;
+
+                // Update trigger state
+                switch (state)
+                {
+                    case TRG_CLOSED:
+                        if (s < thresh)
+                            break;
 
-                case TRG_OPEN:
-                    if (s >= fThreshold)
+                        state           = TRG_OPENING;
+                        raise_time      = ts;
+                        break;
+                    case TRG_OPENING:
+                        if (s < thresh)
+                            state           = TRG_CLOSED;
+                        else if ((ts - raise_time) > nOpenTime)
+                        {
+                            t->vOpenTime[channel]   = ts;
+                            state           = TRG_OPEN;
+                            if (c->bDropout)
+                                finish_dropout(channel, fall_time, raise_time);
+                        }
                         break;
 
-                    c->enState      = TRG_CLOSING;
-                    c->nFallTime    = ts;
-                    break;
+                    case TRG_OPEN:
+                        if ((s >= release) || (ts < nSettleTime))
+                            break;
 
-                case TRG_CLOSING:
-                    if (s >= fThreshold)
-                        c->enState  = TRG_OPEN;
-                    else if ((ts - c->nFallTime) > nBounceTime)
-                    {
-                        c->nCloseTime   = ts;
-                        c->enState      = TRG_CLOSED;
+                        state           = TRG_CLOSING;
+                        fall_time       = ts;
+                        depth           = s;
+                        break;
 
-                        // We need to check that we have had enough time trigger was opened
-                        if (c->nFallTime < (c->nRaiseTime + nDetectTime))
+                    case TRG_CLOSING:
+                        depth           = lsp::lsp_min(depth, s);
+                        if (s >= release)
+                            state           = TRG_OPEN;
+                        else if ((ts - fall_time) > nCloseTime)
                         {
-                            const size_t events = push_event(&c->sEvBuf, ts);
-                            c->nEvents      = lsp::lsp_max(c->nEvents, events);
+                            t->vCloseTime[channel]  = ts;
+                            state           = TRG_CLOSED;
+
+                            // We need to check that we have had enough time trigger was opened,
+                            // the drop of the mid signal caused by the phase flip is counted by the link
+                            if ((fall_time < (raise_time + nDetectTime)) && (!phase_flip(channel)))
+                                submit_dropout(channel, fall_time, ts, depth);
+
+                            // Output the event detection signal
+                            if (!bBypass)
+                                c->vOut[offset + i] = 1.0f;
                         }
+                        break;
 
-                        // Output the event detection signal
-                        if (!bBypass)
-                            c->vOut[i]      = 1.0f;
-                    }
-                    break;
+                    default:
+                        break;
+                }
+            }
 
-                default:
-                    break;
+            offset     += to_do;
+        }
+
+        // Store the trigger state
+        t->vState[channel]      = state;
+        t->vRaiseTime[channel]  = raise_time;
+        t->vFallTime[channel]   = fall_time;
+        t->vDepth[channel]      = depth;
+    }
+
+    bool DamageDetector::submit_event(size_t channel, timestamp_t ts)
+    {
+        channel_t *c            = &vChannels[channel];
+        nLastEvent              = lsp::lsp_max(nLastEvent, ts);
+        ++nTotalEvents;
+
+        // In the storm mode the event is only counted, the work per event does not depend
+        // on the number of events in the buffer
+        if (c->bStorm)
+        {
+            c->nLastEvent           = ts;
+            c->nStorm               = sat_add(c->nStorm, 1);
+            return false;
+        }
+
+        if ((c->bEvent) && (ts >= c->nLastEvent))
+            c->vHistograms[HIST_INTERVAL].add(to_micros(ts - c->nLastEvent));
+        c->nLastEvent           = ts;
+        c->bEvent               = true;
+
+        const size_t events     = push_event(&c->sEvBuf, ts, 1);
+        sTrigger.vEvents[channel]   = lsp::lsp_max(sTrigger.vEvents[channel], uint32_t(events));
+        sWindows.submit(ts);
+        if (events > nStormEvents)
+            c->bStorm               = true;
+
+        // Deliver the crossing of the event threshold right at the triggering sample
+        if ((pListener != NULL) && (enLastEvent != EVENT_ABOVE) && (events_count() > nEventThreshold))
+            notify(EVENT_ABOVE, ts);
+
+        return true;
+    }
+
+    void DamageDetector::submit_dropout(size_t channel, timestamp_t start, timestamp_t ts, float depth)
+    {
+        channel_t *c            = &vChannels[channel];
+
+        // Coalesced dropouts are not logged and their duration is not measured
+        if (!submit_event(channel, ts))
+            return;
+
+        // Log the dropout
+        c->bDropout             = true;
+        c->vHistograms[HIST_DELAY].add(to_micros(ts - start));
+        if (pJournal != NULL)
+            pJournal->submit_dropout(
+                channel, start, ts,
+                lsp::dspu::gain_to_db(lsp::lsp_max(depth, GAIN_AMP_M_140_DB)));
+    }
+
+    void DamageDetector::finish_dropout(size_t channel, timestamp_t start, timestamp_t end)
+    {
+        channel_t *c            = &vChannels[channel];
+
+        c->vHistograms[HIST_DROPOUT].add(to_micros(end - start));
+        c->bDropout             = false;
+    }
+
+    void DamageDetector::compute_diff(size_t channel, const float *src, size_t samples)
+    {
+        // Prepend the signal with the last samples of the previous block:
+        // vHist[i + 3] = x[i], vHist[i] = x[i - 3]
+        float *hist             = &sTrigger.vClickHist[channel * CLICK_HIST_STRIDE];
+        vHist[0]                = hist[0];
+        vHist[1]                = hist[1];
+        vHist[2]                = hist[2];
+        lsp::dsp::copy(&vHist[3], src, samples);
+
+        // d[i] = x[i] - 3*x[i-1] + 3*x[i-2] - x[i-3]
+        lsp::dsp::sub3(vDiff, &vHist[3], &vHist[0], samples);
+        lsp::dsp::fmadd_k3(vDiff, &vHist[1], 3.0f, samples);
+        lsp::dsp::fmadd_k3(vDiff, &vHist[2], -3.0f, samples);
+
+        // Store the history
+        hist[0]                 = vHist[samples];
+        hist[1]                 = vHist[samples + 1];
+        hist[2]                 = vHist[samples + 2];
+    }
+
+    void DamageDetector::detect_clicks(size_t channel, size_t samples)
+    {
+        channel_t *c            = &vChannels[channel];
+        trigger_t *t            = &sTrigger;
+        float level             = t->vClickLevel[channel];
+        float sum               = t->vClickSum[channel];
+
+        // The average level of the difference is updated at periods aligned to the timestamp,
+        // so detected clicks do not depend on the block size. Clicks are not detected until
+        // the level has been estimated for the first period
+        for (size_t offset=0; offset<samples; )
+        {
+            const size_t phase      = (nTimestamp + offset) % CLICK_LEVEL_PERIOD;
+            const size_t to_do      = lsp::lsp_min(samples - offset, CLICK_LEVEL_PERIOD - phase);
+            const float *diff       = &vDiff[offset];
+            const float thresh      = lsp::lsp_max(level * fClickRatio, GAIN_AMP_M_60_DB);
+
+            // Scan the period only if it contains peaks above the threshold
+            if ((level >= 0.0f) && (lsp::dsp::abs_max(diff, to_do) >= thresh))
+            {
+                timestamp_t hold        = t->vClickHold[channel];
+
+                for (size_t i=0; i<to_do; ++i)
+                {
+                    const float s           = fabsf(diff[i]);
+                    const timestamp_t ts    = nTimestamp + offset + i;
+                    if ((s < thresh) || (ts < hold))
+                        continue;
+
+                    hold                    = ts + nClickHold;
+
+                    // Log the click
+                    if ((submit_event(channel, ts)) && (pJournal != NULL))
+                        pJournal->submit_click(channel, ts, lsp::dspu::gain_to_db(s / lsp::lsp_max(level, GAIN_AMP_M_140_DB)));
+
+                    // Output the event detection signal
+                    if (!bBypass)
+                        c->vOut[offset + i]     = 1.0f;
+                }
+
+                t->vClickHold[channel]  = hold;
             }
+
+            sum                    += lsp::dsp::h_abs_sum(diff, to_do);
+            if ((phase + to_do) >= CLICK_LEVEL_PERIOD)
+            {
+                level                   = update_click_level(level, sum);
+                sum                     = 0.0f;
+            }
+            offset                 += to_do;
         }
+
+        t->vClickLevel[channel] = level;
+        t->vClickSum[channel]   = sum;
     }
 
-    void DamageDetector::process(size_t samples)
+    float DamageDetector::update_click_level(float level, float sum) const
     {
-        // Apply new changes if they are
-        update_settings();
+        const float avg         = sum / CLICK_LEVEL_PERIOD;
+        return (level < 0.0f) ? avg : level + (avg - level) * fClickLevelK;
+    }
 
-        // Prepare data
-        for (size_t i=0; i<nChannels; ++i)
+    void DamageDetector::report_flatline(size_t channel, timestamp_t now)
+    {
+        trigger_t *t            = &sTrigger;
+        if (t->vFlatState[channel] != FLAT_RUN)
+            return;
+
+        // Report the flatline if the signal stays constant long enough, the time of
+        // detection does not depend on the block size
+        const timestamp_t start = t->vFlatStart[channel];
+        if ((now - start) < nFlatTime)
+            return;
+
+        t->vFlatState[channel]      = FLAT_ACTIVE;
+        t->vFlatNotify[channel]    |= FLAT_NOTIFY_START;
+
+        if (pJournal != NULL)
+            pJournal->submit_flatline(
+                channel, start, start + nFlatTime,
+                lsp::dspu::gain_to_db(lsp::lsp_max(fabsf(t->vFlatValue[channel]), GAIN_AMP_M_140_DB)));
+    }
+
+    void DamageDetector::start_flatline(size_t channel, float value, timestamp_t start)
+    {
+        trigger_t *t            = &sTrigger;
+
+        // Finish the previous flatline
+        if (t->vFlatState[channel] == FLAT_ACTIVE)
+            t->vFlatNotify[channel]    |= FLAT_NOTIFY_END;
+
+        t->vFlatState[channel]      = FLAT_RUN;
+        t->vFlatValue[channel]      = value;
+        t->vFlatStart[channel]      = start;
+    }
+
+    bool DamageDetector::check_flatline(size_t channel, const float *src, size_t samples)
+    {
+        trigger_t *t            = &sTrigger;
+
+        // The block is constant if its minimum is equal to its maximum
+        float min, max;
+        lsp::dsp::minmax(src, samples, &min, &max);
+
+        if (min == max)
         {
-            channel_t *c    = &vChannels[i];
-            c->nEvents      = c->sEvBuf.nCount;
+            if ((t->vFlatState[channel] == FLAT_NONE) || (t->vFlatValue[channel] != min))
+                start_flatline(channel, min, nTimestamp);
+            report_flatline(channel, nTimestamp + samples);
+
+            // The envelope has settled if the signal was constant for the whole sidechain window
+            return (nTimestamp - t->vFlatStart[channel]) >= nFlatSkip;
+        }
+
+        // The run of the constant signal may continue at the beginning of the block
+        size_t head             = 0;
+        if (t->vFlatState[channel] != FLAT_NONE)
+        {
+            const float value       = t->vFlatValue[channel];
+            while (src[head] == value)
+                ++head;
+            report_flatline(channel, nTimestamp + head);
+        }
+
+        // The run of the constant signal at the end of the block continues in the next block
+        const float last        = src[samples - 1];
+        size_t tail             = samples - 1;
+        while ((tail > head) && (src[tail - 1] == last))
+            --tail;
+
+        // Look for runs of the constant signal inside of the block only if they may be long enough
+        if ((tail - head) >= nFlatTime)
+        {
+            for (size_t i=head; i < tail; )
+            {
+                const float value       = src[i];
+                size_t end              = i + 1;
+                while ((end < tail) && (src[end] == value))
+                    ++end;
+
+                if ((end - i) >= nFlatTime)
+                {
+                    start_flatline(channel, value, nTimestamp + i);
+                    report_flatline(channel, nTimestamp + end);
+                }
+                i                       = end;
+            }
+        }
+
+        start_flatline(channel, last, nTimestamp + tail);
+        return false;
+    }
+
+    void DamageDetector::process_flatline(size_t channel, size_t samples)
+    {
+        channel_t *c            = &vChannels[channel];
+        trigger_t *t            = &sTrigger;
+
+        if (!bBypass)
+            lsp::dsp::fill_zero(c->vOut, samples);
+
+        // The RMS envelope of the constant signal is equal to its absolute value,
+        // so the trigger needs to be processed only if it is not in the stable state
+        const float env         = fabsf(t->vFlatValue[channel]);
+        if (pIndex != NULL)
+            pIndex->append_const(channel, env, samples);
+
+        const trg_state_t state = t->vState[channel];
+        const float thresh      = t->vThreshold[channel];
+        if (((state != TRG_CLOSED) || (env >= thresh)) &&
+            ((state != TRG_OPEN) || (env < thresh * fHysteresis)))
+        {
+            lsp::dsp::fill(vBuffer, env, samples);
+            generate_events(channel, samples);
+        }
+
+        if (bClicks)
+            decay_clicks(channel, samples);
+    }
+
+    void DamageDetector::decay_clicks(size_t channel, size_t samples)
+    {
+        // The difference of the constant signal is zero, just decay its average level
+        // exactly as detect_clicks() does at each period boundary
+        trigger_t *t            = &sTrigger;
+        float level             = t->vClickLevel[channel];
+        float sum               = t->vClickSum[channel];
+        const size_t phase      = nTimestamp % CLICK_LEVEL_PERIOD;
+        for (size_t n = (phase + samples) / CLICK_LEVEL_PERIOD; n > 0; --n)
+        {
+            level                   = update_click_level(level, sum);
+            sum                     = 0.0f;
+        }
+
+        t->vClickLevel[channel] = level;
+        t->vClickSum[channel]   = sum;
+    }
+
+    void DamageDetector::set_linked(bool linked)
+    {
+        if (bLinked == linked)
+            return;
+
+        bLinked         = linked;
+        reset_links();
+    }
+
+    void DamageDetector::reset_links()
+    {
+        for (size_t i=0; i<(nChannels >> 1); ++i)
+        {
+            link_t *lk              = &vLinks[i];
+            lk->enState             = LINK_NONE;
+            lk->nChannel            = 0;
+            lk->nStart              = 0;
+            lk->fCorr               = 0.0f;
+            lk->fValue              = 0.0f;
+            lk->bActive             = false;
+            clear_link_window(lk);
+
+            // The trigger of the second channel is not used in the linked mode
+            sTrigger.vState[i*2 + 1]    = TRG_CLOSED;
+        }
+    }
+
+    void DamageDetector::clear_link_window(link_t *link)
+    {
+        link->fSumL             = 0.0f;
+        link->fSumR             = 0.0f;
+        link->fSumLR            = 0.0f;
+        link->nCount            = 0;
+    }
+
+    void DamageDetector::finish_link(link_t *link, timestamp_t ts)
+    {
+        if ((pJournal != NULL) && (link->enState == LINK_IMBALANCE))
+            pJournal->submit_imbalance(link->nChannel, link->nStart, ts,
+                lsp::dspu::gain_to_db(lsp::lsp_max(link->fValue, GAIN_AMP_M_140_DB)));
+        else if ((pJournal != NULL) && (link->enState == LINK_PHASE))
+            pJournal->submit_phase(link->nChannel, link->nStart, ts, link->fValue);
+
+        link->enState           = LINK_NONE;
+    }
+
+    void DamageDetector::evaluate_link(size_t channel, timestamp_t ts)
+    {
+        link_t *lk              = &vLinks[channel >> 1];
+        const float thresh      = sTrigger.vThreshold[channel];
+        const float thresh2     = thresh * thresh;
+
+        // Mean square of each channel compared to the trigger threshold
+        const float k           = 1.0f / LINK_BLOCK_SIZE;
+        const float ll          = lk->fSumL * k;
+        const float rr          = lk->fSumR * k;
+        const bool l_on         = ll >= thresh2;
+        const bool r_on         = rr >= thresh2;
+        const bool active       = l_on && r_on;
+        const float corr        = (active) ? lk->fSumLR * k / sqrtf(ll * rr) : 0.0f;
+
+        switch (lk->enState)
+        {
+            case LINK_NONE:
+                if ((lk->bActive) && (l_on != r_on))
+                {
+                    // One channel has dropped while the other one stays active
+                    lk->enState             = LINK_IMBALANCE;
+                    lk->nChannel            = (l_on) ? channel + 1 : channel;
+                    lk->nStart              = ts;
+                    lk->fValue              = sqrtf(lsp::lsp_min(ll, rr) / lsp::lsp_max(ll, rr));
+                    submit_event(lk->nChannel, ts);
+                }
+                else if ((active) && (lk->fCorr >= LINK_PHASE_CORR) && (corr <= -LINK_PHASE_CORR))
+                {
+                    // Correlated channels went to the opposite phase. The flip is counted once: if the
+                    // mid signal has already dropped since the previous window, its dropout counts the flip
+                    lk->enState             = LINK_PHASE;
+                    lk->nChannel            = channel + 1;
+                    lk->nStart              = ts;
+                    lk->fValue              = corr;
+                    if ((!vChannels[channel].bDropout) || ((sTrigger.vFallTime[channel] + LINK_BLOCK_SIZE) < ts))
+                        submit_event(lk->nChannel, ts);
+                }
+                else if (active)
+                    lk->fCorr              += (corr - lk->fCorr) * LINK_CORR_K;
+                break;
+
+            case LINK_IMBALANCE:
+                if (l_on == r_on)
+                    finish_link(lk, ts);
+                else
+                    lk->fValue              = lsp::lsp_min(lk->fValue, sqrtf(lsp::lsp_min(ll, rr) / lsp::lsp_max(ll, rr)));
+                break;
+
+            case LINK_PHASE:
+                if ((!active) || (corr >= 0.0f))
+                    finish_link(lk, ts);
+                else
+                    lk->fValue              = lsp::lsp_min(lk->fValue, corr);
+                break;
+
+            default:
+                break;
+        }
+
+        lk->bActive             = active;
+    }
+
+    bool DamageDetector::phase_flip(size_t channel) const
+    {
+        // The mid signal of the pair cancels out while channels are in the opposite phase
+        if ((!bLinked) || (channel & 1) || ((channel + 1) >= nChannels))
+            return false;
+        return vLinks[channel >> 1].enState == LINK_PHASE;
+    }
+
+    void DamageDetector::analyze_link(size_t channel, const float *left, const float *right, size_t samples)
+    {
+        link_t *lk              = &vLinks[channel >> 1];
+
+        // Levels and correlation are accumulated over windows aligned to the timestamp,
+        // so detected anomalies do not depend on the block size
+        for (size_t offset=0; offset<samples; )
+        {
+            const size_t phase      = (nTimestamp + offset) % LINK_BLOCK_SIZE;
+            const size_t to_do      = lsp::lsp_min(samples - offset, LINK_BLOCK_SIZE - phase);
+            const float *l          = &left[offset];
+            const float *r          = &right[offset];
+
+            lk->fSumL              += lsp::dsp::h_sqr_sum(l, to_do);
+            lk->fSumR              += lsp::dsp::h_sqr_sum(r, to_do);
+            lk->fSumLR             += lsp::dsp::h_dotp(l, r, to_do);
+            lk->nCount             += to_do;
+            offset                 += to_do;
+
+            if ((phase + to_do) < LINK_BLOCK_SIZE)
+                continue;
+
+            // The window interrupted by the gap or by the reset of the link is not evaluated
+            if (lk->nCount >= LINK_BLOCK_SIZE)
+                evaluate_link(channel, nTimestamp + offset - LINK_BLOCK_SIZE);
+            clear_link_window(lk);
+        }
+    }
+
+    void DamageDetector::process_pair(size_t channel, size_t samples)
+    {
+        channel_t *vc           = &vChannels[channel];
+        trigger_t *t            = &sTrigger;
+        bool flat[2];
+
+        for (size_t i=0; i<2; ++i)
+        {
+            lsp::dsp::sanitize2(vc[i].vOut, vc[i].vIn, samples);
+            flat[i]                 = check_flatline(channel + i, vc[i].vOut, samples);
+        }
+        analyze_link(channel, vc[0].vOut, vc[1].vOut, samples);
+
+        // Only one envelope of the mid signal is computed for the pair
+        bool stable             = false;
+        if ((flat[0]) && (flat[1]))
+        {
+            const float env         = fabsf(t->vFlatValue[channel] + t->vFlatValue[channel + 1]) * 0.5f;
+            const trg_state_t state = t->vState[channel];
+            const float thresh      = t->vThreshold[channel];
+            stable                  = ((state == TRG_CLOSED) && (env < thresh)) || ((state == TRG_OPEN) && (env >= thresh * fHysteresis));
+            lsp::dsp::fill(vBuffer, env, samples);
+        }
+        else
+        {
+            lsp::dsp::lr_to_mid(vMid, vc[0].vOut, vc[1].vOut, samples);
+            vc[0].sSC.process(vBuffer, const_cast<const float **>(&vMid), samples);
+            if (bAdaptive)
+                update_threshold(channel, samples);
+        }
+
+        if (pIndex != NULL)
+        {
+            pIndex->append(channel, vBuffer, samples);
+            pIndex->append(channel + 1, vBuffer, samples);
+        }
+
+        // Clicks are detected in each channel
+        for (size_t i=0; i<2; ++i)
+        {
+            channel_t *c            = &vc[i];
+            if ((bClicks) && (!flat[i]))
+                compute_diff(channel + i, c->vOut, samples);
+            if (!bBypass)
+                lsp::dsp::fill_zero(c->vOut, samples);
+            if (bClicks)
+            {
+                if (flat[i])
+                    decay_clicks(channel + i, samples);
+                else
+                    detect_clicks(channel + i, samples);
+            }
         }
 
+        if (!stable)
+            generate_events(channel, samples);
+    }
+
+    void DamageDetector::process_channels(size_t samples)
+    {
+        const size_t channels   = nChannels;
+        channel_t *vc           = vChannels;
+
+        // Prepare data
+        for (size_t i=0; i<channels; ++i)
+            sTrigger.vEvents[i] = vc[i].sEvBuf.nCount;
+
         // Pass data from input to output
         for (size_t offset = 0; offset < samples; )
         {
             const size_t to_do = lsp::lsp_min(samples - offset, TMP_BUFFER_SIZE);
 
             // Process each channel
-            for (size_t i=0; i<nChannels; ++i)
+            for (size_t i=0; i<channels; ++i)
             {
-                channel_t *c = &vChannels[i];
+                channel_t *c = &vc[i];
+
+                // Process the linked pair of channels at once
+                if ((bLinked) && ((i + 1) < channels))
+                {
+                    process_pair(i, to_do);
+                    for (size_t j=0; j<2; ++j, ++c)
+                    {
+                        c->vIn     += to_do;
+                        c->vOut    += to_do;
+                    }
+                    ++i;
+                    continue;
+                }
 
                 // Process sidechain and apply bypass
                 lsp::dsp::sanitize2(c->vOut, c->vIn, to_do);
-                c->sSC.process(vBuffer, const_cast<const float **>(&c->vOut), to_do);
-                if (!bBypass)
-                    lsp::dsp::fill_zero(c->vOut, samples);
 
-                // Generate events triggered by the detector
-                generate_events(c, to_do);
+                if (check_flatline(i, c->vOut, to_do))
+                {
+                    // Fast path for digital silence and constant signal
+                    process_flatline(i, to_do);
+                }
+                else
+                {
+                    if (bClicks)
+                        compute_diff(i, c->vOut, to_do);
+                    c->sSC.process(vBuffer, const_cast<const float **>(&c->vOut), to_do);
+                    if (pIndex != NULL)
+                        pIndex->append(i, vBuffer, to_do);
+                    if (bAdaptive)
+                        update_threshold(i, to_do);
+                    if (!bBypass)
+                        lsp::dsp::fill_zero(c->vOut, to_do);
+
+                    // Generate events triggered by the detector
+                    generate_events(i, to_do);
+                    if (bClicks)
+                        detect_clicks(i, to_do);
+                }
 
                 // Update pointers
                 c->vIn     += to_do;
@@ -379,50 +1357,311 @@ namespace dd
         }
 
         // Cleanup state
-        for (size_t i=0; i<nChannels; ++i)
+        for (size_t i=0; i<channels; ++i)
         {
-            channel_t *c    = &vChannels[i];
+            channel_t *c    = &vc[i];
 
-            // Remove old events from buffer
-            update_event_buf(&c->sEvBuf, nTimestamp);
+            // Account coalesced events and remove old events from buffer
+            finish_events(i);
 
             c->vIn          = NULL;
             c->vOut         = NULL;
         }
+    }
+
+    void DamageDetector::update_notification()
+    {
+        sWindows.advance(nTimestamp);
 
         // Check events and set event trigger flag
-        if (enPendingEvent == EVENT_NONE)
+        if (enPendingEvent != EVENT_NONE)
+            return;
+
+        const size_t num_events = events_count();
+        if (num_events > nEventThreshold)
         {
-            const size_t num_events = events_count();
-            if (num_events > nEventThreshold)
+            if ((enLastEvent != EVENT_ABOVE) || ((nLastNotify + nEventPeriod) <= nTimestamp))
+                notify(EVENT_ABOVE, nTimestamp);
+        }
+        else
+        {
+            if (enLastEvent == EVENT_ABOVE)
+                notify(EVENT_BELOW, nTimestamp);
+        }
+    }
+
+    void DamageDetector::notify(event_type_t type, timestamp_t ts)
+    {
+        nLastNotify     = ts;
+        if (pListener == NULL)
+        {
+            enPendingEvent  = type;
+            return;
+        }
+
+        // Deliver the notification immediately
+        notification_t ev;
+        ev.enType       = type;
+        ev.nEvents      = events_count();
+        ev.nTimestamp   = ts;
+
+        enLastEvent     = type;
+        pListener->on_event(&ev);
+    }
+
+    void DamageDetector::finish_gap()
+    {
+        if (!bGap)
+            return;
+
+        bGap            = false;
+        if (pJournal != NULL)
+            pJournal->submit_gap(nGapStart, nTimestamp);
+    }
+
+    void DamageDetector::process(size_t samples)
+    {
+        // Apply new changes if they are
+        update_settings();
+        finish_gap();
+
+        process_channels(samples);
+
+        // Check events and set event trigger flag
+        update_notification();
+    }
+
+    void DamageDetector::process_envelope(size_t samples)
+    {
+        update_settings();
+        finish_gap();
+
+        for (size_t i=0; i<nChannels; ++i)
+            sTrigger.vEvents[i] = vChannels[i].sEvBuf.nCount;
+
+        for (size_t offset = 0; offset < samples; )
+        {
+            const size_t to_do = lsp::lsp_min(samples - offset, TMP_BUFFER_SIZE);
+
+            for (size_t i=0; i<nChannels; ++i)
             {
-                if ((enLastEvent != EVENT_ABOVE) || ((nLastNotify + nEventPeriod) <= nTimestamp))
-                {
-                    nLastNotify     = nTimestamp;
-                    enPendingEvent  = EVENT_ABOVE;
-                }
+                channel_t *c = &vChannels[i];
+
+                // The envelope goes directly to the trigger
+                lsp::dsp::sanitize2(vBuffer, c->vIn, to_do);
+                if (bAdaptive)
+                    update_threshold(i, to_do);
+                if (!bBypass)
+                    lsp::dsp::fill_zero(c->vOut, to_do);
+
+                generate_events(i, to_do);
+
+                c->vIn     += to_do;
+                if (!bBypass)
+                    c->vOut    += to_do;
             }
-            else
+
+            offset     += to_do;
+            nTimestamp += to_do;
+        }
+
+        for (size_t i=0; i<nChannels; ++i)
+        {
+            channel_t *c    = &vChannels[i];
+            finish_events(i);
+            c->vIn          = NULL;
+            c->vOut         = NULL;
+        }
+
+        update_notification();
+    }
+
+    void DamageDetector::advance_silence(size_t channel, size_t samples)
+    {
+        trigger_t *t            = &sTrigger;
+        const timestamp_t end   = nTimestamp + samples;
+
+        // The RMS envelope of silence is below any threshold, so the trigger can only close
+        switch (t->vState[channel])
+        {
+            case TRG_OPENING:
+                t->vState[channel]      = TRG_CLOSED;
+                break;
+
+            case TRG_OPEN:
+                t->vState[channel]      = TRG_CLOSING;
+                t->vFallTime[channel]   = nTimestamp;
+                t->vDepth[channel]      = 0.0f;
+                // falls through
+
+            case TRG_CLOSING:
             {
-                if (enLastEvent == EVENT_ABOVE)
+                t->vDepth[channel]      = 0.0f;
+
+                // Same condition as in generate_events(): the trigger closes at the first
+                // sample which is more than nCloseTime samples after the fall time
+                const timestamp_t fall_time = t->vFallTime[channel];
+                const timestamp_t ts    = lsp::lsp_max(fall_time + nCloseTime + 1, nTimestamp);
+                if (ts >= end)
+                    break;
+
+                t->vCloseTime[channel]  = ts;
+                t->vState[channel]      = TRG_CLOSED;
+
+                if (fall_time < (t->vRaiseTime[channel] + nDetectTime))
+                    submit_dropout(channel, fall_time, ts, 0.0f);
+                break;
+            }
+
+            default:
+                break;
+        }
+
+    }
+
+    void DamageDetector::process_gap(size_t samples)
+    {
+        if (samples <= 0)
+            return;
+
+        update_settings();
+
+        const bool start        = !bGap;
+        if (start)
+        {
+            bGap            = true;
+            nGapStart       = nTimestamp;
+        }
+
+        // Process the beginning of the gap as real silence while the RMS envelope decays,
+        // the gap itself is reported instead of clicks at its boundaries. The gap may arrive
+        // as many short buffers, only the first nFlatSkip samples of the whole gap are processed
+        const bool clicks       = bClicks;
+        const timestamp_t covered = nTimestamp - nGapStart;
+        const size_t head       = (covered < nFlatSkip) ? lsp::lsp_min(samples, size_t(nFlatSkip - covered)) : 0;
+        bClicks                 = false;
+        for (size_t offset=0; offset < head; )
+        {
+            const size_t to_do      = lsp::lsp_min(head - offset, TMP_BUFFER_SIZE);
+            for (size_t i=0; i<nChannels; ++i)
+            {
+                vChannels[i].vIn        = vZero;
+                vChannels[i].vOut       = vScratch;
+            }
+            process_channels(to_do);
+            offset                 += to_do;
+        }
+        bClicks                 = clicks;
+
+        // The envelope has decayed to zero, advance the rest of the gap analytically
+        trigger_t *t            = &sTrigger;
+        const size_t tail       = samples - head;
+        if (tail > 0)
+        {
+            for (size_t i=0; i<nChannels; ++i)
+                advance_silence(i, tail);
+
+            // The envelope of the rest of the gap is zero, channels are interleaved
+            // by blocks to keep the index writer buffer bounded
+            if (pIndex != NULL)
+            {
+                for (size_t offset=0; offset < tail; offset += TMP_BUFFER_SIZE)
                 {
-                    nLastNotify     = nTimestamp;
-                    enPendingEvent  = EVENT_BELOW;
+                    const size_t to_do      = lsp::lsp_min(tail - offset, TMP_BUFFER_SIZE);
+                    for (size_t i=0; i<nChannels; ++i)
+                        pIndex->append_const(i, 0.0f, to_do);
                 }
             }
+
+            nTimestamp     += tail;
+            for (size_t i=0; i<nChannels; ++i)
+                update_event_buf(&vChannels[i].sEvBuf, nTimestamp);
         }
+
+        for (size_t i=0; i<nChannels; ++i)
+        {
+            // Restart the click detector after the gap
+            lsp::dsp::fill_zero(&t->vClickHist[i * CLICK_HIST_STRIDE], CLICK_HIST_STRIDE);
+            if (t->vClickLevel[i] > 0.0f)
+                t->vClickLevel[i]      *= expf(-float(samples) / fClickLevelTime);
+            t->vClickSum[i]         = 0.0f;
+
+            // Gap interrupts the flatline, it is reported separately
+            if (t->vFlatState[i] == FLAT_ACTIVE)
+                t->vFlatNotify[i]      |= FLAT_NOTIFY_END;
+            t->vFlatState[i]        = FLAT_NONE;
+        }
+
+        // The gap breaks the analysis window of linked channels
+        for (size_t i=0, n=nChannels >> 1; i<n; ++i)
+            clear_link_window(&vLinks[i]);
+
+        // Count the gap as an event
+        if ((start) && (bGapEvents) && (nChannels > 0))
+        {
+            submit_event(0, nGapStart);
+            finish_events(0);
+        }
+
+        update_notification();
+    }
+
+    void DamageDetector::set_histogram_period(float period)
+    {
+        period          = lsp::lsp_limit(period, MIN_HIST_PERIOD, MAX_HIST_PERIOD);
+        if (fHistPeriod == period)
+            return;
+
+        fHistPeriod     = period;
+        bUpdate         = true;
+    }
+
+    bool DamageDetector::poll_histograms()
+    {
+        if ((nHistPeriod <= 0) || ((nLastHist + nHistPeriod) > nTimestamp))
+            return false;
+
+        nLastHist       = nTimestamp;
+        return true;
+    }
+
+    const LogHistogram *DamageDetector::histogram(size_t channel, histogram_t type) const
+    {
+        return (channel < nChannels) ? &vChannels[channel].vHistograms[type] : NULL;
+    }
+
+    void DamageDetector::clear_histograms()
+    {
+        for (size_t i=0; i<nChannels; ++i)
+            for (size_t j=0; j<HIST_TOTAL; ++j)
+                vChannels[i].vHistograms[j].clear();
+    }
+
+    size_t DamageDetector::trigger_state(size_t channel) const
+    {
+        return (channel < nChannels) ? size_t(sTrigger.vState[channel]) : size_t(TRG_CLOSED);
+    }
+
+    bool DamageDetector::flatline_active(size_t channel) const
+    {
+        return (channel < nChannels) ? (sTrigger.vFlatState[channel] == FLAT_ACTIVE) : false;
+    }
+
+    bool DamageDetector::storm_active(size_t channel) const
+    {
+        return (channel < nChannels) ? vChannels[channel].bStorm : false;
     }
 
     size_t DamageDetector::events_count(size_t channel) const
     {
-        return (channel < nChannels) ? vChannels[channel].nEvents : 0;
+        return (channel < nChannels) ? sTrigger.vEvents[channel] : 0;
     }
 
     size_t DamageDetector::events_count() const
     {
         size_t result = 0;
         for (size_t i=0; i<nChannels; ++i)
-            result     += vChannels[i].nEvents;
+            result     += sTrigger.vEvents[i];
 
         return result;
     }
@@ -0,0 +1,348 @@
+/*
+ * Copyright (C) 2024 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2024 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of damage-detector
+ * Created on: 18 окт. 2026 г.
+ *
+ * damage-detector is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * damage-detector is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with damage-detector. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <private/EnvelopeIndex.h>
+
+#include <lsp-plug.in/common/alloc.h>
+#include <lsp-plug.in/common/debug.h>
+#include <lsp-plug.in/common/endian.h>
+#include <lsp-plug.in/common/finally.h>
+#include <lsp-plug.in/dsp/dsp.h>
+
+#include <string.h>
+
+namespace dd
+{
+    EnvelopeIndex::EnvelopeIndex()
+    {
+        hFile           = NULL;
+        vAccum          = NULL;
+        vFrames         = NULL;
+        memset(&sHeader, 0, sizeof(sHeader));
+        nCapacity       = 0;
+        nLost           = 0;
+        bWrite          = false;
+        pData           = NULL;
+    }
+
+    EnvelopeIndex::~EnvelopeIndex()
+    {
+        close();
+    }
+
+    lsp::status_t EnvelopeIndex::create(const char *path, size_t channels, size_t sample_rate, size_t decimation, float reactivity)
+    {
+        if (hFile != NULL)
+            return lsp::STATUS_OPENED;
+        if ((path == NULL) || (channels <= 0) || (channels > 0xffff) ||
+            (decimation < MIN_DECIMATION) || (decimation > MAX_DECIMATION))
+            return lsp::STATUS_BAD_ARGUMENTS;
+
+        // Allocate buffers
+        const size_t szof_accum     = lsp::align_size(channels * sizeof(accum_t), DEFAULT_ALIGN);
+        const size_t szof_frames    = lsp::align_size(DFL_CAPACITY * channels * sizeof(envelope_entry_t), DEFAULT_ALIGN);
+        uint8_t *data               = NULL;
+        uint8_t *ptr                = lsp::alloc_aligned<uint8_t>(data, szof_accum + szof_frames, DEFAULT_ALIGN);
+        if (ptr == NULL)
+            return lsp::STATUS_NO_MEM;
+        lsp_finally { lsp::free_aligned(data); };
+
+        FILE *fd = fopen(path, "wb");
+        if (fd == NULL)
+        {
+            lsp_warn("Could not create envelope index %s", path);
+            return lsp::STATUS_IO_ERROR;
+        }
+
+        vAccum                      = lsp::advance_ptr_bytes<accum_t>(ptr, szof_accum);
+        vFrames                     = lsp::advance_ptr_bytes<envelope_entry_t>(ptr, szof_frames);
+        memset(vAccum, 0, channels * sizeof(accum_t));
+
+        memset(&sHeader, 0, sizeof(sHeader));
+        sHeader.nMagic              = ENVELOPE_MAGIC;
+        sHeader.nVersion            = ENVELOPE_VERSION;
+        sHeader.nChannels           = channels;
+        sHeader.nSampleRate         = sample_rate;
+        sHeader.nDecimation         = decimation;
+        sHeader.fReactivity         = reactivity;
+
+        hFile                       = fd;
+        nCapacity                   = DFL_CAPACITY;
+        nLost                       = 0;
+        bWrite                      = true;
+        lsp::swap(pData, data);
+
+        // Write the header with no entries, it is updated when the index is closed
+        const lsp::status_t res     = write_header();
+        if (res != lsp::STATUS_OK)
+            close();
+
+        return res;
+    }
+
+    lsp::status_t EnvelopeIndex::open(const char *path)
+    {
+        if (hFile != NULL)
+            return lsp::STATUS_OPENED;
+        if (path == NULL)
+            return lsp::STATUS_BAD_ARGUMENTS;
+
+        FILE *fd = fopen(path, "rb");
+        if (fd == NULL)
+            return lsp::STATUS_NOT_FOUND;
+        lsp_finally {
+            if (fd != NULL)
+                fclose(fd);
+        };
+
+        envelope_header_t hdr;
+        if (fread(&hdr, sizeof(hdr), 1, fd) != 1)
+            return lsp::STATUS_CORRUPTED;
+
+        sHeader.nMagic              = LE_TO_CPU(hdr.nMagic);
+        sHeader.nVersion            = LE_TO_CPU(hdr.nVersion);
+        sHeader.nChannels           = LE_TO_CPU(hdr.nChannels);
+        sHeader.nSampleRate         = LE_TO_CPU(hdr.nSampleRate);
+        sHeader.nDecimation         = LE_TO_CPU(hdr.nDecimation);
+        sHeader.fReactivity         = LE_TO_CPU(hdr.fReactivity);
+        sHeader.nSamples            = LE_TO_CPU(hdr.nSamples);
+        sHeader.nEntries            = LE_TO_CPU(hdr.nEntries);
+
+        if ((sHeader.nMagic != ENVELOPE_MAGIC) ||
+            (sHeader.nVersion != ENVELOPE_VERSION) ||
+            (sHeader.nChannels <= 0) ||
+            (sHeader.nSampleRate <= 0) ||
+            (sHeader.nDecimation < MIN_DECIMATION) ||
+            (sHeader.nDecimation > MAX_DECIMATION))
+        {
+            memset(&sHeader, 0, sizeof(sHeader));
+            return lsp::STATUS_BAD_FORMAT;
+        }
+
+        hFile                       = fd;
+        fd                          = NULL;
+        bWrite                      = false;
+
+        return lsp::STATUS_OK;
+    }
+
+    lsp::status_t EnvelopeIndex::close()
+    {
+        if (hFile == NULL)
+            return lsp::STATUS_OK;
+
+        lsp::status_t res           = lsp::STATUS_OK;
+        if (bWrite)
+        {
+            // Account the incomplete entry and store it
+            const accum_t *a            = &vAccum[0];
+            sHeader.nSamples            = (sHeader.nEntries + a->nFrames) * sHeader.nDecimation + a->nCount;
+            for (size_t i=0; i<sHeader.nChannels; ++i)
+            {
+                if (vAccum[i].nCount > 0)
+                    emit(i);
+            }
+
+            res                         = flush(true);
+            if (res == lsp::STATUS_OK)
+                res                         = write_header();
+            if (nLost > 0)
+                lsp_warn("Lost %d envelope index entries", int(nLost));
+        }
+
+        if ((fclose(hFile) != 0) && (res == lsp::STATUS_OK))
+            res                         = lsp::STATUS_IO_ERROR;
+
+        hFile                       = NULL;
+        vAccum                      = NULL;
+        vFrames                     = NULL;
+        nCapacity                   = 0;
+        bWrite                      = false;
+        lsp::free_aligned(pData);
+
+        return res;
+    }
+
+    lsp::status_t EnvelopeIndex::write_header()
+    {
+        envelope_header_t hdr;
+        memset(&hdr, 0, sizeof(hdr));
+        hdr.nMagic                  = CPU_TO_LE(sHeader.nMagic);
+        hdr.nVersion                = CPU_TO_LE(sHeader.nVersion);
+        hdr.nChannels               = CPU_TO_LE(sHeader.nChannels);
+        hdr.nSampleRate             = CPU_TO_LE(sHeader.nSampleRate);
+        hdr.nDecimation             = CPU_TO_LE(sHeader.nDecimation);
+        hdr.fReactivity             = CPU_TO_LE(sHeader.fReactivity);
+        hdr.nSamples                = CPU_TO_LE(sHeader.nSamples);
+        hdr.nEntries                = CPU_TO_LE(sHeader.nEntries);
+
+        const long pos              = ftell(hFile);
+        if ((pos < 0) || (fseek(hFile, 0, SEEK_SET) != 0))
+            return lsp::STATUS_IO_ERROR;
+        if (fwrite(&hdr, sizeof(hdr), 1, hFile) != 1)
+            return lsp::STATUS_IO_ERROR;
+        if ((pos > 0) && (fseek(hFile, pos, SEEK_SET) != 0))
+            return lsp::STATUS_IO_ERROR;
+
+        return (fflush(hFile) == 0) ? lsp::STATUS_OK : lsp::STATUS_IO_ERROR;
+    }
+
+    void EnvelopeIndex::emit(size_t channel)
+    {
+        accum_t *a                  = &vAccum[channel];
+        if (a->nFrames >= nCapacity)
+        {
+            // The channel is too far ahead of others, try to make some room
+            flush(false);
+            if (a->nFrames >= nCapacity)
+            {
+                ++nLost;
+                a->nCount                   = 0;
+                return;
+            }
+        }
+
+        // Store extrema in the order they occurred
+        envelope_entry_t *e         = &vFrames[a->nFrames * sHeader.nChannels + channel];
+        const bool rising           = a->nMinPos <= a->nMaxPos;
+        e->fFirst                   = CPU_TO_LE((rising) ? a->fMin : a->fMax);
+        e->fSecond                  = CPU_TO_LE((rising) ? a->fMax : a->fMin);
+
+        ++a->nFrames;
+        a->nCount                   = 0;
+    }
+
+    lsp::status_t EnvelopeIndex::flush(bool all)
+    {
+        const size_t channels       = sHeader.nChannels;
+
+        // Find the number of frames completed by all channels
+        uint32_t ready              = (all) ? 0 : nCapacity;
+        uint32_t total              = 0;
+        for (size_t i=0; i<channels; ++i)
+        {
+            const uint32_t frames       = vAccum[i].nFrames;
+            ready                       = (all) ? lsp::lsp_max(ready, frames) : lsp::lsp_min(ready, frames);
+            total                       = lsp::lsp_max(total, frames);
+        }
+        if (ready <= 0)
+            return lsp::STATUS_OK;
+
+        // Write the frames and move the rest to the beginning of the buffer
+        const size_t row            = channels * sizeof(envelope_entry_t);
+        lsp::status_t res           = (fwrite(vFrames, row, ready, hFile) == ready) ? lsp::STATUS_OK : lsp::STATUS_IO_ERROR;
+        if (total > ready)
+            memmove(vFrames, &vFrames[ready * channels], (total - ready) * row);
+
+        for (size_t i=0; i<channels; ++i)
+            vAccum[i].nFrames          -= lsp::lsp_min(vAccum[i].nFrames, ready);
+        sHeader.nEntries           += ready;
+
+        return res;
+    }
+
+    void EnvelopeIndex::append(size_t channel, const float *env, size_t samples)
+    {
+        if ((!bWrite) || (channel >= sHeader.nChannels))
+            return;
+
+        accum_t *a                  = &vAccum[channel];
+        const size_t decimation     = sHeader.nDecimation;
+
+        while (samples > 0)
+        {
+            const size_t to_do          = lsp::lsp_min(samples, decimation - a->nCount);
+
+            size_t imin, imax;
+            lsp::dsp::minmax_index(env, to_do, &imin, &imax);
+            if ((a->nCount <= 0) || (env[imin] < a->fMin))
+            {
+                a->fMin                     = env[imin];
+                a->nMinPos                  = a->nCount + imin;
+            }
+            if ((a->nCount <= 0) || (env[imax] > a->fMax))
+            {
+                a->fMax                     = env[imax];
+                a->nMaxPos                  = a->nCount + imax;
+            }
+
+            a->nCount                  += to_do;
+            env                        += to_do;
+            samples                    -= to_do;
+            if (a->nCount >= decimation)
+                emit(channel);
+        }
+
+        if (a->nFrames >= (nCapacity >> 1))
+            flush(false);
+    }
+
+    void EnvelopeIndex::append_const(size_t channel, float env, size_t samples)
+    {
+        if ((!bWrite) || (channel >= sHeader.nChannels))
+            return;
+
+        accum_t *a                  = &vAccum[channel];
+        const size_t decimation     = sHeader.nDecimation;
+
+        while (samples > 0)
+        {
+            const size_t to_do          = lsp::lsp_min(samples, decimation - a->nCount);
+
+            if ((a->nCount <= 0) || (env < a->fMin))
+            {
+                a->fMin                     = env;
+                a->nMinPos                  = a->nCount;
+            }
+            if ((a->nCount <= 0) || (env > a->fMax))
+            {
+                a->fMax                     = env;
+                a->nMaxPos                  = a->nCount;
+            }
+
+            a->nCount                  += to_do;
+            samples                    -= to_do;
+            if (a->nCount >= decimation)
+                emit(channel);
+        }
+
+        if (a->nFrames >= (nCapacity >> 1))
+            flush(false);
+    }
+
+    size_t EnvelopeIndex::read(envelope_entry_t *dst, size_t frames)
+    {
+        if ((hFile == NULL) || (bWrite))
+            return 0;
+
+        const size_t channels       = sHeader.nChannels;
+        const size_t count          = fread(dst, channels * sizeof(envelope_entry_t), frames, hFile);
+        for (size_t i=0, n=count * channels; i<n; ++i)
+        {
+            dst[i].fFirst               = LE_TO_CPU(dst[i].fFirst);
+            dst[i].fSecond              = LE_TO_CPU(dst[i].fSecond);
+        }
+
+        return count;
+    }
+
+} /* namespace dd */
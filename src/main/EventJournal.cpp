@@ -0,0 +1,373 @@
+/*
+ * Copyright (C) 2024 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2024 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of damage-detector
+ * Created on: 18 окт. 2026 г.
+ *
+ * damage-detector is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * damage-detector is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with damage-detector. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <private/EventJournal.h>
+
+#include <lsp-plug.in/common/alloc.h>
+#include <lsp-plug.in/common/atomic.h>
+#include <lsp-plug.in/common/debug.h>
+#include <lsp-plug.in/common/endian.h>
+#include <lsp-plug.in/common/finally.h>
+
+namespace dd
+{
+    static constexpr size_t FLUSH_BUFFER_SIZE   = 0x100;
+
+    static const char *record_type(uint16_t type)
+    {
+        switch (type)
+        {
+            case JR_DROPOUT:    return "dropout";
+            case JR_FORMAT:     return "format";
+            case JR_OVERFLOW:   return "overflow";
+            case JR_CLICK:      return "click";
+            case JR_FLATLINE:   return "flatline";
+            case JR_GAP:        return "gap";
+            case JR_IMBALANCE:  return "imbalance";
+            case JR_PHASE:      return "phase";
+            default: break;
+        }
+        return "unknown";
+    }
+
+    //-------------------------------------------------------------------------
+    EventJournal::Writer::Writer(EventJournal *journal)
+    {
+        pJournal        = journal;
+    }
+
+    EventJournal::Writer::~Writer()
+    {
+        pJournal        = NULL;
+    }
+
+    lsp::status_t EventJournal::Writer::run()
+    {
+        while (!lsp::atomic_load(&pJournal->bStop))
+        {
+            // Sleep only if there was nothing to write
+            if (pJournal->flush() <= 0)
+                lsp::ipc::Thread::sleep(FLUSH_PERIOD);
+        }
+
+        // Write all records that are still pending
+        while (pJournal->flush() > 0)
+            /* nothing */;
+
+        return lsp::STATUS_OK;
+    }
+
+    //-------------------------------------------------------------------------
+    EventJournal::EventJournal()
+    {
+        vRecords        = NULL;
+        nCapacity       = 0;
+        nHead           = 0;
+        nTail           = 0;
+        nLost           = 0;
+        bStop           = 0;
+        hFile           = NULL;
+        pWriter         = NULL;
+
+        nSyncSample     = 0;
+        nSyncPts        = JOURNAL_NO_PTS;
+        nSampleRate     = 0;
+
+        pData           = NULL;
+    }
+
+    EventJournal::~EventJournal()
+    {
+        close();
+    }
+
+    lsp::status_t EventJournal::open(const char *path, size_t capacity)
+    {
+        if (hFile != NULL)
+            return lsp::STATUS_OPENED;
+        if ((path == NULL) || (capacity <= 0))
+            return lsp::STATUS_BAD_ARGUMENTS;
+
+        // Round up capacity to the power of 2
+        size_t cap = 1;
+        while (cap < capacity)
+            cap       <<= 1;
+
+        // Allocate ring buffer
+        uint8_t *ptr = NULL;
+        journal_record_t *records = lsp::alloc_aligned<journal_record_t>(ptr, cap, DEFAULT_ALIGN);
+        if (records == NULL)
+            return lsp::STATUS_NO_MEM;
+        lsp_finally { lsp::free_aligned(ptr); };
+
+        // Open the file and write header if the file is new
+        FILE *fd = fopen(path, "ab");
+        if (fd == NULL)
+        {
+            lsp_warn("Could not open journal file %s", path);
+            return lsp::STATUS_IO_ERROR;
+        }
+        lsp_finally {
+            if (fd != NULL)
+                fclose(fd);
+        };
+
+        if (ftell(fd) == 0)
+        {
+            journal_header_t hdr;
+            hdr.nMagic      = CPU_TO_LE(JOURNAL_MAGIC);
+            hdr.nVersion    = CPU_TO_LE(JOURNAL_VERSION);
+            hdr.nRecordSize = CPU_TO_LE(uint16_t(sizeof(journal_record_t)));
+
+            if ((fwrite(&hdr, sizeof(hdr), 1, fd) != 1) || (fflush(fd) != 0))
+                return lsp::STATUS_IO_ERROR;
+        }
+
+        // Start the writer thread
+        Writer *writer  = new Writer(this);
+        if (writer == NULL)
+            return lsp::STATUS_NO_MEM;
+
+        vRecords        = records;
+        nCapacity       = cap;
+        nHead           = 0;
+        nTail           = 0;
+        nLost           = 0;
+        bStop           = 0;
+        hFile           = fd;
+        pWriter         = writer;
+        lsp::swap(pData, ptr);
+
+        lsp::status_t res = writer->start();
+        if (res != lsp::STATUS_OK)
+        {
+            fd              = NULL;
+            close();
+            return res;
+        }
+
+        fd              = NULL;
+
+        return lsp::STATUS_OK;
+    }
+
+    lsp::status_t EventJournal::close()
+    {
+        lsp::status_t res = lsp::STATUS_OK;
+
+        // Stop the writer thread, it writes all pending records before finishing
+        if (pWriter != NULL)
+        {
+            lsp::atomic_store(&bStop, 1);
+            pWriter->join();
+
+            delete pWriter;
+            pWriter         = NULL;
+        }
+
+        // Close the file
+        if (hFile != NULL)
+        {
+            if (fclose(hFile) != 0)
+                res             = lsp::STATUS_IO_ERROR;
+            hFile           = NULL;
+        }
+
+        lsp::free_aligned(pData);
+        vRecords        = NULL;
+        nCapacity       = 0;
+        nHead           = 0;
+        nTail           = 0;
+        nLost           = 0;
+
+        return res;
+    }
+
+    size_t EventJournal::flush()
+    {
+        journal_record_t buf[FLUSH_BUFFER_SIZE];
+        size_t count    = 0;
+
+        // Report lost records first
+        const uint32_t lost = lsp::atomic_swap(&nLost, 0);
+        if (lost > 0)
+        {
+            journal_record_t *rec   = &buf[count++];
+            rec->nStart     = CPU_TO_LE(uint64_t(lost));
+            rec->nEnd       = 0;
+            rec->nPts       = CPU_TO_LE(JOURNAL_NO_PTS);
+            rec->fValue     = 0.0f;
+            rec->nChannel   = 0;
+            rec->nType      = CPU_TO_LE(uint16_t(JR_OVERFLOW));
+        }
+
+        // Fetch pending records from the ring buffer
+        const uint32_t head = lsp::atomic_load(&nHead);
+        uint32_t tail       = nTail;
+        const uint32_t mask = nCapacity - 1;
+        while ((tail != head) && (count < FLUSH_BUFFER_SIZE))
+            buf[count++]    = vRecords[(tail++) & mask];
+        lsp::atomic_store(&nTail, tail);
+
+        if (count <= 0)
+            return 0;
+
+        // Write records to the file
+        if (fwrite(buf, sizeof(journal_record_t), count, hFile) != count)
+            lsp_warn("Failed to write %d records to journal", int(count));
+        if (tail == head)
+            fflush(hFile);
+
+        return count;
+    }
+
+    bool EventJournal::enqueue(const journal_record_t *rec)
+    {
+        if (hFile == NULL)
+            return false;
+
+        // Check that there is free space in the ring buffer
+        const uint32_t head = nHead;
+        if ((head - lsp::atomic_load(&nTail)) >= nCapacity)
+        {
+            lsp::atomic_add(&nLost, 1);
+            return false;
+        }
+
+        // Commit the record
+        vRecords[head & (nCapacity - 1)]    = *rec;
+        lsp::atomic_store(&nHead, head + 1);
+
+        return true;
+    }
+
+    void EventJournal::sync(timestamp_t sample, int64_t pts, size_t sample_rate)
+    {
+        nSyncSample     = sample;
+        nSyncPts        = pts;
+        nSampleRate     = sample_rate;
+    }
+
+    bool EventJournal::submit_event(journal_record_type_t type, size_t channel, timestamp_t start, timestamp_t end, float value)
+    {
+        // Compute the presentation timestamp of the event start
+        int64_t pts     = JOURNAL_NO_PTS;
+        if ((nSyncPts != JOURNAL_NO_PTS) && (nSampleRate > 0))
+        {
+            const int64_t delta = int64_t(start - nSyncSample);
+            pts             = nSyncPts + (delta * 1000000000) / int64_t(nSampleRate);
+        }
+
+        journal_record_t rec;
+        rec.nStart      = CPU_TO_LE(uint64_t(start));
+        rec.nEnd        = CPU_TO_LE(uint64_t(end));
+        rec.nPts        = CPU_TO_LE(pts);
+        rec.fValue      = CPU_TO_LE(value);
+        rec.nChannel    = CPU_TO_LE(uint16_t(channel));
+        rec.nType       = CPU_TO_LE(uint16_t(type));
+
+        return enqueue(&rec);
+    }
+
+    bool EventJournal::submit_dropout(size_t channel, timestamp_t start, timestamp_t end, float depth)
+    {
+        return submit_event(JR_DROPOUT, channel, start, end, depth);
+    }
+
+    bool EventJournal::submit_click(size_t channel, timestamp_t time, float ratio)
+    {
+        return submit_event(JR_CLICK, channel, time, time, ratio);
+    }
+
+    bool EventJournal::submit_flatline(size_t channel, timestamp_t start, timestamp_t end, float level)
+    {
+        return submit_event(JR_FLATLINE, channel, start, end, level);
+    }
+
+    bool EventJournal::submit_gap(timestamp_t start, timestamp_t end)
+    {
+        return submit_event(JR_GAP, 0, start, end, 0.0f);
+    }
+
+    bool EventJournal::submit_imbalance(size_t channel, timestamp_t start, timestamp_t end, float level)
+    {
+        return submit_event(JR_IMBALANCE, channel, start, end, level);
+    }
+
+    bool EventJournal::submit_phase(size_t channel, timestamp_t start, timestamp_t end, float corr)
+    {
+        return submit_event(JR_PHASE, channel, start, end, corr);
+    }
+
+    bool EventJournal::submit_format(size_t sample_rate, size_t channels)
+    {
+        journal_record_t rec;
+        rec.nStart      = CPU_TO_LE(uint64_t(sample_rate));
+        rec.nEnd        = CPU_TO_LE(uint64_t(channels));
+        rec.nPts        = CPU_TO_LE(JOURNAL_NO_PTS);
+        rec.fValue      = 0.0f;
+        rec.nChannel    = 0;
+        rec.nType       = CPU_TO_LE(uint16_t(JR_FORMAT));
+
+        return enqueue(&rec);
+    }
+
+    size_t EventJournal::pending() const
+    {
+        return lsp::atomic_load(const_cast<uint32_t *>(&nHead)) - lsp::atomic_load(const_cast<uint32_t *>(&nTail));
+    }
+
+    lsp::status_t EventJournal::export_csv(FILE *out, FILE *in)
+    {
+        // Read and validate header
+        journal_header_t hdr;
+        if (fread(&hdr, sizeof(hdr), 1, in) != 1)
+            return lsp::STATUS_CORRUPTED;
+        if ((LE_TO_CPU(hdr.nMagic) != JOURNAL_MAGIC) ||
+            (LE_TO_CPU(hdr.nVersion) != JOURNAL_VERSION) ||
+            (LE_TO_CPU(hdr.nRecordSize) != sizeof(journal_record_t)))
+            return lsp::STATUS_BAD_FORMAT;
+
+        // Convert records
+        fprintf(out, "type,channel,start,end,pts,value\n");
+
+        journal_record_t rec;
+        while (fread(&rec, sizeof(rec), 1, in) == 1)
+        {
+            const uint16_t type     = LE_TO_CPU(rec.nType);
+            const int64_t pts       = LE_TO_CPU(rec.nPts);
+
+            fprintf(out, "%s,%u,%llu,%llu,",
+                record_type(type),
+                (unsigned int)(LE_TO_CPU(rec.nChannel)),
+                (unsigned long long)(LE_TO_CPU(rec.nStart)),
+                (unsigned long long)(LE_TO_CPU(rec.nEnd)));
+            if (pts != JOURNAL_NO_PTS)
+                fprintf(out, "%lld", (long long)(pts));
+            fprintf(out, ",%.2f\n", LE_TO_CPU(rec.fValue));
+        }
+
+        return (ferror(in)) ? lsp::STATUS_IO_ERROR : lsp::STATUS_OK;
+    }
+
+} /* namespace dd */
+
+
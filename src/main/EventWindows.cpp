@@ -0,0 +1,119 @@
+/*
+ * Copyright (C) 2024 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2024 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of damage-detector
+ * Created on: 18 окт. 2026 г.
+ *
+ * damage-detector is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * damage-detector is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with damage-detector. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <private/EventWindows.h>
+
+namespace dd
+{
+    static const float window_lengths[EV_WINDOW_TOTAL] =
+    {
+        1.0f,
+        10.0f,
+        60.0f,
+        600.0f
+    };
+
+    EventWindows::EventWindows()
+    {
+        init(44100);
+    }
+
+    float EventWindows::length(event_window_t window)
+    {
+        return window_lengths[window];
+    }
+
+    void EventWindows::init(size_t sample_rate)
+    {
+        for (size_t i=0; i<EV_WINDOW_TOTAL; ++i)
+        {
+            window_t *w     = &vWindows[i];
+            w->nLength      = lsp::lsp_max(uint32_t(window_lengths[i] * sample_rate / BUCKETS), uint32_t(1));
+        }
+
+        clear();
+    }
+
+    void EventWindows::set_sample_rate(size_t sample_rate, timestamp_t ts)
+    {
+        for (size_t i=0; i<EV_WINDOW_TOTAL; ++i)
+        {
+            window_t *w     = &vWindows[i];
+            w->nLength      = lsp::lsp_max(uint32_t(window_lengths[i] * sample_rate / BUCKETS), uint32_t(1));
+
+            // Rotate the ring to keep the age of buckets
+            const timestamp_t index = ts / w->nLength;
+            uint32_t count[BUCKETS];
+            for (size_t j=0; j<BUCKETS; ++j)
+                count[(index + BUCKETS - j) % BUCKETS]  = w->vCount[(w->nBucket + BUCKETS - j) % BUCKETS];
+            for (size_t j=0; j<BUCKETS; ++j)
+                w->vCount[j]    = count[j];
+            w->nBucket      = index;
+        }
+    }
+
+    void EventWindows::clear()
+    {
+        for (size_t i=0; i<EV_WINDOW_TOTAL; ++i)
+        {
+            window_t *w     = &vWindows[i];
+            w->nBucket      = 0;
+            w->nSum         = 0;
+            for (size_t j=0; j<BUCKETS; ++j)
+                w->vCount[j]    = 0;
+        }
+    }
+
+    void EventWindows::advance(timestamp_t ts)
+    {
+        for (size_t i=0; i<EV_WINDOW_TOTAL; ++i)
+        {
+            window_t *w             = &vWindows[i];
+            const timestamp_t index = ts / w->nLength;
+            if (index <= w->nBucket)
+                continue;
+
+            // Drop buckets that went out of the window, at most the whole ring
+            const size_t steps      = lsp::lsp_min(index - w->nBucket, timestamp_t(BUCKETS));
+            for (size_t j=1; j<=steps; ++j)
+            {
+                uint32_t *count         = &w->vCount[(w->nBucket + j) % BUCKETS];
+                w->nSum                -= *count;
+                *count                  = 0;
+            }
+
+            w->nBucket              = index;
+        }
+    }
+
+    void EventWindows::submit(timestamp_t ts, size_t count)
+    {
+        advance(ts);
+
+        for (size_t i=0; i<EV_WINDOW_TOTAL; ++i)
+        {
+            window_t *w             = &vWindows[i];
+            w->vCount[w->nBucket % BUCKETS]    += count;
+            w->nSum                += count;
+        }
+    }
+
+} /* namespace dd */
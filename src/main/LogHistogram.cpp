@@ -0,0 +1,50 @@
+/*
+ * Copyright (C) 2024 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2024 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of damage-detector
+ * Created on: 18 окт. 2026 г.
+ *
+ * damage-detector is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * damage-detector is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with damage-detector. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <private/LogHistogram.h>
+
+namespace dd
+{
+    void LogHistogram::clear()
+    {
+        for (size_t i=0; i<BUCKETS; ++i)
+            vCount[i]   = 0;
+    }
+
+    uint64_t LogHistogram::total() const
+    {
+        uint64_t res    = 0;
+        for (size_t i=0; i<BUCKETS; ++i)
+            res        += vCount[i];
+        return res;
+    }
+
+    uint64_t LogHistogram::lower_bound(size_t bucket)
+    {
+        if (bucket < SUB_BUCKETS)
+            return bucket;
+
+        const size_t shift  = bucket / SUB_BUCKETS - 1;
+        const size_t sub    = bucket % SUB_BUCKETS;
+        return uint64_t(SUB_BUCKETS + sub) << shift;
+    }
+
+} /* namespace dd */
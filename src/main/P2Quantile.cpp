@@ -0,0 +1,156 @@
+/*
+ * Copyright (C) 2024 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2024 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of damage-detector
+ * Created on: 18 окт. 2026 г.
+ *
+ * damage-detector is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * damage-detector is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with damage-detector. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <private/P2Quantile.h>
+
+namespace dd
+{
+    P2Quantile::P2Quantile()
+    {
+        init(0.5f, 0);
+    }
+
+    void P2Quantile::init(float quantile, size_t window)
+    {
+        fQuantile       = lsp::lsp_limit(quantile, 0.0f, 1.0f);
+        fWindow         = (window > 0) ? lsp::lsp_max(float(window), float(MARKERS * 2)) : 0.0f;
+        reset();
+    }
+
+    void P2Quantile::reset()
+    {
+        const float p   = fQuantile;
+
+        for (size_t i=0; i<MARKERS; ++i)
+        {
+            vHeight[i]      = 0.0f;
+            vPos[i]         = i + 1;
+        }
+
+        vDesired[0]     = 1.0f;
+        vDesired[1]     = 1.0f + 2.0f * p;
+        vDesired[2]     = 1.0f + 4.0f * p;
+        vDesired[3]     = 3.0f + 2.0f * p;
+        vDesired[4]     = 5.0f;
+
+        vStep[0]        = 0.0f;
+        vStep[1]        = p * 0.5f;
+        vStep[2]        = p;
+        vStep[3]        = (1.0f + p) * 0.5f;
+        vStep[4]        = 1.0f;
+
+        nCount          = 0;
+    }
+
+    float P2Quantile::parabolic(size_t i, float d) const
+    {
+        const float *q  = vHeight;
+        const float *n  = vPos;
+
+        return q[i] + d / (n[i+1] - n[i-1]) *
+            ((n[i] - n[i-1] + d) * (q[i+1] - q[i]) / (n[i+1] - n[i]) +
+             (n[i+1] - n[i] - d) * (q[i] - q[i-1]) / (n[i] - n[i-1]));
+    }
+
+    float P2Quantile::linear(size_t i, ssize_t d) const
+    {
+        return vHeight[i] + d * (vHeight[i+d] - vHeight[i]) / (vPos[i+d] - vPos[i]);
+    }
+
+    void P2Quantile::update(float x)
+    {
+        // Collect first observations as initial marker heights
+        if (nCount < MARKERS)
+        {
+            size_t i = nCount++;
+            for ( ; (i > 0) && (vHeight[i-1] > x); --i)
+                vHeight[i]      = vHeight[i-1];
+            vHeight[i]      = x;
+            return;
+        }
+
+        // Find the cell which contains the observation and adjust extreme markers
+        size_t k;
+        if (x < vHeight[0])
+        {
+            vHeight[0]      = x;
+            k               = 0;
+        }
+        else if (x >= vHeight[MARKERS-1])
+        {
+            vHeight[MARKERS-1]  = x;
+            k               = MARKERS - 2;
+        }
+        else
+        {
+            for (k = 0; k < MARKERS - 2; ++k)
+                if (x < vHeight[k+1])
+                    break;
+        }
+
+        // Update positions
+        for (size_t i=k+1; i<MARKERS; ++i)
+            vPos[i]        += 1.0f;
+        for (size_t i=0; i<MARKERS; ++i)
+            vDesired[i]    += vStep[i];
+
+        // Adjust heights of the middle markers
+        for (size_t i=1; i<MARKERS-1; ++i)
+        {
+            const float d   = vDesired[i] - vPos[i];
+            if (((d >= 1.0f) && ((vPos[i+1] - vPos[i]) > 1.0f)) ||
+                ((d <= -1.0f) && ((vPos[i-1] - vPos[i]) < -1.0f)))
+            {
+                const ssize_t sd    = (d >= 0.0f) ? 1 : -1;
+                const float q       = parabolic(i, sd);
+                vHeight[i]          = ((vHeight[i-1] < q) && (q < vHeight[i+1])) ? q : linear(i, sd);
+                vPos[i]            += sd;
+            }
+        }
+
+        // Rescale positions to forget old observations
+        if ((fWindow > 0.0f) && (vPos[MARKERS-1] > fWindow))
+        {
+            const float k   = (fWindow - 1.0f) / (vPos[MARKERS-1] - 1.0f);
+            for (size_t i=0; i<MARKERS; ++i)
+            {
+                vPos[i]         = 1.0f + (vPos[i] - 1.0f) * k;
+                vDesired[i]     = 1.0f + (vDesired[i] - 1.0f) * k;
+            }
+        }
+
+        if (nCount < 0xffffffff)
+            ++nCount;
+    }
+
+    float P2Quantile::value() const
+    {
+        if (nCount <= 0)
+            return 0.0f;
+        if (nCount >= MARKERS)
+            return vHeight[2];
+
+        // Not enough observations, use sorted observations directly
+        const size_t i  = lsp::lsp_min(size_t(fQuantile * nCount), size_t(nCount - 1));
+        return vHeight[i];
+    }
+
+} /* namespace dd */
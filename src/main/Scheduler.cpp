@@ -0,0 +1,318 @@
+/*
+ * Copyright (C) 2024 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2024 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of damage-detector
+ * Created on: 18 окт. 2026 г.
+ *
+ * damage-detector is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * damage-detector is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with damage-detector. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <private/Scheduler.h>
+
+#include <lsp-plug.in/common/atomic.h>
+#include <lsp-plug.in/common/finally.h>
+
+namespace dd
+{
+    //-------------------------------------------------------------------------
+    Task::Task()
+    {
+        nState      = S_IDLE;
+    }
+
+    Task::~Task()
+    {
+    }
+
+    bool Task::idle()
+    {
+        return lsp::atomic_load(&nState) == S_IDLE;
+    }
+
+    //-------------------------------------------------------------------------
+    Scheduler::Worker::Worker(Scheduler *scheduler, size_t index)
+    {
+        pScheduler  = scheduler;
+        nIndex      = index;
+    }
+
+    Scheduler::Worker::~Worker()
+    {
+    }
+
+    lsp::status_t Scheduler::Worker::run()
+    {
+        Scheduler *s = pScheduler;
+
+        while (!lsp::atomic_load(&s->bStop))
+        {
+            Task *task  = s->pop(nIndex);
+            if (task == NULL)
+                task        = s->steal(nIndex);
+
+            if (task != NULL)
+                s->execute(nIndex, task);
+            else
+                lsp::ipc::Thread::sleep(IDLE_PERIOD);
+        }
+
+        return lsp::STATUS_OK;
+    }
+
+    //-------------------------------------------------------------------------
+    Scheduler::Scheduler()
+    {
+        vQueues     = NULL;
+        nQueues     = 0;
+        nCapacity   = 0;
+        nNext       = 0;
+        bStop       = 0;
+    }
+
+    Scheduler::~Scheduler()
+    {
+        stop();
+    }
+
+    void Scheduler::destroy()
+    {
+        if (vQueues == NULL)
+            return;
+
+        for (size_t i=0; i<nQueues; ++i)
+        {
+            queue_t *q  = &vQueues[i];
+            if (q->pWorker != NULL)
+            {
+                delete q->pWorker;
+                q->pWorker  = NULL;
+            }
+            if (q->vTasks != NULL)
+            {
+                delete [] q->vTasks;
+                q->vTasks   = NULL;
+            }
+        }
+
+        delete [] vQueues;
+        vQueues     = NULL;
+        nQueues     = 0;
+        nCapacity   = 0;
+    }
+
+    lsp::status_t Scheduler::start(size_t workers, size_t tasks)
+    {
+        if (vQueues != NULL)
+            return lsp::STATUS_BAD_STATE;
+        if (tasks <= 0)
+            return lsp::STATUS_BAD_ARGUMENTS;
+        if (workers <= 0)
+            workers     = lsp::ipc::Thread::system_cores();
+
+        // Allocate queues, each queue is able to hold all tasks
+        vQueues     = new queue_t[workers];
+        nQueues     = workers;
+        nCapacity   = tasks;
+        nNext       = 0;
+        bStop       = 0;
+
+        for (size_t i=0; i<workers; ++i)
+        {
+            queue_t *q      = &vQueues[i];
+            q->vTasks       = new Task *[tasks];
+            q->nHead        = 0;
+            q->nCount       = 0;
+            q->nPeak        = 0;
+            q->nExecuted    = 0;
+            q->nStolen      = 0;
+            q->pWorker      = NULL;
+        }
+
+        // Start workers
+        for (size_t i=0; i<workers; ++i)
+        {
+            queue_t *q      = &vQueues[i];
+            q->pWorker      = new Worker(this, i);
+
+            lsp::status_t res = q->pWorker->start();
+            if (res != lsp::STATUS_OK)
+            {
+                stop();
+                return res;
+            }
+        }
+
+        return lsp::STATUS_OK;
+    }
+
+    lsp::status_t Scheduler::stop()
+    {
+        if (vQueues == NULL)
+            return lsp::STATUS_OK;
+
+        // Stop workers
+        lsp::atomic_store(&bStop, 1);
+        for (size_t i=0; i<nQueues; ++i)
+        {
+            queue_t *q  = &vQueues[i];
+            if (q->pWorker != NULL)
+                q->pWorker->join();
+        }
+
+        // Release all queued tasks so they can be submitted again
+        for (size_t i=0; i<nQueues; ++i)
+        {
+            Task *task;
+            while ((task = pop(i)) != NULL)
+                lsp::atomic_store(&task->nState, Task::S_IDLE);
+        }
+
+        destroy();
+
+        return lsp::STATUS_OK;
+    }
+
+    bool Scheduler::push(size_t queue, Task *task)
+    {
+        queue_t *q  = &vQueues[queue];
+        q->sLock.lock();
+        lsp_finally { q->sLock.unlock(); };
+
+        if (q->nCount >= nCapacity)
+            return false;
+
+        q->vTasks[(q->nHead + q->nCount) % nCapacity] = task;
+        ++q->nCount;
+        q->nPeak    = lsp::lsp_max(q->nPeak, q->nCount);
+
+        return true;
+    }
+
+    Task *Scheduler::pop(size_t queue)
+    {
+        queue_t *q  = &vQueues[queue];
+        q->sLock.lock();
+        lsp_finally { q->sLock.unlock(); };
+
+        if (q->nCount <= 0)
+            return NULL;
+
+        // The owner takes tasks in the order of submission from the front
+        Task *task  = q->vTasks[q->nHead];
+        q->nHead    = (q->nHead + 1) % nCapacity;
+        --q->nCount;
+        ++q->nExecuted;
+
+        return task;
+    }
+
+    Task *Scheduler::steal(size_t queue)
+    {
+        // Thieves take the most recently queued task from the back of the victim's queue
+        for (size_t i=1; i<nQueues; ++i)
+        {
+            queue_t *q  = &vQueues[(queue + i) % nQueues];
+            if (lsp::atomic_load(&q->nCount) <= 0)
+                continue;
+
+            q->sLock.lock();
+            lsp_finally { q->sLock.unlock(); };
+
+            if (q->nCount <= 0)
+                continue;
+
+            --q->nCount;
+            ++q->nExecuted;
+            ++q->nStolen;
+
+            return q->vTasks[(q->nHead + q->nCount) % nCapacity];
+        }
+
+        return NULL;
+    }
+
+    bool Scheduler::enqueue(size_t queue, Task *task)
+    {
+        for (size_t i=0; i<nQueues; ++i)
+        {
+            if (push((queue + i) % nQueues, task))
+                return true;
+        }
+
+        lsp::atomic_store(&task->nState, Task::S_IDLE);
+        return false;
+    }
+
+    void Scheduler::execute(size_t queue, Task *task)
+    {
+        lsp::atomic_store(&task->nState, Task::S_RUNNING);
+        const bool more = task->run();
+
+        // Requeue the task to the own queue if it has more work or has been submitted while running
+        if (!more)
+        {
+            if (lsp::atomic_cas(&task->nState, Task::S_RUNNING, Task::S_IDLE))
+                return;
+        }
+
+        lsp::atomic_store(&task->nState, Task::S_QUEUED);
+        enqueue(queue, task);
+    }
+
+    bool Scheduler::submit(Task *task)
+    {
+        if (vQueues == NULL)
+            return false;
+
+        while (true)
+        {
+            const uint32_t state = lsp::atomic_load(&task->nState);
+            switch (state)
+            {
+                case Task::S_IDLE:
+                    if (lsp::atomic_cas(&task->nState, Task::S_IDLE, Task::S_QUEUED))
+                        return enqueue(lsp::atomic_add(&nNext, 1) % nQueues, task);
+                    break;
+                case Task::S_RUNNING:
+                    if (lsp::atomic_cas(&task->nState, Task::S_RUNNING, Task::S_RESUBMIT))
+                        return true;
+                    break;
+                default:
+                    return true;
+            }
+        }
+    }
+
+    void Scheduler::get_stats(scheduler_stats_t *stats)
+    {
+        stats->nExecuted    = 0;
+        stats->nStolen      = 0;
+        stats->nQueued      = 0;
+        stats->nPeakQueued  = 0;
+
+        for (size_t i=0; i<nQueues; ++i)
+        {
+            queue_t *q  = &vQueues[i];
+            q->sLock.lock();
+            lsp_finally { q->sLock.unlock(); };
+
+            stats->nExecuted   += q->nExecuted;
+            stats->nStolen     += q->nStolen;
+            stats->nQueued     += q->nCount;
+            stats->nPeakQueued  = lsp::lsp_max(stats->nPeakQueued, q->nPeak);
+        }
+    }
+
+} /* namespace dd */
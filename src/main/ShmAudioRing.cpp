@@ -0,0 +1,312 @@
+/*
+ * Copyright (C) 2024 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2024 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of damage-detector
+ * Created on: 18 окт. 2026 г.
+ *
+ * damage-detector is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * damage-detector is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with damage-detector. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <private/ShmAudioRing.h>
+
+#include <lsp-plug.in/common/atomic.h>
+#include <lsp-plug.in/common/debug.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef PLATFORM_UNIX_COMPATIBLE
+    #include <errno.h>
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif /* PLATFORM_UNIX_COMPATIBLE */
+
+namespace dd
+{
+    ShmAudioRing::ShmAudioRing()
+    {
+        pHeader         = NULL;
+        vData           = NULL;
+        nMapSize        = 0;
+        sName           = NULL;
+        bOwner          = false;
+    }
+
+    ShmAudioRing::~ShmAudioRing()
+    {
+        close();
+    }
+
+#ifdef PLATFORM_UNIX_COMPATIBLE
+    lsp::status_t ShmAudioRing::create(const char *name, size_t channels, size_t sample_rate, size_t capacity)
+    {
+        if (pHeader != NULL)
+            return lsp::STATUS_OPENED;
+        if ((name == NULL) || (channels <= 0) || (channels > 0xffff) || (sample_rate <= 0) || (capacity <= 0))
+            return lsp::STATUS_BAD_ARGUMENTS;
+
+        size_t cap = 1;
+        while (cap < capacity)
+            cap       <<= 1;
+
+        char *xname     = strdup(name);
+        if (xname == NULL)
+            return lsp::STATUS_NO_MEM;
+
+        // Replace the stale object if it exists
+        shm_unlink(name);
+        int fd          = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+        if (fd < 0)
+        {
+            lsp_warn("Could not create shared memory %s, errno=%d", name, int(errno));
+            free(xname);
+            return lsp::STATUS_IO_ERROR;
+        }
+
+        const size_t map_size   = sizeof(shm_ring_header_t) + cap * channels * sizeof(float);
+        if (ftruncate(fd, map_size) != 0)
+        {
+            ::close(fd);
+            shm_unlink(name);
+            free(xname);
+            return lsp::STATUS_NO_MEM;
+        }
+
+        void *addr      = mmap(NULL, map_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (addr == MAP_FAILED)
+        {
+            shm_unlink(name);
+            free(xname);
+            return lsp::STATUS_NO_MEM;
+        }
+
+        // Initialize header, the magic is written last to publish the ring
+        shm_ring_header_t *hdr  = static_cast<shm_ring_header_t *>(addr);
+        memset(hdr, 0, sizeof(shm_ring_header_t));
+        hdr->nVersion       = SHM_RING_VERSION;
+        hdr->nChannels      = uint16_t(channels);
+        hdr->nSampleRate    = uint32_t(sample_rate);
+        hdr->nCapacity      = uint32_t(cap);
+        lsp::atomic_store(&hdr->nMagic, SHM_RING_MAGIC);
+
+        pHeader         = hdr;
+        vData           = reinterpret_cast<float *>(&hdr[1]);
+        nMapSize        = map_size;
+        sName           = xname;
+        bOwner          = true;
+
+        return lsp::STATUS_OK;
+    }
+
+    lsp::status_t ShmAudioRing::open(const char *name)
+    {
+        if (pHeader != NULL)
+            return lsp::STATUS_OPENED;
+        if (name == NULL)
+            return lsp::STATUS_BAD_ARGUMENTS;
+
+        int fd          = shm_open(name, O_RDWR, 0);
+        if (fd < 0)
+            return (errno == ENOENT) ? lsp::STATUS_NOT_FOUND : lsp::STATUS_IO_ERROR;
+
+        // Validate the size of the object
+        struct stat st;
+        if ((fstat(fd, &st) != 0) || (size_t(st.st_size) < sizeof(shm_ring_header_t)))
+        {
+            ::close(fd);
+            return lsp::STATUS_NOT_FOUND;
+        }
+
+        const size_t map_size   = st.st_size;
+        void *addr      = mmap(NULL, map_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (addr == MAP_FAILED)
+            return lsp::STATUS_IO_ERROR;
+
+        // Validate the header
+        shm_ring_header_t *hdr  = static_cast<shm_ring_header_t *>(addr);
+        const size_t cap        = hdr->nCapacity;
+        if ((lsp::atomic_load(&hdr->nMagic) != SHM_RING_MAGIC) ||
+            (hdr->nVersion != SHM_RING_VERSION) ||
+            (hdr->nChannels <= 0) ||
+            (cap <= 0) || ((cap & (cap - 1)) != 0) ||
+            (map_size < sizeof(shm_ring_header_t) + cap * hdr->nChannels * sizeof(float)))
+        {
+            munmap(addr, map_size);
+            return lsp::STATUS_BAD_FORMAT;
+        }
+
+        char *xname     = strdup(name);
+        if (xname == NULL)
+        {
+            munmap(addr, map_size);
+            return lsp::STATUS_NO_MEM;
+        }
+
+        pHeader         = hdr;
+        vData           = reinterpret_cast<float *>(&hdr[1]);
+        nMapSize        = map_size;
+        sName           = xname;
+        bOwner          = false;
+
+        return lsp::STATUS_OK;
+    }
+
+    void ShmAudioRing::close()
+    {
+        if (pHeader != NULL)
+        {
+            munmap(pHeader, nMapSize);
+            pHeader         = NULL;
+        }
+        if (sName != NULL)
+        {
+            if (bOwner)
+                shm_unlink(sName);
+            free(sName);
+            sName           = NULL;
+        }
+
+        vData           = NULL;
+        nMapSize        = 0;
+        bOwner          = false;
+    }
+#else
+    lsp::status_t ShmAudioRing::create(const char *name, size_t channels, size_t sample_rate, size_t capacity)
+    {
+        return lsp::STATUS_NOT_SUPPORTED;
+    }
+
+    lsp::status_t ShmAudioRing::open(const char *name)
+    {
+        return lsp::STATUS_NOT_SUPPORTED;
+    }
+
+    void ShmAudioRing::close()
+    {
+    }
+#endif /* PLATFORM_UNIX_COMPATIBLE */
+
+    size_t ShmAudioRing::channels() const
+    {
+        return (pHeader != NULL) ? pHeader->nChannels : 0;
+    }
+
+    size_t ShmAudioRing::sample_rate() const
+    {
+        return (pHeader != NULL) ? pHeader->nSampleRate : 0;
+    }
+
+    size_t ShmAudioRing::capacity() const
+    {
+        return (pHeader != NULL) ? pHeader->nCapacity : 0;
+    }
+
+    size_t ShmAudioRing::space() const
+    {
+        if (pHeader == NULL)
+            return 0;
+
+        const uint64_t written  = pHeader->nWritten;
+        const uint64_t read     = lsp::atomic_load(&pHeader->nRead);
+        return pHeader->nCapacity - size_t(written - read);
+    }
+
+    size_t ShmAudioRing::write(const float *frames, size_t count)
+    {
+        if (pHeader == NULL)
+            return 0;
+
+        const size_t channels   = pHeader->nChannels;
+        const size_t cap        = pHeader->nCapacity;
+        const uint64_t written  = pHeader->nWritten;
+        count                   = lsp::lsp_min(count, space());
+
+        // Copy data with respect to the wrap of the ring buffer
+        for (size_t done = 0; done < count; )
+        {
+            const size_t pos        = size_t((written + done) & (cap - 1));
+            const size_t to_do      = lsp::lsp_min(count - done, cap - pos);
+            memcpy(&vData[pos * channels], &frames[done * channels], to_do * channels * sizeof(float));
+            done                   += to_do;
+        }
+
+        // Publish data
+        lsp::atomic_store(&pHeader->nWritten, written + count);
+
+        return count;
+    }
+
+    void ShmAudioRing::set_eos()
+    {
+        if (pHeader == NULL)
+            return;
+
+        uint32_t flags;
+        do
+        {
+            flags = lsp::atomic_load(&pHeader->nFlags);
+        } while (!lsp::atomic_cas(&pHeader->nFlags, flags, flags | SHM_RING_EOS));
+    }
+
+    size_t ShmAudioRing::available() const
+    {
+        if (pHeader == NULL)
+            return 0;
+
+        const uint64_t written  = lsp::atomic_load(&pHeader->nWritten);
+        const uint64_t read     = pHeader->nRead;
+        return size_t(written - read);
+    }
+
+    const float *ShmAudioRing::read_segment(size_t *count) const
+    {
+        const size_t avail      = available();
+        if (avail <= 0)
+        {
+            *count                  = 0;
+            return NULL;
+        }
+
+        const size_t cap        = pHeader->nCapacity;
+        const size_t pos        = size_t(pHeader->nRead & (cap - 1));
+        *count                  = lsp::lsp_min(avail, cap - pos);
+
+        return &vData[pos * pHeader->nChannels];
+    }
+
+    void ShmAudioRing::commit_read(size_t count)
+    {
+        if (pHeader == NULL)
+            return;
+
+        count                   = lsp::lsp_min(count, available());
+        lsp::atomic_store(&pHeader->nRead, pHeader->nRead + count);
+    }
+
+    bool ShmAudioRing::eos() const
+    {
+        if (pHeader == NULL)
+            return true;
+
+        return lsp::atomic_load(&pHeader->nFlags) & SHM_RING_EOS;
+    }
+
+} /* namespace dd */
+
+
@@ -0,0 +1,180 @@
+/*
+ * Copyright (C) 2024 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2024 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of damage-detector
+ * Created on: 18 окт. 2026 г.
+ *
+ * damage-detector is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * damage-detector is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with damage-detector. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <private/StatusPage.h>
+#include <private/DamageDetector.h>
+
+#include <lsp-plug.in/common/atomic.h>
+#include <lsp-plug.in/common/debug.h>
+
+#include <atomic>
+#include <string.h>
+
+#ifdef PLATFORM_UNIX_COMPATIBLE
+    #include <errno.h>
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <unistd.h>
+#endif /* PLATFORM_UNIX_COMPATIBLE */
+
+namespace dd
+{
+    StatusPage::StatusPage()
+    {
+        pPage           = NULL;
+        nSyncSample     = 0;
+        nSyncPts        = STATUS_NO_PTS;
+    }
+
+    StatusPage::~StatusPage()
+    {
+        close();
+    }
+
+#ifdef PLATFORM_UNIX_COMPATIBLE
+    lsp::status_t StatusPage::open(const char *path)
+    {
+        if (pPage != NULL)
+            return lsp::STATUS_OPENED;
+        if (path == NULL)
+            return lsp::STATUS_BAD_ARGUMENTS;
+
+        int fd          = ::open(path, O_RDWR | O_CREAT, 0644);
+        if (fd < 0)
+        {
+            lsp_warn("Could not open status page %s, errno=%d", path, int(errno));
+            return lsp::STATUS_IO_ERROR;
+        }
+
+        if (ftruncate(fd, sizeof(status_page_t)) != 0)
+        {
+            ::close(fd);
+            return lsp::STATUS_IO_ERROR;
+        }
+
+        void *addr      = mmap(NULL, sizeof(status_page_t), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (addr == MAP_FAILED)
+            return lsp::STATUS_NO_MEM;
+
+        // Initialize the page, the magic is written last to publish it
+        status_page_t *page = static_cast<status_page_t *>(addr);
+        memset(page, 0, sizeof(status_page_t));
+        page->nVersion      = STATUS_PAGE_VERSION;
+        page->nLastEventPts = STATUS_NO_PTS;
+        lsp::atomic_store(&page->nMagic, STATUS_PAGE_MAGIC);
+
+        pPage           = page;
+        nSyncSample     = 0;
+        nSyncPts        = STATUS_NO_PTS;
+
+        return lsp::STATUS_OK;
+    }
+
+    void StatusPage::close()
+    {
+        if (pPage == NULL)
+            return;
+
+        munmap(pPage, sizeof(status_page_t));
+        pPage           = NULL;
+    }
+#else
+    lsp::status_t StatusPage::open(const char *path)
+    {
+        return lsp::STATUS_NOT_SUPPORTED;
+    }
+
+    void StatusPage::close()
+    {
+        pPage           = NULL;
+    }
+#endif /* PLATFORM_UNIX_COMPATIBLE */
+
+    void StatusPage::sync(timestamp_t sample, int64_t pts)
+    {
+        nSyncSample     = sample;
+        nSyncPts        = pts;
+    }
+
+    void StatusPage::publish(const DamageDetector *detector)
+    {
+        status_page_t *page     = pPage;
+        if (page == NULL)
+            return;
+
+        const size_t sample_rate    = detector->sample_rate();
+        const size_t channels       = lsp::lsp_min(detector->channels(), STATUS_MAX_CHANNELS);
+        const uint64_t total        = detector->total_events();
+        const timestamp_t last      = detector->last_event();
+
+        int64_t pts                 = STATUS_NO_PTS;
+        if ((total > 0) && (nSyncPts != STATUS_NO_PTS) && (sample_rate > 0))
+            pts                         = nSyncPts + (int64_t(last - nSyncSample) * 1000000000) / int64_t(sample_rate);
+
+        // Mark the page as being updated, there is the only writer
+        const uint32_t seq          = page->nSequence;
+        lsp::atomic_store(&page->nSequence, seq + 1);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        page->nChannels             = uint16_t(channels);
+        page->nSampleRate           = uint32_t(sample_rate);
+        page->nSamples              = detector->timestamp();
+        page->nLastEventPts         = pts;
+        page->nLastEvent            = last;
+        page->nTotalEvents          = total;
+        page->nEvents               = uint32_t(detector->events_count());
+        page->nFlags                =
+            ((detector->corrupted()) ? STATUS_CORRUPTED : 0) |
+            ((total > 0) ? STATUS_EVENTS : 0);
+        for (size_t i=0; i<EV_WINDOW_TOTAL; ++i)
+            page->vWindowEvents[i]      = uint32_t(detector->window_events(event_window_t(i)));
+
+        for (size_t i=0; i<channels; ++i)
+        {
+            status_channel_t *c         = &page->vChannels[i];
+            c->nState                   = uint32_t(detector->trigger_state(i));
+            c->nEvents                  = uint32_t(detector->events_count(i));
+            c->fThreshold               = detector->channel_threshold(i);
+            c->nFlags                   = (detector->flatline_active(i)) ? STATUS_CH_FLATLINE : 0;
+        }
+
+        // Complete the update
+        std::atomic_thread_fence(std::memory_order_release);
+        lsp::atomic_store(&page->nSequence, seq + 2);
+    }
+
+    bool StatusPage::read(status_page_t *dst, const status_page_t *page)
+    {
+        status_page_t *src      = const_cast<status_page_t *>(page);
+
+        const uint32_t seq      = lsp::atomic_load(&src->nSequence);
+        if (seq & 1)
+            return false;
+        std::atomic_thread_fence(std::memory_order_acquire);
+
+        memcpy(dst, page, sizeof(status_page_t));
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return lsp::atomic_load(&src->nSequence) == seq;
+    }
+
+} /* namespace dd */
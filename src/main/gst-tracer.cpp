@@ -0,0 +1,121 @@
+/*
+ * Copyright (C) 2024 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2024 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of damage-detector
+ * Created on: 18 окт. 2026 г.
+ *
+ * damage-detector is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * damage-detector is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with damage-detector. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <private/gst-tracer.h>
+
+struct _GstDamageDetectorTracer
+{
+    GstTracer parent;
+};
+
+uint32_t gst_damage_detector_tracers = 0;
+
+static GstTracerRecord *damage_detector_record = NULL;
+
+#define gst_damage_detector_tracer_parent_class tracer_parent_class
+
+G_DEFINE_TYPE( // @suppress("Unused static function")
+    GstDamageDetectorTracer,
+    gst_damage_detector_tracer,
+    GST_TYPE_TRACER);
+
+static void gst_damage_detector_tracer_finalize(GObject *object)
+{
+    lsp::atomic_add(&gst_damage_detector_tracers, -1);
+
+    G_OBJECT_CLASS(tracer_parent_class)->finalize(object);
+}
+
+static void gst_damage_detector_tracer_class_init(GstDamageDetectorTracerClass *klass)
+{
+    GObjectClass *gobject_class = reinterpret_cast<GObjectClass *>(klass);
+    gobject_class->finalize = gst_damage_detector_tracer_finalize;
+
+    damage_detector_record = gst_tracer_record_new(
+        "damage-detector.class",
+        "element", GST_TYPE_STRUCTURE, gst_structure_new("scope",
+            "type", G_TYPE_GTYPE, G_TYPE_STRING,
+            "related-to", GST_TYPE_TRACER_VALUE_SCOPE, GST_TRACER_VALUE_SCOPE_ELEMENT,
+            NULL),
+        "proctime", GST_TYPE_STRUCTURE, gst_structure_new("value",
+            "type", G_TYPE_GTYPE, G_TYPE_UINT64,
+            "description", G_TYPE_STRING, "Processing time of the buffer in nanoseconds",
+            "min", G_TYPE_UINT64, G_GUINT64_CONSTANT(0),
+            "max", G_TYPE_UINT64, G_MAXUINT64,
+            NULL),
+        "samples", GST_TYPE_STRUCTURE, gst_structure_new("value",
+            "type", G_TYPE_GTYPE, G_TYPE_UINT64,
+            "description", G_TYPE_STRING, "Number of samples processed",
+            "min", G_TYPE_UINT64, G_GUINT64_CONSTANT(0),
+            "max", G_TYPE_UINT64, G_MAXUINT64,
+            NULL),
+        "events", GST_TYPE_STRUCTURE, gst_structure_new("value",
+            "type", G_TYPE_GTYPE, G_TYPE_UINT,
+            "description", G_TYPE_STRING, "Number of events detected in the buffer",
+            "min", G_TYPE_UINT, 0,
+            "max", G_TYPE_UINT, G_MAXUINT,
+            NULL),
+        "queue", GST_TYPE_STRUCTURE, gst_structure_new("value",
+            "type", G_TYPE_GTYPE, G_TYPE_UINT,
+            "description", G_TYPE_STRING, "Number of events in the event queues",
+            "min", G_TYPE_UINT, 0,
+            "max", G_TYPE_UINT, G_MAXUINT,
+            NULL),
+        "journal", GST_TYPE_STRUCTURE, gst_structure_new("value",
+            "type", G_TYPE_GTYPE, G_TYPE_UINT,
+            "description", G_TYPE_STRING, "Number of records pending in the event journal",
+            "min", G_TYPE_UINT, 0,
+            "max", G_TYPE_UINT, G_MAXUINT,
+            NULL),
+        NULL);
+    GST_OBJECT_FLAG_SET(damage_detector_record, GST_OBJECT_FLAG_MAY_BE_LEAKED);
+}
+
+static void gst_damage_detector_tracer_init(GstDamageDetectorTracer *self)
+{
+    lsp::atomic_add(&gst_damage_detector_tracers, 1);
+}
+
+void gst_damage_detector_trace(GstElement *element, const gst_damage_detector_trace_t *trace)
+{
+    if (damage_detector_record == NULL)
+        return;
+
+    gchar *name = gst_object_get_name(GST_OBJECT(element));
+    gst_tracer_record_log(
+        damage_detector_record,
+        name,
+        trace->proctime,
+        trace->samples,
+        trace->events,
+        trace->queue,
+        trace->journal);
+    g_free(name);
+}
+
+gboolean gst_damage_detector_tracer_register(GstPlugin *plugin)
+{
+#ifndef GST_DISABLE_GST_TRACER_HOOKS
+    return gst_tracer_register(plugin, "damagedetector", GST_TYPE_DAMAGE_DETECTOR_TRACER);
+#else
+    return TRUE;
+#endif /* GST_DISABLE_GST_TRACER_HOOKS */
+}
@@ -3,6 +3,7 @@
 #include <gst/audio/gstaudiofilter.h>
 #include <string.h>
 
+#include <lsp-plug.in/common/alloc.h>
 #include <lsp-plug.in/common/debug.h>
 #include <lsp-plug.in/common/finally.h>
 #include <lsp-plug.in/common/types.h>
@@ -10,8 +11,12 @@
 
 #include <private/version.h>
 #include <private/DamageDetector.h>
+#include <private/EventJournal.h>
+#include <private/StatusPage.h>
+#include <private/gst-tracer.h>
 
 static constexpr size_t IO_BUF_SIZE     = 0x400;
+static constexpr size_t IO_BUF_ALIGN    = 0x40;     // Alignment of buffers suitable for SIMD loads
 
 #define GST_TYPE_DAMAGE_DETECTOR (gst_damage_detector_get_type())
 G_DECLARE_FINAL_TYPE( // @suppress("Unused static function")
@@ -26,8 +31,41 @@ struct _GstDamageDetector
     GstAudioFilter audiofilter;
 
     dd::DamageDetector *processor;
-    float *left;
-    float *right;
+    dd::IEventListener *listener;
+    dd::EventJournal *journal;
+    gchar *journal_path;
+    dd::StatusPage *status;
+    gchar *status_path;
+    float *buffers;
+    uint8_t *buffers_data;
+    size_t channels;
+};
+
+static void gst_damage_detector_post_state(
+    GstDamageDetector *object,
+    dd::event_type_t ev,
+    size_t events,
+    dd::timestamp_t timestamp);
+
+/**
+ * Listener which posts the stream corruption state right from the processing routine
+ */
+class GstDamageDetectorListener: public dd::IEventListener
+{
+    private:
+        GstDamageDetector *pObject;
+
+    public:
+        explicit GstDamageDetectorListener(GstDamageDetector *object)
+        {
+            pObject     = object;
+        }
+
+    public:
+        virtual void on_event(const dd::notification_t *event) override
+        {
+            gst_damage_detector_post_state(pObject, event->enType, event->nEvents, event->nTimestamp);
+        }
 };
 
 
@@ -42,6 +80,23 @@ enum properties_t
     PROP_EVENTS,
     PROP_EVENTS_THRESHOLD,
     PROP_EVENTS_PERIOD,
+    PROP_JOURNAL,
+    PROP_CLICKS,
+    PROP_CLICK_RATIO,
+    PROP_FLAT_TIME,
+    PROP_GAP_EVENTS,
+    PROP_ADAPTIVE,
+    PROP_ADAPT_QUANTILE,
+    PROP_ADAPT_OFFSET,
+    PROP_ADAPT_TIME,
+    PROP_WINDOW_EVENTS,
+    PROP_STATUS,
+    PROP_HIST_PERIOD,
+    PROP_IMMEDIATE_EVENTS,
+    PROP_LINKED,
+    PROP_HYSTERESIS,
+    PROP_OPEN_DEBOUNCE,
+    PROP_CLOSE_DEBOUNCE,
 };
 
 #define gst_damage_detector_parent_class parent_class
@@ -77,6 +132,21 @@ static gboolean gst_damage_detector_setup(
     GstAudioFilter *object,
     const GstAudioInfo *info);
 
+static gboolean gst_damage_detector_start(
+    GstBaseTransform *object);
+
+static gboolean gst_damage_detector_stop(
+    GstBaseTransform *object);
+
+static gboolean gst_damage_detector_propose_allocation(
+    GstBaseTransform *object,
+    GstQuery *decide_query,
+    GstQuery *query);
+
+static gboolean gst_damage_detector_decide_allocation(
+    GstBaseTransform *object,
+    GstQuery *query);
+
 static GstFlowReturn gst_damage_detector_filter(
     GstBaseTransform *object,
     GstBuffer *outbuf,
@@ -86,7 +156,8 @@ static GstFlowReturn gst_damage_detector_filter_inplace(
     GstBaseTransform *object,
     GstBuffer * buf);
 
-// We only support 32-bit IEEE 754 floating point
+// We only support 32-bit IEEE 754 floating point, planes of non-interleaved
+// buffers are passed to the processor directly
 static GstStaticPadTemplate sink_factory = GST_STATIC_PAD_TEMPLATE (
     "sink",
     GST_PAD_SINK,
@@ -94,7 +165,8 @@ static GstStaticPadTemplate sink_factory = GST_STATIC_PAD_TEMPLATE (
     GST_STATIC_CAPS(
         "audio/x-raw, "
         "format = (string) " GST_AUDIO_NE(F32) ", "
-        "channels = (int) 2, "
+        "layout = (string) { interleaved, non-interleaved }, "
+        "channels = (int) [ 1, max ], "
         "rate = (int) [ 1, max ]"
     )
 );
@@ -106,7 +178,8 @@ static GstStaticPadTemplate source_factory = GST_STATIC_PAD_TEMPLATE (
     GST_STATIC_CAPS(
         "audio/x-raw, "
         "format = (string) " GST_AUDIO_NE(F32) ", "
-        "channels = (int) 2, "
+        "layout = (string) { interleaved, non-interleaved }, "
+        "channels = (int) [ 1, max ], "
         "rate = (int) [ 1, max ]"
     )
 );
@@ -128,11 +201,19 @@ static void gst_damage_detector_class_init(GstDamageDetectorClass * klass)
     // first buffer comes in, and whenever the format changes
     audio_filter_class->setup = gst_damage_detector_setup;
 
+    // these functions are called when the element starts and stops processing
+    btrans_class->start = gst_damage_detector_start;
+    btrans_class->stop = gst_damage_detector_stop;
+
     // here you set up functions to process data (either in place, or from
     // one input buffer to another output buffer); only one is required
     btrans_class->transform = gst_damage_detector_filter;
     btrans_class->transform_ip = gst_damage_detector_filter_inplace;
 
+    // request buffers aligned for SIMD processing from upstream and downstream
+    btrans_class->propose_allocation = gst_damage_detector_propose_allocation;
+    btrans_class->decide_allocation = gst_damage_detector_decide_allocation;
+
     // Set some basic metadata about your new element
     gst_element_class_set_details_simple(
       element_class,
@@ -185,6 +266,13 @@ static void gst_damage_detector_class_init(GstDamageDetectorClass * klass)
             0, dd::DamageDetector::MAX_EVENTS * 2, 0,
             G_PARAM_READABLE));
 
+    g_object_class_install_property(
+        gobject_class, PROP_WINDOW_EVENTS,
+        g_param_spec_boxed(
+            "window_events", "Window events", "The number of detected events for the last 1 s, 10 s, 1 min and 10 min",
+            GST_TYPE_STRUCTURE,
+            G_PARAM_READABLE));
+
     g_object_class_install_property(
         gobject_class, PROP_EVENTS_THRESHOLD,
         g_param_spec_uint(
@@ -198,14 +286,135 @@ static void gst_damage_detector_class_init(GstDamageDetectorClass * klass)
             "ev_period", "Events period", "Notification send period [s]",
             dd::DamageDetector::MIN_EV_PERIOD, dd::DamageDetector::MAX_EV_PERIOD, dd::DamageDetector::DFL_EV_PERIOD,
             G_PARAM_READWRITE));
+
+    g_object_class_install_property(
+        gobject_class, PROP_JOURNAL,
+        g_param_spec_string(
+            "journal", "Journal", "Path to the binary event journal file, applied when the element starts",
+            NULL,
+            G_PARAM_READWRITE));
+
+    g_object_class_install_property(
+        gobject_class, PROP_STATUS,
+        g_param_spec_string(
+            "status", "Status", "Path to the memory-mapped status page file, applied when the element starts",
+            NULL,
+            G_PARAM_READWRITE));
+
+    g_object_class_install_property(
+        gobject_class, PROP_CLICKS,
+        g_param_spec_boolean(
+            "clicks", "Clicks", "Enable detection of clicks and discontinuities",
+            FALSE,
+            G_PARAM_READWRITE));
+
+    g_object_class_install_property(
+        gobject_class, PROP_CLICK_RATIO,
+        g_param_spec_float(
+            "click_ratio", "Click ratio", "Ratio of the signal difference peak to its average level considered to be a click [dB]",
+            dd::DamageDetector::MIN_CLICK_RATIO, dd::DamageDetector::MAX_CLICK_RATIO, dd::DamageDetector::DFL_CLICK_RATIO,
+            G_PARAM_READWRITE));
+
+    g_object_class_install_property(
+        gobject_class, PROP_FLAT_TIME,
+        g_param_spec_float(
+            "flat_time", "Flatline time", "Time of the constant signal (digital silence or DC) that is reported as flatline [s]",
+            dd::DamageDetector::MIN_FLAT_TIME, dd::DamageDetector::MAX_FLAT_TIME, dd::DamageDetector::DFL_FLAT_TIME,
+            G_PARAM_READWRITE));
+
+    g_object_class_install_property(
+        gobject_class, PROP_GAP_EVENTS,
+        g_param_spec_boolean(
+            "gap_events", "Gap events", "Count gaps in the stream (buffers marked as GAP) as corruption events",
+            FALSE,
+            G_PARAM_READWRITE));
+
+    g_object_class_install_property(
+        gobject_class, PROP_ADAPTIVE,
+        g_param_spec_boolean(
+            "adaptive", "Adaptive threshold", "Place the trigger threshold relative to the estimated noise floor of each channel",
+            FALSE,
+            G_PARAM_READWRITE));
+
+    g_object_class_install_property(
+        gobject_class, PROP_ADAPT_QUANTILE,
+        g_param_spec_float(
+            "adapt_quantile", "Adaptive quantile", "Quantile of the RMS level considered to be the noise floor [%]",
+            dd::DamageDetector::MIN_ADAPT_QUANTILE, dd::DamageDetector::MAX_ADAPT_QUANTILE, dd::DamageDetector::DFL_ADAPT_QUANTILE,
+            G_PARAM_READWRITE));
+
+    g_object_class_install_property(
+        gobject_class, PROP_ADAPT_OFFSET,
+        g_param_spec_float(
+            "adapt_offset", "Adaptive offset", "Offset of the adaptive threshold relative to the noise floor [dB]",
+            dd::DamageDetector::MIN_ADAPT_OFFSET, dd::DamageDetector::MAX_ADAPT_OFFSET, dd::DamageDetector::DFL_ADAPT_OFFSET,
+            G_PARAM_READWRITE));
+
+    g_object_class_install_property(
+        gobject_class, PROP_ADAPT_TIME,
+        g_param_spec_float(
+            "adapt_time", "Adaptive time", "Time window of the noise floor estimation [s]",
+            dd::DamageDetector::MIN_ADAPT_TIME, dd::DamageDetector::MAX_ADAPT_TIME, dd::DamageDetector::DFL_ADAPT_TIME,
+            G_PARAM_READWRITE));
+
+    g_object_class_install_property(
+        gobject_class, PROP_HIST_PERIOD,
+        g_param_spec_float(
+            "hist_period", "Histogram period", "Period of the timing histograms export, 0 disables export [s]",
+            dd::DamageDetector::MIN_HIST_PERIOD, dd::DamageDetector::MAX_HIST_PERIOD, dd::DamageDetector::DFL_HIST_PERIOD,
+            G_PARAM_READWRITE));
+
+    g_object_class_install_property(
+        gobject_class, PROP_IMMEDIATE_EVENTS,
+        g_param_spec_boolean(
+            "immediate_events", "Immediate events", "Post the corruption state at the sample which has crossed the event threshold",
+            FALSE,
+            G_PARAM_READWRITE));
+
+    g_object_class_install_property(
+        gobject_class, PROP_LINKED,
+        g_param_spec_boolean(
+            "linked", "Linked channels", "Analyze adjacent channels as pairs using the mid envelope and the correlation",
+            FALSE,
+            G_PARAM_READWRITE));
+
+    g_object_class_install_property(
+        gobject_class, PROP_HYSTERESIS,
+        g_param_spec_float(
+            "hysteresis", "Hysteresis", "Close threshold of the trigger relative to the open threshold [dB]",
+            dd::DamageDetector::MIN_HYSTERESIS, dd::DamageDetector::MAX_HYSTERESIS, dd::DamageDetector::DFL_HYSTERESIS,
+            G_PARAM_READWRITE));
+
+    g_object_class_install_property(
+        gobject_class, PROP_OPEN_DEBOUNCE,
+        g_param_spec_float(
+            "open_debounce", "Open debounce", "Time the signal should stay above the threshold to open the trigger, negative is 1/10 of reactivity [ms]",
+            dd::DamageDetector::DFL_DEBOUNCE, dd::DamageDetector::MAX_DEBOUNCE, dd::DamageDetector::DFL_DEBOUNCE,
+            G_PARAM_READWRITE));
+
+    g_object_class_install_property(
+        gobject_class, PROP_CLOSE_DEBOUNCE,
+        g_param_spec_float(
+            "close_debounce", "Close debounce", "Time the signal should stay below the close threshold to close the trigger, negative is 1/10 of reactivity [ms]",
+            dd::DamageDetector::DFL_DEBOUNCE, dd::DamageDetector::MAX_DEBOUNCE, dd::DamageDetector::DFL_DEBOUNCE,
+            G_PARAM_READWRITE));
 }
 
 static void gst_damage_detector_init(GstDamageDetector *filter)
 {
     // Initialize filter and buffers
     filter->processor   = new dd::DamageDetector(2);
-    filter->left        = new float[IO_BUF_SIZE * 2];
-    filter->right       = &filter->left[IO_BUF_SIZE];
+    filter->listener    = new GstDamageDetectorListener(filter);
+    filter->journal     = new dd::EventJournal();
+    filter->journal_path= NULL;
+    filter->status      = new dd::StatusPage();
+    filter->status_path = NULL;
+    filter->buffers     = lsp::alloc_aligned<float>(filter->buffers_data, IO_BUF_SIZE * 2, IO_BUF_ALIGN);
+    filter->channels    = 2;
+
+    // The detector does not change the data, so buffers are processed in place
+    // whenever they are writable, no output buffers are allocated
+    gst_base_transform_set_in_place(GST_BASE_TRANSFORM(filter), TRUE);
 }
 
 static void gst_damage_detector_finalize(GObject * object)
@@ -214,11 +423,22 @@ static void gst_damage_detector_finalize(GObject * object)
 
     // Finalize filter and buffers
     delete filter->processor;
-    delete filter->left;
+    delete filter->listener;
+    delete filter->journal;
+    delete filter->status;
+    lsp::free_aligned(filter->buffers_data);
+    g_free(filter->journal_path);
+    g_free(filter->status_path);
 
     filter->processor   = NULL;
-    filter->left        = NULL;
-    filter->right       = NULL;
+    filter->listener    = NULL;
+    filter->journal     = NULL;
+    filter->journal_path= NULL;
+    filter->status      = NULL;
+    filter->status_path = NULL;
+    filter->buffers     = NULL;
+    filter->buffers_data= NULL;
+    filter->channels    = 0;
 
     G_OBJECT_CLASS(parent_class)->finalize(object);
 }
@@ -251,7 +471,7 @@ static void gst_damage_detector_set_property(
             break;
 
         case PROP_ESTIMATION_TIME:
-            p->set_detect_time(g_value_get_float(value));
+            p->set_estimation_time(g_value_get_float(value));
             break;
 
         case PROP_EVENTS_THRESHOLD:
@@ -262,12 +482,91 @@ static void gst_damage_detector_set_property(
             p->set_event_period(g_value_get_float(value));
             break;
 
+        case PROP_JOURNAL:
+            g_free(filter->journal_path);
+            filter->journal_path = g_value_dup_string(value);
+            break;
+
+        case PROP_STATUS:
+            g_free(filter->status_path);
+            filter->status_path = g_value_dup_string(value);
+            break;
+
+        case PROP_CLICKS:
+            p->set_click_detection(g_value_get_boolean(value));
+            break;
+
+        case PROP_CLICK_RATIO:
+            p->set_click_ratio(g_value_get_float(value));
+            break;
+
+        case PROP_FLAT_TIME:
+            p->set_flatline_time(g_value_get_float(value));
+            break;
+
+        case PROP_GAP_EVENTS:
+            p->set_gap_events(g_value_get_boolean(value));
+            break;
+
+        case PROP_ADAPTIVE:
+            p->set_adaptive(g_value_get_boolean(value));
+            break;
+
+        case PROP_ADAPT_QUANTILE:
+            p->set_adaptive_quantile(g_value_get_float(value));
+            break;
+
+        case PROP_ADAPT_OFFSET:
+            p->set_adaptive_offset(g_value_get_float(value));
+            break;
+
+        case PROP_ADAPT_TIME:
+            p->set_adaptive_time(g_value_get_float(value));
+            break;
+
+        case PROP_HIST_PERIOD:
+            p->set_histogram_period(g_value_get_float(value));
+            break;
+
+        case PROP_IMMEDIATE_EVENTS:
+            p->set_event_listener((g_value_get_boolean(value)) ? filter->listener : NULL);
+            break;
+
+        case PROP_LINKED:
+            p->set_linked(g_value_get_boolean(value));
+            break;
+
+        case PROP_HYSTERESIS:
+            p->set_hysteresis(g_value_get_float(value));
+            break;
+
+        case PROP_OPEN_DEBOUNCE:
+            p->set_open_debounce(g_value_get_float(value));
+            break;
+
+        case PROP_CLOSE_DEBOUNCE:
+            p->set_close_debounce(g_value_get_float(value));
+            break;
+
         default:
             G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
             break;
     }
 }
 
+static void gst_damage_detector_set_window_events(
+    GstStructure *structure,
+    const dd::DamageDetector *p)
+{
+    gst_structure_set(
+        structure,
+        "events_1s", G_TYPE_UINT, guint(p->window_events(dd::EV_WINDOW_1S)),
+        "events_10s", G_TYPE_UINT, guint(p->window_events(dd::EV_WINDOW_10S)),
+        "events_1m", G_TYPE_UINT, guint(p->window_events(dd::EV_WINDOW_1M)),
+        "events_10m", G_TYPE_UINT, guint(p->window_events(dd::EV_WINDOW_10M)),
+        NULL);
+}
+
 static void gst_damage_detector_get_property(
     GObject * object,
     guint prop_id,
@@ -303,6 +602,14 @@ static void gst_damage_detector_get_property(
             g_value_set_uint(value, p->events_count());
             break;
 
+        case PROP_WINDOW_EVENTS:
+        {
+            GstStructure *structure = gst_structure_new_empty("window-events");
+            gst_damage_detector_set_window_events(structure, p);
+            g_value_take_boxed(value, structure);
+            break;
+        }
+
         case PROP_EVENTS_THRESHOLD:
             g_value_set_uint(value, p->event_threshold());
             break;
@@ -311,12 +618,141 @@ static void gst_damage_detector_get_property(
             g_value_set_float(value, p->event_period());
             break;
 
+        case PROP_JOURNAL:
+            g_value_set_string(value, filter->journal_path);
+            break;
+
+        case PROP_STATUS:
+            g_value_set_string(value, filter->status_path);
+            break;
+
+        case PROP_CLICKS:
+            g_value_set_boolean(value, p->click_detection());
+            break;
+
+        case PROP_CLICK_RATIO:
+            g_value_set_float(value, p->click_ratio());
+            break;
+
+        case PROP_FLAT_TIME:
+            g_value_set_float(value, p->flatline_time());
+            break;
+
+        case PROP_GAP_EVENTS:
+            g_value_set_boolean(value, p->gap_events());
+            break;
+
+        case PROP_ADAPTIVE:
+            g_value_set_boolean(value, p->adaptive());
+            break;
+
+        case PROP_ADAPT_QUANTILE:
+            g_value_set_float(value, p->adaptive_quantile());
+            break;
+
+        case PROP_ADAPT_OFFSET:
+            g_value_set_float(value, p->adaptive_offset());
+            break;
+
+        case PROP_ADAPT_TIME:
+            g_value_set_float(value, p->adaptive_time());
+            break;
+
+        case PROP_HIST_PERIOD:
+            g_value_set_float(value, p->histogram_period());
+            break;
+
+        case PROP_IMMEDIATE_EVENTS:
+            g_value_set_boolean(value, p->event_listener() != NULL);
+            break;
+
+        case PROP_LINKED:
+            g_value_set_boolean(value, p->linked());
+            break;
+
+        case PROP_HYSTERESIS:
+            g_value_set_float(value, p->hysteresis());
+            break;
+
+        case PROP_OPEN_DEBOUNCE:
+            g_value_set_float(value, p->open_debounce());
+            break;
+
+        case PROP_CLOSE_DEBOUNCE:
+            g_value_set_float(value, p->close_debounce());
+            break;
+
         default:
             G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
             break;
     }
 }
 
+static void gst_damage_detector_copy_settings(
+    dd::DamageDetector *dst,
+    const dd::DamageDetector *src)
+{
+    dst->set_sample_rate(src->sample_rate());
+    dst->set_threshold(src->threshold());
+    dst->set_reactivity(src->reactivity());
+    dst->set_hysteresis(src->hysteresis());
+    dst->set_open_debounce(src->open_debounce());
+    dst->set_close_debounce(src->close_debounce());
+    dst->set_detect_time(src->detect_time());
+    dst->set_estimation_time(src->estimation_time());
+    dst->set_event_threshold(src->event_threshold());
+    dst->set_event_period(src->event_period());
+    dst->set_bypass(src->bypass());
+    dst->set_click_detection(src->click_detection());
+    dst->set_click_ratio(src->click_ratio());
+    dst->set_flatline_time(src->flatline_time());
+    dst->set_gap_events(src->gap_events());
+    dst->set_adaptive(src->adaptive());
+    dst->set_adaptive_quantile(src->adaptive_quantile());
+    dst->set_adaptive_offset(src->adaptive_offset());
+    dst->set_adaptive_time(src->adaptive_time());
+    dst->set_linked(src->linked());
+    dst->set_histogram_period(src->histogram_period());
+    dst->set_journal(src->journal());
+    dst->set_event_listener(src->event_listener());
+}
+
+static gboolean gst_damage_detector_set_channels(
+    GstDamageDetector *filter,
+    size_t channels)
+{
+    if (filter->channels == channels)
+        return TRUE;
+
+    // Create new processor and buffers for the new number of channels
+    dd::DamageDetector *processor = new dd::DamageDetector(channels);
+    uint8_t *data       = NULL;
+    float *buffers      = lsp::alloc_aligned<float>(data, IO_BUF_SIZE * channels, IO_BUF_ALIGN);
+    if ((processor == NULL) || (buffers == NULL))
+    {
+        delete processor;
+        lsp::free_aligned(data);
+        return FALSE;
+    }
+
+    // Replace the processor
+    {
+        GST_OBJECT_LOCK(filter);
+        lsp_finally { GST_OBJECT_UNLOCK(filter); };
+
+        gst_damage_detector_copy_settings(processor, filter->processor);
+        lsp::swap(filter->processor, processor);
+        lsp::swap(filter->buffers, buffers);
+        lsp::swap(filter->buffers_data, data);
+        filter->channels    = channels;
+    }
+
+    delete processor;
+    lsp::free_aligned(data);
+
+    return TRUE;
+}
+
 static gboolean gst_damage_detector_setup(
     GstAudioFilter * object,
     const GstAudioInfo * info)
@@ -324,22 +760,302 @@ static gboolean gst_damage_detector_setup(
     GstDamageDetector *filter = GST_DAMAGE_DETECTOR(object);
 
     gint sample_rate = GST_AUDIO_INFO_RATE(info);
+    gint channels = GST_AUDIO_INFO_CHANNELS(info);
     IF_TRACE(
-        gint channels = GST_AUDIO_INFO_CHANNELS(info);
         GstAudioFormat fmt = GST_AUDIO_INFO_FORMAT(info);
     );
 
     lsp_trace("this=%p, srate=%d, channels=%d, fmt=%d",
         object, int(sample_rate), int(channels), int(fmt));
 
-    // Update sample rate
+    // Update number of channels and sample rate
+    if (!gst_damage_detector_set_channels(filter, channels))
+        return FALSE;
     filter->processor->set_sample_rate(sample_rate);
+    if (filter->journal->opened())
+        filter->journal->submit_format(sample_rate, channels);
 
     return (GST_AUDIO_FILTER_CLASS(parent_class)->setup) ?
         GST_AUDIO_FILTER_CLASS(parent_class)->setup(object, info) :
         TRUE;
 }
 
+static gboolean gst_damage_detector_start(
+    GstBaseTransform *object)
+{
+    GstDamageDetector *filter = GST_DAMAGE_DETECTOR(object);
+
+    gchar *path = NULL;
+    gchar *status_path = NULL;
+    {
+        GST_OBJECT_LOCK(filter);
+        lsp_finally { GST_OBJECT_UNLOCK(filter); };
+        path = g_strdup(filter->journal_path);
+        status_path = g_strdup(filter->status_path);
+    }
+    lsp_finally {
+        g_free(path);
+        g_free(status_path);
+    };
+
+    // Open the status page if it is configured
+    if ((status_path != NULL) && (strlen(status_path) > 0))
+    {
+        lsp::status_t res = filter->status->open(status_path);
+        if (res != lsp::STATUS_OK)
+        {
+            GST_ELEMENT_ERROR(filter, RESOURCE, OPEN_WRITE,
+                ("Could not open status page"), ("path=%s, error=%d", status_path, int(res)));
+            return FALSE;
+        }
+    }
+
+    // Open the journal if it is configured
+    if ((path == NULL) || (strlen(path) <= 0))
+        return TRUE;
+
+    lsp::status_t res = filter->journal->open(path);
+    if (res != lsp::STATUS_OK)
+    {
+        filter->status->close();
+        GST_ELEMENT_ERROR(filter, RESOURCE, OPEN_WRITE,
+            ("Could not open event journal"), ("path=%s, error=%d", path, int(res)));
+        return FALSE;
+    }
+
+    filter->processor->set_journal(filter->journal);
+
+    return TRUE;
+}
+
+static gboolean gst_damage_detector_stop(
+    GstBaseTransform *object)
+{
+    GstDamageDetector *filter = GST_DAMAGE_DETECTOR(object);
+
+    filter->processor->set_journal(NULL);
+    filter->journal->close();
+    filter->status->close();
+
+    return TRUE;
+}
+
+static void gst_damage_detector_align_allocation(
+    GstQuery *query)
+{
+    // Raise the alignment of each proposed allocator, stricter alignment
+    // required by other elements is kept
+    const guint count = gst_query_get_n_allocation_params(query);
+    if (count <= 0)
+    {
+        GstAllocationParams params;
+        gst_allocation_params_init(&params);
+        params.align = IO_BUF_ALIGN - 1;
+        gst_query_add_allocation_param(query, NULL, &params);
+        return;
+    }
+
+    for (guint i=0; i<count; ++i)
+    {
+        GstAllocator *allocator = NULL;
+        GstAllocationParams params;
+        gst_query_parse_nth_allocation_param(query, i, &allocator, &params);
+        params.align = lsp::lsp_max(params.align, gsize(IO_BUF_ALIGN - 1));
+        gst_query_set_nth_allocation_param(query, i, allocator, &params);
+        if (allocator != NULL)
+            gst_object_unref(allocator);
+    }
+}
+
+static gboolean gst_damage_detector_propose_allocation(
+    GstBaseTransform *object,
+    GstQuery *decide_query,
+    GstQuery *query)
+{
+    // The parent class forwards the query downstream only in passthrough mode,
+    // the answer is completed with the alignment in any case
+    GstBaseTransformClass *klass = GST_BASE_TRANSFORM_CLASS(parent_class);
+    if (klass->propose_allocation != NULL)
+        klass->propose_allocation(object, decide_query, query);
+
+    gst_damage_detector_align_allocation(query);
+
+    return TRUE;
+}
+
+static gboolean gst_damage_detector_decide_allocation(
+    GstBaseTransform *object,
+    GstQuery *query)
+{
+    // Output buffers are allocated only if the element does not work in place
+    gst_damage_detector_align_allocation(query);
+
+    GstBaseTransformClass *klass = GST_BASE_TRANSFORM_CLASS(parent_class);
+    return (klass->decide_allocation != NULL) ?
+        klass->decide_allocation(object, query) :
+        TRUE;
+}
+
+static void gst_damage_detector_sync_pts(
+    GstDamageDetector *object,
+    GstBuffer *buf)
+{
+    const bool valid        = GST_BUFFER_PTS_IS_VALID(buf);
+    const int64_t pts       = (valid) ? int64_t(GST_BUFFER_PTS(buf)) : 0;
+
+    dd::StatusPage *status  = object->status;
+    if (status->opened())
+        status->sync(object->processor->timestamp(), (valid) ? pts : dd::STATUS_NO_PTS);
+
+    dd::EventJournal *journal = object->journal;
+    if (journal->opened())
+        journal->sync(object->processor->timestamp(), (valid) ? pts : dd::JOURNAL_NO_PTS, GST_AUDIO_FILTER_RATE(object));
+}
+
+static gchar *gst_damage_detector_format_histogram(
+    const dd::DamageDetector *p,
+    dd::histogram_t type)
+{
+    // Channels are separated by semicolons, each channel is the list of
+    // non-empty buckets in the form of <lower bound>:<count>
+    GString *str = g_string_new(NULL);
+
+    for (size_t i=0; i<p->channels(); ++i)
+    {
+        if (i > 0)
+            g_string_append_c(str, ';');
+
+        const dd::LogHistogram *h = p->histogram(i, type);
+        bool first = true;
+        for (size_t j=0; j<dd::LogHistogram::BUCKETS; ++j)
+        {
+            const uint32_t count = h->count(j);
+            if (count <= 0)
+                continue;
+
+            g_string_append_printf(str, (first) ? "%llu:%u" : " %llu:%u",
+                (unsigned long long)(dd::LogHistogram::lower_bound(j)),
+                (unsigned int)(count));
+            first = false;
+        }
+    }
+
+    return g_string_free(str, FALSE);
+}
+
+static void gst_damage_detector_deliver_histograms(
+    GstDamageDetector *object)
+{
+    dd::DamageDetector *p   = object->processor;
+    if (!p->poll_histograms())
+        return;
+
+    gchar *dropout  = gst_damage_detector_format_histogram(p, dd::HIST_DROPOUT);
+    gchar *interval = gst_damage_detector_format_histogram(p, dd::HIST_INTERVAL);
+    gchar *delay    = gst_damage_detector_format_histogram(p, dd::HIST_DELAY);
+    lsp_finally {
+        g_free(dropout);
+        g_free(interval);
+        g_free(delay);
+    };
+
+    GstStructure *structure = gst_structure_new(
+        "stream-histograms",
+        "channels", G_TYPE_UINT, guint(p->channels()),
+        "dropout", G_TYPE_STRING, dropout,
+        "interval", G_TYPE_STRING, interval,
+        "delay", G_TYPE_STRING, delay,
+        "timestamp", G_TYPE_UINT64, guint64(p->timestamp()),
+        NULL);
+
+    GstMessage *message = gst_message_new_element(GST_OBJECT(object), structure);
+    gst_element_post_message(GST_ELEMENT(object), message);
+
+    // Each message contains the data collected for the last period
+    p->clear_histograms();
+}
+
+static void gst_damage_detector_post_state(
+    GstDamageDetector *object,
+    dd::event_type_t ev,
+    size_t events,
+    dd::timestamp_t timestamp)
+{
+    lsp_trace("emitting message corrupted=%s, timestamp=%llu",
+        (ev == dd::EVENT_ABOVE) ? "true" : "false",
+        timestamp);
+
+    GstStructure *structure = gst_structure_new(
+        "stream-corruption-state",
+        "corrupted", G_TYPE_BOOLEAN, gboolean(ev == dd::EVENT_ABOVE),
+        "events", G_TYPE_UINT, guint(events),
+        "timestamp", G_TYPE_UINT64, guint64(timestamp),
+        "coalesced", G_TYPE_UINT64, guint64(object->processor->coalesced_events()),
+        NULL);
+    gst_damage_detector_set_window_events(structure, object->processor);
+
+    GstMessage *message = gst_message_new_element(GST_OBJECT(object), structure);
+    gst_element_post_message(GST_ELEMENT(object), message);
+}
+
+static void gst_damage_detector_deliver_events(
+    GstDamageDetector *object)
+{
+    dd::DamageDetector *p   = object->processor;
+
+    // Generate and deliver event if it is pending, immediate events
+    // have already been posted by the listener
+    const dd::event_type_t ev = p->poll_event();
+    if (ev != dd::EVENT_NONE)
+        gst_damage_detector_post_state(object, ev, p->events_count(), p->timestamp());
+
+    // Deliver flatline notifications
+    dd::flatline_t flat;
+    while (p->poll_flatline(&flat))
+    {
+        lsp_trace("emitting message flatline channel=%d, active=%s, start=%llu",
+            int(flat.nChannel),
+            (flat.bActive) ? "true" : "false",
+            (unsigned long long)(flat.nStart));
+
+        GstStructure *structure = gst_structure_new(
+            "stream-flatline",
+            "active", G_TYPE_BOOLEAN, gboolean(flat.bActive),
+            "channel", G_TYPE_UINT, guint(flat.nChannel),
+            "value", G_TYPE_FLOAT, gfloat(flat.fValue),
+            "start", G_TYPE_UINT64, guint64(flat.nStart),
+            "timestamp", G_TYPE_UINT64, guint64(p->timestamp()),
+            NULL);
+
+        GstMessage *message = gst_message_new_element(GST_OBJECT(object), structure);
+        gst_element_post_message(GST_ELEMENT(object), message);
+    }
+
+    // Deliver histograms if the export period has elapsed
+    gst_damage_detector_deliver_histograms(object);
+
+    // Update the status page for external monitoring
+    object->status->publish(p);
+}
+
+static void gst_damage_detector_trace_buffer(
+    GstDamageDetector *object,
+    GstClockTime start,
+    size_t samples,
+    uint64_t events)
+{
+    const dd::DamageDetector *p = object->processor;
+
+    gst_damage_detector_trace_t trace;
+    trace.proctime      = gst_util_get_timestamp() - start;
+    trace.samples       = samples;
+    trace.events        = guint(p->total_events() - events);
+    trace.queue         = guint(p->events_count());
+    trace.journal       = guint(object->journal->pending());
+
+    gst_damage_detector_trace(GST_ELEMENT(object), &trace);
+}
+
 static GstFlowReturn gst_damage_detector_process(
     GstDamageDetector *object,
     void *dst, const void *src, size_t bytes)
@@ -350,61 +1066,134 @@ static GstFlowReturn gst_damage_detector_process(
     lsp_finally { lsp::dsp::finish(&ctx); };
 
     // Do the main stuff
-    const size_t samples = bytes / (sizeof(float) * 2);
-    const float *sptr   = reinterpret_cast<const float *>(src);
-    float *dptr         = reinterpret_cast<float *>(dst);
+    dd::DamageDetector *p   = object->processor;
+    const size_t channels   = object->channels;
+    const size_t samples    = bytes / (sizeof(float) * channels);
+
+    // Measure processing time only if tracing is enabled
+    const bool tracing      = gst_damage_detector_tracing();
+    const GstClockTime start= (tracing) ? gst_util_get_timestamp() : 0;
+    const uint64_t events   = p->total_events();
+    const float *sptr       = reinterpret_cast<const float *>(src);
+    float *dptr             = reinterpret_cast<float *>(dst);
+    const bool bypass       = p->bypass();
 
     for (size_t offset=0; offset < samples; )
     {
         // Determine the number of samples to process
         const size_t to_do  = lsp::lsp_min(IO_BUF_SIZE, samples - offset);
 
-        // De-interleave data
-        for (size_t i=0; i<to_do; ++i, sptr += 2)
+        // De-interleave data and bind audio buffers
+        for (size_t i=0; i<channels; ++i)
         {
-            object->left[i] = sptr[0];
-            object->right[i] = sptr[1];
+            float *buf          = &object->buffers[i * IO_BUF_SIZE];
+            const float *s      = &sptr[i];
+            for (size_t j=0; j<to_do; ++j, s += channels)
+                buf[j]              = *s;
+
+            p->bind_input(i, buf);
+            p->bind_output(i, buf);
         }
 
-        // Bind audio buffers and perform processing
-        object->processor->bind_input(0, object->left);
-        object->processor->bind_input(1, object->right);
-        object->processor->bind_output(0, object->left);
-        object->processor->bind_output(1, object->right);
-        object->processor->process(to_do);
+        // Perform processing
+        p->process(to_do);
 
-        // Interleave data
-        for (size_t i=0; i<to_do; ++i, dptr += 2)
+        // In bypass mode the detector only sanitizes the data, so the interleaved
+        // data is sanitized directly instead of being interleaved back
+        if (bypass)
         {
-            dptr[0] = object->left[i];
-            dptr[1] = object->right[i];
+            if (dptr == sptr)
+                lsp::dsp::sanitize1(dptr, to_do * channels);
+            else
+                lsp::dsp::sanitize2(dptr, sptr, to_do * channels);
         }
-
-        // Generate and deliver event if it is pending
-        const dd::event_type_t ev = object->processor->poll_event();
-        if (ev != dd::EVENT_NONE)
+        else
         {
-            const dd::timestamp_t timestamp = object->processor->timestamp();
+            // Interleave data
+            for (size_t i=0; i<channels; ++i)
+            {
+                const float *buf    = &object->buffers[i * IO_BUF_SIZE];
+                float *d            = &dptr[i];
+                for (size_t j=0; j<to_do; ++j, d += channels)
+                    *d                  = buf[j];
+            }
+        }
 
-            lsp_trace("emitting message corrupted=%s, timestamp=%llu",
-                (ev == dd::EVENT_ABOVE) ? "true" : "false",
-                timestamp);
+        sptr               += to_do * channels;
+        dptr               += to_do * channels;
+
+        // Generate and deliver events if they are pending
+        gst_damage_detector_deliver_events(object);
+
+        // Update the offset
+        offset             += to_do;
+    }
 
-            GstStructure *structure = gst_structure_new(
-                "stream-corruption-state",
-                "corrupted", G_TYPE_BOOLEAN, gboolean(ev == dd::EVENT_ABOVE),
-                "events", G_TYPE_UINT, guint(object->processor->events_count()),
-                "timestamp", G_TYPE_UINT64, guint64(timestamp),
-                NULL);
+    if (tracing)
+        gst_damage_detector_trace_buffer(object, start, samples, events);
+
+    return GST_FLOW_OK;
+}
+
+static GstFlowReturn gst_damage_detector_process_planar(
+    GstDamageDetector *object,
+    GstAudioBuffer *dst, GstAudioBuffer *src)
+{
+    lsp::dsp::context_t ctx;
+    lsp::dsp::start(&ctx);
+    lsp_finally { lsp::dsp::finish(&ctx); };
 
-            GstMessage *message = gst_message_new_element(GST_OBJECT(object), structure);
-            gst_element_post_message(GST_ELEMENT(object), message);
+    dd::DamageDetector *p   = object->processor;
+    const size_t channels   = object->channels;
+    const size_t samples    = GST_AUDIO_BUFFER_N_SAMPLES(src);
+
+    const bool tracing      = gst_damage_detector_tracing();
+    const GstClockTime start= (tracing) ? gst_util_get_timestamp() : 0;
+    const uint64_t events   = p->total_events();
+
+    // Events are delivered by chunks of the same size as for interleaved data
+    for (size_t offset=0; offset < samples; )
+    {
+        const size_t to_do  = lsp::lsp_min(IO_BUF_SIZE, samples - offset);
+
+        for (size_t i=0; i<channels; ++i)
+        {
+            p->bind_input(i, &static_cast<const float *>(GST_AUDIO_BUFFER_PLANE_DATA(src, i))[offset]);
+            p->bind_output(i, &static_cast<float *>(GST_AUDIO_BUFFER_PLANE_DATA(dst, i))[offset]);
         }
 
-        // Update the offset
+        p->process(to_do);
+        gst_damage_detector_deliver_events(object);
+
         offset             += to_do;
     }
 
+    if (tracing)
+        gst_damage_detector_trace_buffer(object, start, samples, events);
+
+    return GST_FLOW_OK;
+}
+
+static GstFlowReturn gst_damage_detector_process_gap(
+    GstDamageDetector *object,
+    GstBuffer *buf)
+{
+    lsp::dsp::context_t ctx;
+    lsp::dsp::start(&ctx);
+    lsp_finally { lsp::dsp::finish(&ctx); };
+
+    const bool tracing      = gst_damage_detector_tracing();
+    const GstClockTime start= (tracing) ? gst_util_get_timestamp() : 0;
+    const uint64_t events   = object->processor->total_events();
+
+    // Gap buffers are not mapped, the detector just advances its state
+    const size_t samples    = gst_buffer_get_size(buf) / (sizeof(float) * object->channels);
+    object->processor->process_gap(samples);
+    gst_damage_detector_deliver_events(object);
+
+    if (tracing)
+        gst_damage_detector_trace_buffer(object, start, samples, events);
+
     return GST_FLOW_OK;
 }
 
@@ -415,6 +1204,32 @@ static GstFlowReturn gst_damage_detector_filter(
 {
     GstDamageDetector *filter = GST_DAMAGE_DETECTOR(object);
 
+    // Output silence for gaps in the stream
+    if (GST_BUFFER_FLAG_IS_SET(inbuf, GST_BUFFER_FLAG_GAP))
+    {
+        gst_damage_detector_sync_pts(filter, inbuf);
+        gst_buffer_memset(outbuf, 0, 0, gst_buffer_get_size(outbuf));
+        return gst_damage_detector_process_gap(filter, inbuf);
+    }
+
+    // Map planes of non-interleaved buffers
+    const GstAudioInfo *info = GST_AUDIO_FILTER_INFO(filter);
+    if (GST_AUDIO_INFO_LAYOUT(info) == GST_AUDIO_LAYOUT_NON_INTERLEAVED)
+    {
+        GstAudioBuffer abuf_in;
+        if (!gst_audio_buffer_map(&abuf_in, info, inbuf, GST_MAP_READ))
+            return GST_FLOW_OK;
+        lsp_finally { gst_audio_buffer_unmap(&abuf_in); };
+
+        GstAudioBuffer abuf_out;
+        if (!gst_audio_buffer_map(&abuf_out, info, outbuf, GST_MAP_WRITE))
+            return GST_FLOW_OK;
+        lsp_finally { gst_audio_buffer_unmap(&abuf_out); };
+
+        gst_damage_detector_sync_pts(filter, inbuf);
+        return gst_damage_detector_process_planar(filter, &abuf_out, &abuf_in);
+    }
+
     // Map buffers
     GstMapInfo map_in;
     if (!gst_buffer_map (inbuf, &map_in, GST_MAP_READ))
@@ -429,6 +1244,7 @@ static GstFlowReturn gst_damage_detector_filter(
     g_assert (map_out.size == map_in.size);
 
     // Call processing
+    gst_damage_detector_sync_pts(filter, inbuf);
     return gst_damage_detector_process(filter, map_out.data, map_in.data, map_out.size);
 }
 
@@ -438,6 +1254,26 @@ static GstFlowReturn gst_damage_detector_filter_inplace(
 {
     GstDamageDetector *filter = GST_DAMAGE_DETECTOR(object);
 
+    // Skip gaps in the stream
+    if (GST_BUFFER_FLAG_IS_SET(buf, GST_BUFFER_FLAG_GAP))
+    {
+        gst_damage_detector_sync_pts(filter, buf);
+        return gst_damage_detector_process_gap(filter, buf);
+    }
+
+    // Map planes of non-interleaved buffer
+    const GstAudioInfo *info = GST_AUDIO_FILTER_INFO(filter);
+    if (GST_AUDIO_INFO_LAYOUT(info) == GST_AUDIO_LAYOUT_NON_INTERLEAVED)
+    {
+        GstAudioBuffer abuf;
+        if (!gst_audio_buffer_map(&abuf, info, buf, GST_MAP_READWRITE))
+            return GST_FLOW_OK;
+        lsp_finally { gst_audio_buffer_unmap(&abuf); };
+
+        gst_damage_detector_sync_pts(filter, buf);
+        return gst_damage_detector_process_planar(filter, &abuf, &abuf);
+    }
+
     // Map buffer
     GstMapInfo map;
     if (!gst_buffer_map (buf, &map, GST_MAP_READWRITE))
@@ -445,6 +1281,7 @@ static GstFlowReturn gst_damage_detector_filter_inplace(
     lsp_finally { gst_buffer_unmap (buf, &map); };
 
     // Call processing
+    gst_damage_detector_sync_pts(filter, buf);
     return gst_damage_detector_process(filter, map.data, map.data, map.size);
 }
 
@@ -453,6 +1290,9 @@ static gboolean plugin_init(GstPlugin *plugin)
     lsp::dsp::init();
     lsp::debug::redirect("gst-damage-detector.log");
 
+    if (!gst_damage_detector_tracer_register(plugin))
+        return FALSE;
+
     return GST_ELEMENT_REGISTER(damage_detector, plugin);
 }
 
@@ -0,0 +1,157 @@
+/*
+ * Copyright (C) 2024 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2024 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of damage-detector
+ * Created on: 18 окт. 2026 г.
+ *
+ * damage-detector is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * damage-detector is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with damage-detector. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <lsp-plug.in/test-fw/ptest.h>
+#include <lsp-plug.in/common/alloc.h>
+#include <lsp-plug.in/common/finally.h>
+#include <lsp-plug.in/dsp/dsp.h>
+#include <lsp-plug.in/runtime/system.h>
+#include <lsp-plug.in/stdlib/math.h>
+
+#include <private/DamageDetector.h>
+
+#include <stdlib.h>
+
+PTEST_BEGIN("damage_detector", immediate_events, 5, 1000)
+
+    static constexpr size_t SAMPLE_RATE = 48000;
+    static constexpr size_t LENGTH      = SAMPLE_RATE * 2;
+    static constexpr size_t THRESHOLD   = 3;
+    static constexpr size_t REPEATS     = 15;
+
+    static uint64_t clock_ns()
+    {
+        lsp::system::time_t t;
+        lsp::system::get_time(&t);
+        return uint64_t(t.seconds) * 1000000000u + uint64_t(t.nanos);
+    }
+
+    class Listener: public dd::IEventListener
+    {
+        public:
+            uint64_t            nTime;      // Wall-clock time of the first notification, ns
+
+        public:
+            Listener()
+            {
+                nTime       = 0;
+            }
+
+        public:
+            virtual void on_event(const dd::notification_t *event) override
+            {
+                if ((event->enType == dd::EVENT_ABOVE) && (nTime == 0))
+                    nTime       = clock_ns();
+            }
+    };
+
+    /**
+     * Process the signal, return the wall-clock time from passing the buffer which
+     * contains the triggering event to the detector until the notification, ns
+     */
+    uint64_t process(const float *src, float *buf, size_t block, bool immediate)
+    {
+        lsp::dsp::copy(buf, src, LENGTH);
+
+        Listener listener;
+        dd::DamageDetector dd(1);
+        dd.set_sample_rate(SAMPLE_RATE);
+        dd.set_bypass(true);
+        dd.set_detect_time(dd::DamageDetector::MAX_DETECT_TIME);
+        dd.set_estimation_time(dd::DamageDetector::MIN_ESTIMATE_TIME);
+        dd.set_event_threshold(THRESHOLD);
+        dd.set_event_period(dd::DamageDetector::MAX_EV_PERIOD);
+        if (immediate)
+            dd.set_event_listener(&listener);
+
+        for (size_t offset=0; offset < LENGTH; offset += block)
+        {
+            const size_t to_do  = lsp::lsp_min(LENGTH - offset, block);
+            dd.bind_input(0, &buf[offset]);
+            dd.bind_output(0, &buf[offset]);
+
+            const uint64_t arrival  = clock_ns();
+            dd.process(to_do);
+
+            if (immediate)
+            {
+                if (listener.nTime != 0)
+                    return listener.nTime - arrival;
+            }
+            else if (dd.poll_event() == dd::EVENT_ABOVE)
+                return clock_ns() - arrival;
+        }
+
+        return 0;
+    }
+
+    static int compare_delays(const void *a, const void *b)
+    {
+        const uint64_t da   = *static_cast<const uint64_t *>(a);
+        const uint64_t db   = *static_cast<const uint64_t *>(b);
+        return (da < db) ? -1 : (da > db) ? 1 : 0;
+    }
+
+    /**
+     * Return the median of the notification delay in microseconds
+     */
+    float measure(const float *src, float *buf, size_t block, bool immediate)
+    {
+        uint64_t delays[REPEATS];
+        for (size_t i=0; i<REPEATS; ++i)
+            delays[i]           = process(src, buf, block, immediate);
+
+        qsort(delays, REPEATS, sizeof(uint64_t), compare_delays);
+        return delays[REPEATS / 2] * 1e-3f;
+    }
+
+    PTEST_MAIN
+    {
+        static const size_t blocks[] = { 64, 0x400, 0x1000, SAMPLE_RATE };
+
+        uint8_t *data   = NULL;
+        float *src      = lsp::alloc_aligned<float>(data, LENGTH * 2, 64);
+        float *buf      = &src[LENGTH];
+        lsp_finally { lsp::free_aligned(data); };
+
+        // Burst of 50 ms dropouts every 200 ms during the first second, clean signal after
+        for (size_t i=0; i<LENGTH; ++i)
+        {
+            const size_t pos    = i % (SAMPLE_RATE / 5);
+            src[i]              = ((i < SAMPLE_RATE) && (pos >= SAMPLE_RATE / 10) && (pos < SAMPLE_RATE / 10 + SAMPLE_RATE / 20)) ?
+                                  0.0f : 0.5f * sinf(i * 0.05f);
+        }
+
+        // Wall-clock delay from passing the buffer to the detector to the notification,
+        // the buffering of the block itself is not included
+        printf("%-12s %-16s %-16s\n", "Block size", "Polling, us", "Immediate, us");
+        for (size_t i=0; i<sizeof(blocks)/sizeof(blocks[0]); ++i)
+        {
+            const size_t block      = blocks[i];
+            const float pull_time   = measure(src, buf, block, false);
+            const float push_time   = measure(src, buf, block, true);
+
+            printf("%-12d %-16.1f %-16.1f\n", int(block), pull_time, push_time);
+        }
+    }
+
+PTEST_END
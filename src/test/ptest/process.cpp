@@ -0,0 +1,102 @@
+/*
+ * Copyright (C) 2024 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2024 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of damage-detector
+ * Created on: 18 окт. 2026 г.
+ *
+ * damage-detector is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * damage-detector is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with damage-detector. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <lsp-plug.in/test-fw/ptest.h>
+#include <lsp-plug.in/common/alloc.h>
+#include <lsp-plug.in/common/finally.h>
+#include <lsp-plug.in/dsp/dsp.h>
+
+#include <private/DamageDetector.h>
+
+#include <stdlib.h>
+
+PTEST_BEGIN("damage_detector", process, 5, 1000)
+
+    static constexpr size_t BLOCK_SIZE  = 0x200;
+    static constexpr size_t MAX_CHANNELS= 8;
+
+    void call(const char *label, dd::DamageDetector *detector, float **in, float **out, size_t channels)
+    {
+        char buf[80];
+        snprintf(buf, sizeof(buf), "%s x %d", label, int(channels));
+        printf("Testing %s channels...\n", buf);
+
+        PTEST_LOOP(buf,
+            for (size_t i=0; i<channels; ++i)
+            {
+                detector->bind_input(i, in[i]);
+                detector->bind_output(i, out[i]);
+            }
+            detector->process(BLOCK_SIZE);
+        );
+    }
+
+    PTEST_MAIN
+    {
+        uint8_t *data   = NULL;
+        uint8_t *zdata  = NULL;
+        float *ptr      = alloc_aligned<float>(data, BLOCK_SIZE * MAX_CHANNELS * 2, 64);
+        lsp_finally { free_aligned(data); };
+
+        float *in[MAX_CHANNELS], *out[MAX_CHANNELS];
+        for (size_t i=0; i<MAX_CHANNELS; ++i)
+        {
+            in[i]           = &ptr[BLOCK_SIZE * i * 2];
+            out[i]          = &in[i][BLOCK_SIZE];
+
+            // Signal with short dropouts
+            for (size_t j=0; j<BLOCK_SIZE; ++j)
+                in[i][j]        = ((j & 0x7f) < 0x10) ? 0.0f : (float(rand()) / RAND_MAX) - 0.5f;
+        }
+
+        // Digital silence
+        float *silence[MAX_CHANNELS];
+        float *zero     = alloc_aligned<float>(zdata, BLOCK_SIZE, 64);
+        lsp_finally { free_aligned(zdata); };
+        dsp::fill_zero(zero, BLOCK_SIZE);
+        for (size_t i=0; i<MAX_CHANNELS; ++i)
+            silence[i]      = zero;
+
+        static const size_t channels[] = { 1, 2, 6, 8 };
+
+        for (size_t i=0; i<sizeof(channels)/sizeof(size_t); ++i)
+        {
+            const size_t nc = channels[i];
+
+            dd::DamageDetector plain(nc), clicks(nc), linked(nc);
+            plain.set_sample_rate(48000);
+            clicks.set_sample_rate(48000);
+            clicks.set_click_detection(true);
+            linked.set_sample_rate(48000);
+            linked.set_linked(true);
+
+            call("plain", &plain, in, out, nc);
+            call("clicks", &clicks, in, out, nc);
+            if (nc > 1)
+                call("linked", &linked, in, out, nc);
+            call("silence", &plain, silence, out, nc);
+
+            PTEST_SEPARATOR;
+        }
+    }
+
+PTEST_END
@@ -0,0 +1,109 @@
+/*
+ * Copyright (C) 2024 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2024 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of damage-detector
+ * Created on: 18 окт. 2026 г.
+ *
+ * damage-detector is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * damage-detector is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with damage-detector. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <lsp-plug.in/test-fw/utest.h>
+#include <lsp-plug.in/common/alloc.h>
+#include <lsp-plug.in/common/finally.h>
+#include <lsp-plug.in/dsp/dsp.h>
+#include <lsp-plug.in/stdlib/math.h>
+
+#include <private/DamageDetector.h>
+#include <private/P2Quantile.h>
+
+#include <stdlib.h>
+
+UTEST_BEGIN("damage_detector", adaptive)
+
+    static constexpr size_t SAMPLE_RATE = 48000;
+    static constexpr size_t LENGTH      = SAMPLE_RATE * 20;
+    static constexpr size_t BLOCK_SIZE  = 0x200;
+
+    static float randf()
+    {
+        return float(rand()) / RAND_MAX;
+    }
+
+    void test_quantile()
+    {
+        dd::P2Quantile q;
+
+        // Uniform distribution
+        q.init(0.1f);
+        for (size_t i=0; i<100000; ++i)
+            q.update(randf());
+        UTEST_ASSERT_MSG(fabsf(q.value() - 0.1f) < 0.02f, "Estimated quantile %f, expected 0.1\n", q.value());
+
+        // Windowed estimator should track the shift of the distribution
+        q.init(0.5f, 1000);
+        for (size_t i=0; i<10000; ++i)
+            q.update(randf());
+        UTEST_ASSERT_MSG(fabsf(q.value() - 0.5f) < 0.05f, "Estimated median %f, expected 0.5\n", q.value());
+        for (size_t i=0; i<10000; ++i)
+            q.update(10.0f + randf());
+        UTEST_ASSERT_MSG(fabsf(q.value() - 10.5f) < 0.1f, "Estimated median %f, expected 10.5\n", q.value());
+    }
+
+    size_t run_detector(float *buf, bool adaptive)
+    {
+        dd::DamageDetector dd(1);
+        dd.set_sample_rate(SAMPLE_RATE);
+        dd.set_bypass(true);
+        dd.set_estimation_time(dd::DamageDetector::MAX_ESTIMATE_TIME);
+        dd.set_event_threshold(1000);
+        dd.set_adaptive(adaptive);
+
+        for (size_t offset=0; offset < LENGTH; offset += BLOCK_SIZE)
+        {
+            dd.bind_input(0, &buf[offset]);
+            dd.bind_output(0, &buf[offset]);
+            dd.process(BLOCK_SIZE);
+        }
+
+        return dd.events_count();
+    }
+
+    void test_detector()
+    {
+        uint8_t *data   = NULL;
+        float *buf      = lsp::alloc_aligned<float>(data, LENGTH, 64);
+        lsp_finally { lsp::free_aligned(data); };
+
+        // Quiet programme at about -55 dB with 50 ms dropouts every second
+        for (size_t i=0; i<LENGTH; ++i)
+            buf[i]          = ((i % SAMPLE_RATE) < (SAMPLE_RATE / 20)) ? 0.0f : (randf() - 0.5f) * 0.006f;
+
+        // The fixed threshold is above the programme level, so nothing is detected
+        UTEST_ASSERT(run_detector(buf, false) == 0);
+
+        // The adaptive threshold follows the programme level and detects dropouts
+        const size_t events = run_detector(buf, true);
+        UTEST_ASSERT_MSG(events >= 15, "Detected %d events, expected at least 15\n", int(events));
+    }
+
+    UTEST_MAIN
+    {
+        srand(1);
+        test_quantile();
+        test_detector();
+    }
+
+UTEST_END
@@ -0,0 +1,103 @@
+/*
+ * Copyright (C) 2024 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2024 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of damage-detector
+ * Created on: 18 окт. 2026 г.
+ *
+ * damage-detector is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * damage-detector is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with damage-detector. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <lsp-plug.in/test-fw/utest.h>
+
+#include <private/Arena.h>
+#include <private/DamageDetector.h>
+
+#include <new>
+#include <string.h>
+
+UTEST_BEGIN("damage_detector", arena)
+
+    static constexpr size_t DETECTORS   = 64;
+
+    UTEST_MAIN
+    {
+        dd::Arena arena;
+        UTEST_ASSERT(arena.init(dd::Arena::NODE_ANY - 1, 0) != lsp::STATUS_OK);
+        UTEST_ASSERT(arena.init(dd::Arena::NODE_CURRENT, dd::ARENA_NUMA_BIND | dd::ARENA_HUGE_PAGES) == lsp::STATUS_OK);
+        printf("Arena node: %d\n", int(arena.node()));
+
+        // Blocks should be aligned and should not overlap
+        uint8_t *small[16];
+        for (size_t i=0; i<16; ++i)
+        {
+            small[i]    = static_cast<uint8_t *>(arena.alloc(100 + i * 1000));
+            UTEST_ASSERT(small[i] != NULL);
+            UTEST_ASSERT((uintptr_t(small[i]) % dd::Arena::ALIGN) == 0);
+            memset(small[i], int(i), 100 + i * 1000);
+        }
+        for (size_t i=0; i<16; ++i)
+            for (size_t j=0; j<100 + i * 1000; ++j)
+                UTEST_ASSERT(small[i][j] == uint8_t(i));
+        UTEST_ASSERT(arena.mapped() == dd::Arena::CHUNK_SIZE);
+
+        // Released blocks should be reused by allocations of the same size class
+        arena.free(small[3]);
+        UTEST_ASSERT(arena.alloc(3100) == small[3]);
+
+        // Large blocks occupy dedicated chunks and are reused too
+        void *large     = arena.alloc(dd::Arena::CHUNK_SIZE * 2);
+        UTEST_ASSERT(large != NULL);
+        memset(large, 0x55, dd::Arena::CHUNK_SIZE * 2);
+        arena.free(large);
+        UTEST_ASSERT(arena.alloc(dd::Arena::CHUNK_SIZE + 1) == large);
+        arena.free(large);
+
+        // Detectors allocated from the arena
+        dd::DamageDetector *d[DETECTORS];
+        for (size_t i=0; i<DETECTORS; ++i)
+        {
+            void *ptr       = arena.alloc(sizeof(dd::DamageDetector));
+            UTEST_ASSERT(ptr != NULL);
+            d[i]            = new (ptr) dd::DamageDetector(2, &arena);
+            d[i]->set_sample_rate(48000);
+        }
+        const size_t used   = arena.used();
+        const size_t mapped = arena.mapped();
+        printf("Arena: mapped=%d, used=%d, huge=%d\n", int(mapped), int(used), int(arena.huge()));
+
+        // Recreation of detectors should not map new memory
+        for (size_t i=0; i<DETECTORS; ++i)
+        {
+            d[i]->~DamageDetector();
+            arena.free(d[i]);
+        }
+        for (size_t i=0; i<DETECTORS; ++i)
+        {
+            void *ptr       = arena.alloc(sizeof(dd::DamageDetector));
+            UTEST_ASSERT(ptr != NULL);
+            d[i]            = new (ptr) dd::DamageDetector(2, &arena);
+        }
+        UTEST_ASSERT(arena.used() == used);
+        UTEST_ASSERT(arena.mapped() == mapped);
+
+        for (size_t i=0; i<DETECTORS; ++i)
+        {
+            d[i]->~DamageDetector();
+            arena.free(d[i]);
+        }
+    }
+
+UTEST_END
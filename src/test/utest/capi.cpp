@@ -0,0 +1,140 @@
+/*
+ * Copyright (C) 2024 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2024 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of damage-detector
+ * Created on: 18 окт. 2026 г.
+ *
+ * damage-detector is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * damage-detector is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with damage-detector. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <lsp-plug.in/test-fw/utest.h>
+#include <lsp-plug.in/common/alloc.h>
+#include <lsp-plug.in/common/finally.h>
+#include <lsp-plug.in/stdlib/math.h>
+
+#include <damage-detector/damage-detector.h>
+
+UTEST_BEGIN("damage_detector", capi)
+
+    static constexpr size_t SAMPLE_RATE = 48000;
+    static constexpr size_t CHANNELS    = 2;
+    static constexpr size_t LENGTH      = SAMPLE_RATE * 5 + 100;
+    static constexpr size_t BLOCK_SIZE  = 0x300;
+
+    dd_detector_t *create(dd_arena_t *arena = NULL)
+    {
+        dd_detector_t *dd   = dd_create_in_arena(arena, CHANNELS, SAMPLE_RATE);
+        if (dd == NULL)
+            return NULL;
+
+        dd_set_param(dd, DD_PARAM_DETECT_TIME, 5.0);
+        dd_set_param(dd, DD_PARAM_EV_THRESHOLD, 2);
+        dd_set_param(dd, DD_PARAM_BYPASS, 1);
+        return dd;
+    }
+
+    UTEST_MAIN
+    {
+        uint8_t *data   = NULL;
+        float *buf      = lsp::alloc_aligned<float>(data, LENGTH * CHANNELS * 3, 64);
+        lsp_finally { lsp::free_aligned(data); };
+        float *planar   = buf;
+        float *inter    = &buf[LENGTH * CHANNELS];
+        float *out      = &buf[LENGTH * CHANNELS * 2];
+
+        // Sine wave with 50 ms dropouts every second, the second channel is delayed
+        for (size_t j=0; j<CHANNELS; ++j)
+        {
+            for (size_t i=0; i<LENGTH; ++i)
+            {
+                const size_t pos    = (i + j * 1000) % SAMPLE_RATE;
+                const float s       = ((pos >= SAMPLE_RATE / 2) && (pos < SAMPLE_RATE / 2 + SAMPLE_RATE / 20)) ?
+                                      0.0f : 0.5f * sinf(i * 0.05f);
+                planar[j * LENGTH + i]      = s;
+                inter[i * CHANNELS + j]     = s;
+            }
+        }
+
+        // Check parameters
+        double value    = 0.0;
+        dd_detector_t *dp   = create();
+        lsp_finally { dd_destroy(dp); };
+        UTEST_ASSERT(dp != NULL);
+        UTEST_ASSERT(dd_channels(dp) == CHANNELS);
+        UTEST_ASSERT(dd_create(0, SAMPLE_RATE) == NULL);
+        UTEST_ASSERT(dd_get_param(dp, DD_PARAM_EV_THRESHOLD, &value) == DD_OK);
+        UTEST_ASSERT(value == 2.0);
+        UTEST_ASSERT(dd_set_param(dp, dd_param_t(-1), 0.0) == DD_EBADARG);
+        UTEST_ASSERT(dd_process_planar(NULL, NULL, NULL, 0) == DD_EBADARG);
+
+        dd_detector_t *di   = create();
+        lsp_finally { dd_destroy(di); };
+        dd_detector_t *dn   = create();
+        lsp_finally { dd_destroy(dn); };
+        UTEST_ASSERT((di != NULL) && (dn != NULL));
+
+        // The detector allocated from the arena should behave the same way
+        UTEST_ASSERT(dd_arena_create(DD_NODE_ANY - 1, 0) == NULL);
+        dd_arena_t *arena   = dd_arena_create(DD_NODE_CURRENT, DD_ARENA_HUGE_PAGES | DD_ARENA_NUMA_BIND);
+        lsp_finally { dd_arena_destroy(arena); };
+        UTEST_ASSERT(arena != NULL);
+        dd_detector_t *da   = create(arena);
+        lsp_finally { dd_destroy(da); };
+        UTEST_ASSERT(da != NULL);
+        UTEST_ASSERT(dd_arena_mapped(arena) > 0);
+
+        // Process the same signal in planar form, interleaved form and without output
+        size_t ev_planar = 0, ev_inter = 0;
+        dd_event_t ev;
+        for (size_t offset=0; offset < LENGTH; offset += BLOCK_SIZE)
+        {
+            const size_t to_do  = lsp::lsp_min(LENGTH - offset, BLOCK_SIZE);
+            const float *in[CHANNELS];
+            float *pout[CHANNELS];
+            for (size_t j=0; j<CHANNELS; ++j)
+            {
+                in[j]               = &planar[j * LENGTH + offset];
+                pout[j]             = &out[j * LENGTH + offset];
+            }
+
+            UTEST_ASSERT(dd_process_planar(dp, in, pout, to_do) == DD_OK);
+            UTEST_ASSERT(dd_process_planar(dn, in, NULL, to_do) == DD_OK);
+            UTEST_ASSERT(dd_process_planar(da, in, NULL, to_do) == DD_OK);
+            UTEST_ASSERT(dd_process_interleaved(di, &inter[offset * CHANNELS], &inter[offset * CHANNELS], to_do) == DD_OK);
+
+            ev_planar          += dd_poll_event(dp, &ev);
+            ev_inter           += dd_poll_event(di, &ev);
+        }
+
+        // Bypassed output should match the input
+        for (size_t j=0; j<CHANNELS; ++j)
+            for (size_t i=0; i<LENGTH; ++i)
+            {
+                UTEST_ASSERT(out[j * LENGTH + i] == planar[j * LENGTH + i]);
+                UTEST_ASSERT(inter[i * CHANNELS + j] == planar[j * LENGTH + i]);
+            }
+
+        UTEST_ASSERT(dd_timestamp(dp) == LENGTH);
+        UTEST_ASSERT_MSG(dd_total_events(dp) >= 8, "Detected %d events\n", int(dd_total_events(dp)));
+        UTEST_ASSERT(dd_total_events(di) == dd_total_events(dp));
+        UTEST_ASSERT(dd_total_events(dn) == dd_total_events(dp));
+        UTEST_ASSERT(dd_total_events(da) == dd_total_events(dp));
+        UTEST_ASSERT(dd_coalesced_events(dp) == 0);
+        UTEST_ASSERT(ev_planar > 0);
+        UTEST_ASSERT(ev_inter == ev_planar);
+    }
+
+UTEST_END
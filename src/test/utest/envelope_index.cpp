@@ -0,0 +1,133 @@
+/*
+ * Copyright (C) 2024 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2024 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of damage-detector
+ * Created on: 18 окт. 2026 г.
+ *
+ * damage-detector is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * damage-detector is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with damage-detector. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+
+#include <lsp-plug.in/test-fw/utest.h>
+#include <lsp-plug.in/common/alloc.h>
+#include <lsp-plug.in/common/finally.h>
+#include <lsp-plug.in/dsp/dsp.h>
+#include <lsp-plug.in/stdlib/math.h>
+
+#include <private/DamageDetector.h>
+#include <private/EnvelopeIndex.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+UTEST_BEGIN("damage_detector", envelope_index)
+
+    static constexpr size_t SAMPLE_RATE = 48000;
+    static constexpr size_t CHANNELS    = 2;
+    static constexpr size_t LENGTH      = SAMPLE_RATE * 10 + 100;
+    static constexpr size_t BLOCK_SIZE  = 0x200;
+    static constexpr size_t DECIMATION  = 64;
+
+    void configure(dd::DamageDetector *dd)
+    {
+        dd->set_sample_rate(SAMPLE_RATE);
+        dd->set_bypass(true);
+        dd->set_detect_time(dd::DamageDetector::MAX_DETECT_TIME);
+        dd->set_estimation_time(dd::DamageDetector::MAX_ESTIMATE_TIME);
+        dd->set_event_threshold(1000);
+    }
+
+    UTEST_MAIN
+    {
+        char path[0x400];
+        snprintf(path, sizeof(path), "%s/utest-%s.env", tempdir(), full_name());
+
+        uint8_t *data   = NULL;
+        float *buf      = lsp::alloc_aligned<float>(data, LENGTH * CHANNELS, 64);
+        lsp_finally { lsp::free_aligned(data); };
+
+        // Sine wave with 50 ms dropouts every second, the second channel is delayed
+        for (size_t j=0; j<CHANNELS; ++j)
+        {
+            float *dst      = &buf[j * LENGTH];
+            for (size_t i=0; i<LENGTH; ++i)
+            {
+                const size_t pos    = (i + j * 1000) % SAMPLE_RATE;
+                dst[i]              = ((pos >= SAMPLE_RATE / 2) && (pos < SAMPLE_RATE / 2 + SAMPLE_RATE / 20)) ?
+                                      0.0f : 0.5f * sinf(i * 0.05f);
+            }
+        }
+
+        // Analyze the audio and write the index
+        size_t events   = 0;
+        {
+            dd::EnvelopeIndex index;
+            UTEST_ASSERT(index.create(path, CHANNELS, SAMPLE_RATE, DECIMATION, dd::DamageDetector::DFL_REACTIVITY) == lsp::STATUS_OK);
+
+            dd::DamageDetector dd(CHANNELS);
+            configure(&dd);
+            dd.set_envelope_index(&index);
+            for (size_t offset=0; offset < LENGTH; offset += BLOCK_SIZE)
+            {
+                const size_t to_do  = lsp::lsp_min(LENGTH - offset, BLOCK_SIZE);
+                for (size_t j=0; j<CHANNELS; ++j)
+                {
+                    dd.bind_input(j, &buf[j * LENGTH + offset]);
+                    dd.bind_output(j, &buf[j * LENGTH + offset]);
+                }
+                dd.process(to_do);
+            }
+
+            UTEST_ASSERT(index.close() == lsp::STATUS_OK);
+            UTEST_ASSERT(index.lost() == 0);
+            events          = dd.events_count();
+        }
+        UTEST_ASSERT_MSG(events >= 18, "Detected %d events, expected at least 18\n", int(events));
+
+        // Re-analyze the index
+        dd::EnvelopeIndex index;
+        UTEST_ASSERT(index.open(path) == lsp::STATUS_OK);
+        lsp_finally { index.close(); };
+        UTEST_ASSERT(index.channels() == CHANNELS);
+        UTEST_ASSERT(index.samples() == LENGTH);
+        UTEST_ASSERT(index.entries() == (LENGTH + DECIMATION - 1) / DECIMATION);
+
+        dd::DamageDetector dd(CHANNELS);
+        configure(&dd);
+        dd.set_reactivity(index.reactivity());
+
+        dd::envelope_entry_t frame[CHANNELS];
+        float env[CHANNELS][DECIMATION];
+        for (size_t left = index.samples(); left > 0; )
+        {
+            UTEST_ASSERT(index.read(frame, 1) == 1);
+            const size_t length = lsp::lsp_min(left, DECIMATION);
+            for (size_t j=0; j<CHANNELS; ++j)
+            {
+                lsp::dsp::fill(env[j], frame[j].fFirst, length / 2);
+                lsp::dsp::fill(&env[j][length / 2], frame[j].fSecond, length - length / 2);
+                dd.bind_input(j, env[j]);
+            }
+            dd.process_envelope(length);
+            left           -= length;
+        }
+
+        UTEST_ASSERT_MSG(dd.events_count() == events,
+            "Re-analysis detected %d events, expected %d\n", int(dd.events_count()), int(events));
+        UTEST_ASSERT(dd.timestamp() == LENGTH);
+    }
+
+UTEST_END
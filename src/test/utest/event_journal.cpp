@@ -0,0 +1,190 @@
+/*
+ * Copyright (C) 2024 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2024 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of damage-detector
+ * Created on: 18 окт. 2026 г.
+ *
+ * damage-detector is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * damage-detector is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with damage-detector. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <lsp-plug.in/test-fw/utest.h>
+#include <lsp-plug.in/common/finally.h>
+#include <lsp-plug.in/io/Path.h>
+
+#include <private/EventJournal.h>
+
+#include <stdio.h>
+#include <string.h>
+
+UTEST_BEGIN("damage_detector", event_journal)
+
+    static constexpr size_t MAX_RECORDS     = 0x4000;
+    static constexpr size_t OVERFLOW_EVENTS = 10000;
+
+    typedef struct content_t
+    {
+        dd::journal_header_t    sHeader;
+        dd::journal_record_t    vRecords[MAX_RECORDS];
+        size_t                  nRecords;
+    } content_t;
+
+    void read_journal(content_t *res, const char *path)
+    {
+        FILE *fd            = fopen(path, "rb");
+        UTEST_ASSERT(fd != NULL);
+        lsp_finally { fclose(fd); };
+
+        UTEST_ASSERT(fread(&res->sHeader, sizeof(res->sHeader), 1, fd) == 1);
+        res->nRecords       = fread(res->vRecords, sizeof(dd::journal_record_t), MAX_RECORDS, fd);
+        UTEST_ASSERT(res->nRecords < MAX_RECORDS);
+    }
+
+    void check_record(const dd::journal_record_t *r, dd::journal_record_type_t type, size_t channel,
+        dd::timestamp_t start, dd::timestamp_t end, int64_t pts, float value)
+    {
+        UTEST_ASSERT_MSG((r->nType == type) && (r->nChannel == channel) &&
+            (r->nStart == start) && (r->nEnd == end) && (r->nPts == pts) && (r->fValue == value),
+            "record is type=%d channel=%d start=%llu end=%llu pts=%lld value=%f\n",
+            int(r->nType), int(r->nChannel), (unsigned long long)(r->nStart), (unsigned long long)(r->nEnd),
+            (long long)(r->nPts), r->fValue);
+    }
+
+    void test_reopen(const char *path, content_t *res)
+    {
+        printf("Testing header and append on reopen\n");
+
+        dd::EventJournal journal;
+        UTEST_ASSERT(journal.open(path) == lsp::STATUS_OK);
+        UTEST_ASSERT(journal.open(path) == lsp::STATUS_OPENED);
+        UTEST_ASSERT(journal.submit_format(48000, 2));
+        UTEST_ASSERT(journal.submit_dropout(1, 100, 200, -60.0f));
+        UTEST_ASSERT(journal.close() == lsp::STATUS_OK);
+        UTEST_ASSERT(!journal.submit_dropout(1, 300, 400, -60.0f));
+
+        // The second session appends records without writing another header
+        UTEST_ASSERT(journal.open(path) == lsp::STATUS_OK);
+        journal.sync(1000, 2000000000, 48000);
+        UTEST_ASSERT(journal.submit_click(0, 49000, 20.0f));
+        UTEST_ASSERT(journal.close() == lsp::STATUS_OK);
+
+        read_journal(res, path);
+        UTEST_ASSERT(res->sHeader.nMagic == dd::JOURNAL_MAGIC);
+        UTEST_ASSERT(res->sHeader.nVersion == dd::JOURNAL_VERSION);
+        UTEST_ASSERT(res->sHeader.nRecordSize == sizeof(dd::journal_record_t));
+        UTEST_ASSERT(res->nRecords == 3);
+        check_record(&res->vRecords[0], dd::JR_FORMAT, 0, 48000, 2, dd::JOURNAL_NO_PTS, 0.0f);
+        check_record(&res->vRecords[1], dd::JR_DROPOUT, 1, 100, 200, dd::JOURNAL_NO_PTS, -60.0f);
+        check_record(&res->vRecords[2], dd::JR_CLICK, 0, 49000, 49000, 3000000000LL, 20.0f);
+    }
+
+    void test_overflow(const char *path, content_t *res)
+    {
+        printf("Testing ring buffer overflow\n");
+
+        // The ring of 4 records overflows since the writer sleeps when it has nothing to write
+        dd::EventJournal journal;
+        UTEST_ASSERT(journal.open(path, 3) == lsp::STATUS_OK);
+
+        size_t lost         = 0;
+        for (size_t i=0; i<OVERFLOW_EVENTS; ++i)
+        {
+            if (!journal.submit_dropout(0, i, i + 1, -60.0f))
+                ++lost;
+        }
+        UTEST_ASSERT(journal.close() == lsp::STATUS_OK);
+        printf("Lost %d of %d records\n", int(lost), int(OVERFLOW_EVENTS));
+        UTEST_ASSERT(lost > 0);
+
+        // Each accepted record is written in order, lost records are accounted by overflow records
+        read_journal(res, path);
+        size_t written      = 0;
+        size_t reported     = 0;
+        dd::timestamp_t last = 0;
+        for (size_t i=0; i<res->nRecords; ++i)
+        {
+            const dd::journal_record_t *r = &res->vRecords[i];
+            if (r->nType == dd::JR_OVERFLOW)
+            {
+                UTEST_ASSERT(r->nStart > 0);
+                reported           += r->nStart;
+                continue;
+            }
+
+            UTEST_ASSERT(r->nType == dd::JR_DROPOUT);
+            UTEST_ASSERT((written == 0) || (r->nStart > last));
+            last                = r->nStart;
+            ++written;
+        }
+        UTEST_ASSERT(reported == lost);
+        UTEST_ASSERT(written + lost == OVERFLOW_EVENTS);
+    }
+
+    void test_csv(const char *path)
+    {
+        printf("Testing CSV export\n");
+
+        dd::EventJournal journal;
+        UTEST_ASSERT(journal.open(path) == lsp::STATUS_OK);
+        UTEST_ASSERT(journal.submit_format(48000, 2));
+        journal.sync(0, 1000000000, 48000);
+        UTEST_ASSERT(journal.submit_dropout(1, 48000, 96000, -60.5f));
+        UTEST_ASSERT(journal.submit_gap(96000, 120000));
+        UTEST_ASSERT(journal.close() == lsp::STATUS_OK);
+
+        static const char *expected =
+            "type,channel,start,end,pts,value\n"
+            "format,0,48000,2,,0.00\n"
+            "dropout,1,48000,96000,2000000000,-60.50\n"
+            "gap,0,96000,120000,3000000000,0.00\n";
+
+        FILE *in            = fopen(path, "rb");
+        UTEST_ASSERT(in != NULL);
+        lsp_finally { fclose(in); };
+        FILE *out           = tmpfile();
+        UTEST_ASSERT(out != NULL);
+        lsp_finally { fclose(out); };
+
+        UTEST_ASSERT(dd::EventJournal::export_csv(out, in) == lsp::STATUS_OK);
+
+        char buf[0x200];
+        rewind(out);
+        const size_t len    = fread(buf, 1, sizeof(buf) - 1, out);
+        buf[len]            = '\0';
+        UTEST_ASSERT_MSG(!strcmp(buf, expected), "CSV output:\n%s", buf);
+
+        // The file without a valid header is rejected
+        UTEST_ASSERT(fseek(in, sizeof(uint32_t), SEEK_SET) == 0);
+        UTEST_ASSERT(dd::EventJournal::export_csv(out, in) == lsp::STATUS_BAD_FORMAT);
+    }
+
+    UTEST_MAIN
+    {
+        lsp::io::Path path;
+        UTEST_ASSERT(path.fmt("%s/utest-%s.ddj", tempdir(), full_name()) > 0);
+        remove(path.as_native());
+        lsp_finally { remove(path.as_native()); };
+
+        static content_t res;
+        test_reopen(path.as_native(), &res);
+
+        remove(path.as_native());
+        test_overflow(path.as_native(), &res);
+
+        remove(path.as_native());
+        test_csv(path.as_native());
+    }
+
+UTEST_END
@@ -0,0 +1,64 @@
+/*
+ * Copyright (C) 2024 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2024 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of damage-detector
+ * Created on: 18 окт. 2026 г.
+ *
+ * damage-detector is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * damage-detector is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with damage-detector. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <lsp-plug.in/test-fw/utest.h>
+
+#include <private/EventWindows.h>
+
+UTEST_BEGIN("damage_detector", event_windows)
+
+    static constexpr size_t SAMPLE_RATE = 1000;
+
+    UTEST_MAIN
+    {
+        dd::EventWindows w;
+        w.init(SAMPLE_RATE);
+
+        // One event per second during 2 minutes
+        dd::timestamp_t ts = 0;
+        for (size_t i=0; i<120; ++i, ts += SAMPLE_RATE)
+            w.submit(ts + SAMPLE_RATE / 2);
+        w.advance(ts);
+
+        UTEST_ASSERT(w.count(dd::EV_WINDOW_1S) <= 1);
+        UTEST_ASSERT((w.count(dd::EV_WINDOW_10S) >= 9) && (w.count(dd::EV_WINDOW_10S) <= 10));
+        UTEST_ASSERT((w.count(dd::EV_WINDOW_1M) >= 54) && (w.count(dd::EV_WINDOW_1M) <= 60));
+        UTEST_ASSERT(w.count(dd::EV_WINDOW_10M) == 120);
+
+        // Events go out of windows over time
+        w.advance(ts + 11 * SAMPLE_RATE);
+        UTEST_ASSERT(w.count(dd::EV_WINDOW_1S) == 0);
+        UTEST_ASSERT(w.count(dd::EV_WINDOW_10S) == 0);
+        UTEST_ASSERT(w.count(dd::EV_WINDOW_10M) == 120);
+
+        // Long pause drops everything
+        w.advance(ts + 3600 * SAMPLE_RATE);
+        UTEST_ASSERT(w.count(dd::EV_WINDOW_1M) == 0);
+        UTEST_ASSERT(w.count(dd::EV_WINDOW_10M) == 0);
+
+        // Restart after the pause
+        w.submit(ts + 3600 * SAMPLE_RATE);
+        UTEST_ASSERT(w.count(dd::EV_WINDOW_1S) == 1);
+        UTEST_ASSERT(w.count(dd::EV_WINDOW_10M) == 1);
+    }
+
+UTEST_END
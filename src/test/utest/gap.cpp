@@ -0,0 +1,171 @@
+/*
+ * Copyright (C) 2024 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2024 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of damage-detector
+ * Created on: 18 окт. 2026 г.
+ *
+ * damage-detector is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * damage-detector is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with damage-detector. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <lsp-plug.in/test-fw/utest.h>
+#include <lsp-plug.in/common/alloc.h>
+#include <lsp-plug.in/common/finally.h>
+#include <lsp-plug.in/dsp/dsp.h>
+#include <lsp-plug.in/io/Path.h>
+#include <lsp-plug.in/stdlib/math.h>
+
+#include <private/DamageDetector.h>
+#include <private/EventJournal.h>
+
+#include <stdio.h>
+
+UTEST_BEGIN("damage_detector", gap)
+
+    static constexpr size_t SAMPLE_RATE = 48000;
+    static constexpr size_t SIGNAL      = SAMPLE_RATE / 2;
+    static constexpr size_t GAP         = SAMPLE_RATE * 2;
+    static constexpr size_t LENGTH      = SIGNAL * 2;
+    static constexpr size_t BLOCK_SIZE  = 0x400;
+    static constexpr size_t MAX_RECORDS = 16;
+
+    typedef struct result_t
+    {
+        dd::journal_record_t    vRecords[MAX_RECORDS];
+        size_t                  nRecords;
+        size_t                  nState;         // Trigger state at the end of the gap
+        dd::timestamp_t         nTimestamp;     // Timestamp at the end of the gap
+        uint64_t                nTotal;         // Total number of events
+    } result_t;
+
+    void process(dd::DamageDetector *dd, float *buf, size_t samples)
+    {
+        for (size_t offset=0; offset < samples; offset += BLOCK_SIZE)
+        {
+            const size_t to_do  = lsp::lsp_min(samples - offset, BLOCK_SIZE);
+            dd->bind_input(0, &buf[offset]);
+            dd->bind_output(0, &buf[offset]);
+            dd->process(to_do);
+        }
+    }
+
+    void run(result_t *res, const float *src, float *buf, size_t gap_block)
+    {
+        lsp::io::Path path;
+        UTEST_ASSERT(path.fmt("%s/utest-%s.ddj", tempdir(), full_name()) > 0);
+
+        dd::EventJournal journal;
+        UTEST_ASSERT(journal.open(path.as_native()) == lsp::STATUS_OK);
+
+        dd::DamageDetector dd(1);
+        dd.set_sample_rate(SAMPLE_RATE);
+        dd.set_bypass(true);
+        dd.set_threshold(-40.0f);
+        dd.set_gap_events(true);
+        dd.set_journal(&journal);
+
+        // Short signal, the gap delivered by buffers of gap_block samples, then the signal again
+        lsp::dsp::copy(buf, src, LENGTH);
+        process(&dd, buf, SIGNAL);
+        for (size_t offset=0; offset < GAP; offset += gap_block)
+            dd.process_gap(lsp::lsp_min(GAP - offset, gap_block));
+        res->nState         = dd.trigger_state(0);
+        res->nTimestamp     = dd.timestamp();
+        process(&dd, &buf[SIGNAL], LENGTH - SIGNAL);
+        res->nTotal         = dd.total_events();
+
+        dd.set_journal(NULL);
+        UTEST_ASSERT(journal.close() == lsp::STATUS_OK);
+
+        FILE *fd            = fopen(path.as_native(), "rb");
+        UTEST_ASSERT(fd != NULL);
+        lsp_finally {
+            fclose(fd);
+            remove(path.as_native());
+        };
+
+        dd::journal_header_t hdr;
+        UTEST_ASSERT(fread(&hdr, sizeof(hdr), 1, fd) == 1);
+        res->nRecords       = fread(res->vRecords, sizeof(dd::journal_record_t), MAX_RECORDS, fd);
+        UTEST_ASSERT(res->nRecords < MAX_RECORDS);
+    }
+
+    static size_t find_records(const dd::journal_record_t **found, const result_t *res, size_t type)
+    {
+        size_t count        = 0;
+        for (size_t i=0; i<res->nRecords; ++i)
+        {
+            if (res->vRecords[i].nType != type)
+                continue;
+            *found              = &res->vRecords[i];
+            ++count;
+        }
+        return count;
+    }
+
+    UTEST_MAIN
+    {
+        uint8_t *data   = NULL;
+        float *src      = lsp::alloc_aligned<float>(data, LENGTH * 2, 64);
+        float *buf      = &src[LENGTH];
+        lsp_finally { lsp::free_aligned(data); };
+
+        for (size_t i=0; i<LENGTH; ++i)
+            src[i]          = 0.5f * sinf(2.0f * M_PI * 440.0f * i / SAMPLE_RATE);
+
+        // The whole gap at once: the trigger opened by the short signal closes inside
+        // the gap, the dropout and the gap are counted as events
+        static result_t ref, res;
+        run(&ref, src, buf, GAP);
+        UTEST_ASSERT(ref.nState == 0);
+        UTEST_ASSERT(ref.nTimestamp == SIGNAL + GAP);
+        UTEST_ASSERT(ref.nTotal == 2);
+
+        const dd::journal_record_t *gap = NULL;
+        UTEST_ASSERT(find_records(&gap, &ref, dd::JR_GAP) == 1);
+        UTEST_ASSERT(gap->nStart == SIGNAL);
+        UTEST_ASSERT(gap->nEnd == SIGNAL + GAP);
+
+        const dd::journal_record_t *dropout = NULL;
+        UTEST_ASSERT(find_records(&dropout, &ref, dd::JR_DROPOUT) == 1);
+        UTEST_ASSERT(dropout->nEnd > SIGNAL);
+        UTEST_ASSERT(dropout->nEnd < SIGNAL + GAP);
+
+        // The same gap split into short buffers, including buffers shorter than
+        // the decay of the envelope, should produce exactly the same result
+        static const size_t blocks[] = { 1, 7, 100, 479, 480, 0x400 };
+        for (size_t i=0; i<sizeof(blocks)/sizeof(size_t); ++i)
+        {
+            printf("Testing gap buffers of %d samples\n", int(blocks[i]));
+            run(&res, src, buf, blocks[i]);
+
+            UTEST_ASSERT(res.nState == ref.nState);
+            UTEST_ASSERT(res.nTimestamp == ref.nTimestamp);
+            UTEST_ASSERT(res.nTotal == ref.nTotal);
+            UTEST_ASSERT(res.nRecords == ref.nRecords);
+            for (size_t j=0; j<res.nRecords; ++j)
+            {
+                const dd::journal_record_t *a = &ref.vRecords[j];
+                const dd::journal_record_t *b = &res.vRecords[j];
+                UTEST_ASSERT_MSG((a->nType == b->nType) && (a->nChannel == b->nChannel) &&
+                    (a->nStart == b->nStart) && (a->nEnd == b->nEnd),
+                    "record %d is type=%d start=%llu end=%llu, expected type=%d start=%llu end=%llu\n",
+                    int(j), int(b->nType), (unsigned long long)(b->nStart), (unsigned long long)(b->nEnd),
+                    int(a->nType), (unsigned long long)(a->nStart), (unsigned long long)(a->nEnd));
+            }
+        }
+    }
+
+UTEST_END
@@ -0,0 +1,516 @@
+/*
+ * Copyright (C) 2024 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2024 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of damage-detector
+ * Created on: 18 окт. 2026 г.
+ *
+ * damage-detector is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * damage-detector is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with damage-detector. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <lsp-plug.in/test-fw/utest.h>
+#include <lsp-plug.in/common/alloc.h>
+#include <lsp-plug.in/common/finally.h>
+#include <lsp-plug.in/dsp/dsp.h>
+#include <lsp-plug.in/dsp-units/sampling/Sample.h>
+#include <lsp-plug.in/io/Path.h>
+#include <lsp-plug.in/stdlib/math.h>
+
+#include <private/DamageDetector.h>
+#include <private/EventJournal.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+namespace
+{
+    typedef struct baseline_t
+    {
+        const char         *sName;          // Name of the input
+        const uint32_t     *vEvents;        // Pairs of channel and time stamp of the dropout event
+        size_t              nEvents;        // Number of events
+    } baseline_t;
+
+    // Dropout events of the synthetic inputs frozen from the 1.0.1 release of the detector (plain
+    // scalar processing by blocks of 1024 samples), the clicks inputs have no dropouts. The events
+    // were generated with the RMS sidechain computed as a moving sum of squares over the reactivity
+    // window, as the RMS mode of lsp-dsp-units does, but not by the library itself. Rounding of the
+    // window length and float accumulation of the sum move the events by one sample, so the event
+    // times are compared with BASELINE_TOLERANCE. The chatter inputs are not frozen: their level
+    // stays at the threshold and the events depend on the rounding of the sidechain
+    static constexpr uint32_t BASELINE_TOLERANCE    = 2;    // Tolerance of the event time in samples
+
+    static const uint32_t BASELINE_DROPOUTS_1[] =
+    {
+        0, 12528, 0, 32672, 0, 49277, 0, 94016, 0, 112095, 0, 140796,
+        0, 155171, 0, 190563, 0, 211836, 0, 242585, 0, 266568, 0, 313360,
+        0, 351341, 0, 383434,
+    };
+
+    static const uint32_t BASELINE_DROPOUTS_2[] =
+    {
+        0, 12528, 0, 32718, 0, 48597, 0, 82766, 0, 95915, 0, 117271,
+        0, 152996, 0, 194491, 0, 229533, 0, 264037, 0, 274598, 0, 307519,
+        0, 333114, 0, 356770, 1, 12528, 1, 34741, 1, 73247, 1, 82248,
+        1, 94391, 1, 147388, 1, 167880, 1, 193503, 1, 206096, 1, 239752,
+        1, 261663, 1, 303750, 1, 332160, 1, 363738, 1, 370860, 1, 383230,
+    };
+
+    static const uint32_t BASELINE_DROPOUTS_3[] =
+    {
+        0, 12528, 0, 43573, 0, 57516, 0, 77394, 0, 108631, 0, 132054,
+        0, 161613, 0, 191827, 0, 228952, 0, 251470, 0, 264614, 0, 280045,
+        0, 315143, 0, 334196, 0, 343475, 0, 364737, 0, 379167, 1, 12528,
+        1, 44379, 1, 80949, 1, 98447, 1, 129889, 1, 158881, 1, 193186,
+        1, 226399, 1, 254106, 1, 294328, 1, 330580, 1, 360214, 2, 12528,
+        2, 21185, 2, 41983, 2, 71501, 2, 101927, 2, 112497, 2, 151546,
+        2, 188969, 2, 220443, 2, 257265, 2, 285492, 2, 299543, 2, 326890,
+        2, 342471, 2, 363011,
+    };
+
+    static const uint32_t BASELINE_DROPOUTS_6[] =
+    {
+        0, 12528, 0, 29212, 0, 65219, 0, 92373, 0, 118913, 0, 145614,
+        0, 167796, 0, 186731, 0, 224719, 0, 250869, 0, 266620, 0, 304174,
+        0, 334347, 0, 346373, 0, 366486, 1, 12528, 1, 31234, 1, 52685,
+        1, 78671, 1, 104201, 1, 136479, 1, 163405, 1, 184120, 1, 211477,
+        1, 239714, 1, 278561, 1, 291918, 1, 298972, 1, 330147, 1, 346208,
+        1, 368753, 2, 12528, 2, 46440, 2, 65304, 2, 104530, 2, 130265,
+        2, 144109, 2, 175780, 2, 200707, 2, 233047, 2, 253770, 2, 277314,
+        2, 303660, 2, 327202, 2, 361918, 2, 373930, 3, 12528, 3, 47249,
+        3, 74336, 3, 87183, 3, 111907, 3, 131322, 3, 168955, 3, 196879,
+        3, 232984, 3, 255799, 3, 278438, 3, 304589, 3, 329006, 3, 343260,
+        3, 365622, 4, 12526, 4, 49271, 4, 74986, 4, 99852, 4, 124779,
+        4, 164168, 4, 192146, 4, 224282, 4, 249758, 4, 275873, 4, 297607,
+        4, 312747, 4, 338037, 4, 357047, 4, 376575, 5, 12520, 5, 37237,
+        5, 60934, 5, 84859, 5, 105816, 5, 114537, 5, 150887, 5, 180129,
+        5, 197517, 5, 203947, 5, 232075, 5, 260671, 5, 283221, 5, 313099,
+        5, 333261, 5, 350120, 5, 375814, 5, 381923,
+    };
+
+    static const uint32_t BASELINE_DROPOUTS_8[] =
+    {
+        0, 12528, 0, 53251, 0, 88536, 0, 124185, 0, 154414, 0, 183179,
+        0, 197972, 0, 228419, 0, 244478, 0, 259862, 0, 279432, 0, 300709,
+        0, 316379, 0, 338192, 0, 354743, 0, 379289, 1, 12528, 1, 30050,
+        1, 49571, 1, 84054, 1, 90487, 1, 100824, 1, 120372, 1, 153805,
+        1, 183245, 1, 200713, 1, 239237, 1, 255777, 1, 279920, 1, 293634,
+        1, 312496, 1, 327864, 1, 345739, 1, 361706, 1, 381575, 2, 12528,
+        2, 32082, 2, 49005, 2, 71509, 2, 91325, 2, 107237, 2, 131532,
+        2, 145179, 2, 178384, 2, 212339, 2, 239685, 2, 273764, 2, 292398,
+        2, 321293, 2, 345355, 2, 381319, 3, 12524, 3, 34104, 3, 60473,
+        3, 81812, 3, 101840, 3, 137716, 3, 167972, 3, 209620, 3, 221663,
+        3, 246895, 3, 269955, 3, 289463, 3, 321900, 3, 341912, 3, 372192,
+        4, 12525, 4, 34911, 4, 59907, 4, 78865, 4, 97883, 4, 115328,
+        4, 150331, 4, 171181, 4, 198744, 4, 228487, 4, 254036, 4, 275684,
+        4, 296066, 4, 308039, 4, 338404, 4, 360563, 4, 377196, 5, 12525,
+        5, 35718, 5, 44940, 5, 77134, 5, 96357, 5, 119378, 5, 159123,
+        5, 184187, 5, 215511, 5, 246133, 5, 255159, 5, 291010, 5, 314698,
+        5, 345830, 5, 373358, 6, 12525, 6, 52141, 6, 83991, 6, 113805,
+        6, 132018, 6, 160609, 6, 166695, 6, 194762, 6, 215451, 6, 239771,
+        6, 271897, 6, 282336, 6, 306899, 6, 341570, 6, 365047, 7, 12526,
+        7, 30163, 7, 47454, 7, 65291, 7, 83708, 7, 93871, 7, 105923,
+        7, 138199, 7, 162660, 7, 189068, 7, 220285, 7, 244930, 7, 270365,
+        7, 284576, 7, 318403, 7, 346302, 7, 375007,
+    };
+
+    #define BASELINE(name, events)  { name, events, sizeof(events) / (2 * sizeof(uint32_t)) }
+
+    static const baseline_t BASELINES[] =
+    {
+        BASELINE("dropouts/1",  BASELINE_DROPOUTS_1),
+        BASELINE("dropouts/2",  BASELINE_DROPOUTS_2),
+        BASELINE("dropouts/3",  BASELINE_DROPOUTS_3),
+        BASELINE("dropouts/6",  BASELINE_DROPOUTS_6),
+        BASELINE("dropouts/8",  BASELINE_DROPOUTS_8),
+        { "clicks/2",   NULL,   0 },
+        { "clicks/6",   NULL,   0 },
+    };
+
+    #undef BASELINE
+}
+
+/**
+ * Regression suite for optimized processing paths: each input of the corpus is processed by
+ * the reference engine (fixed block size) and by alternative engines (different block sizes
+ * and random split points), the logged events should be the same. Dropout events of the
+ * synthetic inputs should also match the events frozen from the plain scalar detector
+ */
+UTEST_BEGIN("damage_detector", golden)
+
+    static constexpr size_t SAMPLE_RATE     = 48000;
+    static constexpr size_t LENGTH          = SAMPLE_RATE * 8;
+    static constexpr size_t MAX_CHANNELS    = 8;
+    static constexpr size_t REF_BLOCK_SIZE  = 0x400;
+    static constexpr size_t MAX_SPLIT_SIZE  = 0x1000;
+    static constexpr size_t MAX_RECORDS     = dd::EventJournal::DFL_CAPACITY;
+
+    // Tolerances of the comparison: the envelope of digital silence holds the rounding residue
+    // of the sidechain while constant blocks give the exact zero, so levels are compared above
+    // the floor only
+    static constexpr float  VALUE_TOLERANCE = 0.01f;    // Dropout depth, flatline level and click ratio, dB
+    static constexpr float  VALUE_FLOOR     = -80.0f;   // Lower bound of compared levels, dB
+
+    typedef struct input_t
+    {
+        char                sName[64];      // Name of the input
+        size_t              nChannels;      // Number of channels
+        size_t              nSampleRate;    // Sample rate
+        size_t              nLength;        // Length in samples
+        float              *vData;          // Planar data, nLength samples per channel
+        bool                bLinked;        // Process adjacent channels as linked pairs
+    } input_t;
+
+    typedef struct engine_t
+    {
+        const char         *sName;          // Name of the engine
+        size_t              nBlockSize;     // Block size, 0 for random split points
+        uint32_t            nSeed;          // Seed of random split points
+    } engine_t;
+
+    typedef struct result_t
+    {
+        dd::journal_record_t    vRecords[MAX_RECORDS];
+        size_t                  nRecords;
+        uint64_t                nTotal;     // Total number of events
+        size_t                  vCount[MAX_CHANNELS];   // Number of events for the estimation time
+    } result_t;
+
+    static uint32_t next_random(uint32_t *seed)
+    {
+        *seed           = *seed * 1664525u + 1013904223u;
+        return *seed >> 8;
+    }
+
+    static int compare_records(const void *a, const void *b)
+    {
+        const dd::journal_record_t *ra = static_cast<const dd::journal_record_t *>(a);
+        const dd::journal_record_t *rb = static_cast<const dd::journal_record_t *>(b);
+
+        if (ra->nType != rb->nType)
+            return (ra->nType < rb->nType) ? -1 : 1;
+        if (ra->nChannel != rb->nChannel)
+            return (ra->nChannel < rb->nChannel) ? -1 : 1;
+        if (ra->nStart != rb->nStart)
+            return (ra->nStart < rb->nStart) ? -1 : 1;
+        if (ra->nEnd != rb->nEnd)
+            return (ra->nEnd < rb->nEnd) ? -1 : 1;
+        return 0;
+    }
+
+    // Sine with pauses of random length at random positions
+    static void gen_dropouts(float *dst, size_t length, uint32_t seed)
+    {
+        const float freq    = 200.0f + (next_random(&seed) % 1000);
+        for (size_t i=0; i<length; ++i)
+            dst[i]              = 0.5f * sinf(2.0f * M_PI * freq * i / SAMPLE_RATE);
+
+        for (size_t pos = SAMPLE_RATE / 4; pos < length; )
+        {
+            const size_t pause  = lsp::lsp_min(SAMPLE_RATE / 200 + next_random(&seed) % (SAMPLE_RATE * 3 / 10), length - pos);
+            lsp::dsp::fill_zero(&dst[pos], pause);
+            pos                += pause + SAMPLE_RATE / 10 + next_random(&seed) % (SAMPLE_RATE / 2);
+        }
+    }
+
+    // Noise with the level fluctuating around the threshold
+    static void gen_chatter(float *dst, size_t length, uint32_t seed)
+    {
+        for (size_t pos = 0; pos < length; )
+        {
+            const size_t count  = lsp::lsp_min(SAMPLE_RATE / 50 + next_random(&seed) % (SAMPLE_RATE / 10), length - pos);
+            const float level   = -43.0f + (next_random(&seed) % 600) * 0.01f;
+            const float amp     = sqrtf(3.0f) * expf(level * M_LN10 / 20.0f);
+            for (size_t i=0; i<count; ++i)
+                dst[pos + i]        = amp * ((next_random(&seed) % 20001) * 0.0001f - 1.0f);
+            pos                += count;
+        }
+    }
+
+    // Sine with clicks, a constant signal and digital silence
+    static void gen_clicks(float *dst, size_t length, uint32_t seed)
+    {
+        for (size_t i=0; i<length; ++i)
+            dst[i]              = 0.5f * sinf(2.0f * M_PI * 1000.0f * i / SAMPLE_RATE);
+
+        for (size_t pos = SAMPLE_RATE / 2; pos < length; pos += SAMPLE_RATE / 20 + next_random(&seed) % (SAMPLE_RATE / 5))
+            dst[pos]           += ((next_random(&seed) & 1) ? 0.3f : -0.3f);
+
+        lsp::dsp::fill(&dst[SAMPLE_RATE * 2], 0.25f, SAMPLE_RATE * 3 / 2);
+        lsp::dsp::fill_zero(&dst[SAMPLE_RATE * 5], SAMPLE_RATE * 2);
+    }
+
+    // Sine common for all channels, inverted or muted in random segments of each channel
+    static void gen_linked(float *dst, size_t length, uint32_t seed)
+    {
+        for (size_t i=0; i<length; ++i)
+            dst[i]              = 0.5f * sinf(2.0f * M_PI * 500.0f * i / SAMPLE_RATE);
+
+        for (size_t pos = SAMPLE_RATE / 2; pos < length; )
+        {
+            const size_t count  = lsp::lsp_min(SAMPLE_RATE / 20 + next_random(&seed) % (SAMPLE_RATE / 5), length - pos);
+            if (next_random(&seed) & 1)
+            {
+                for (size_t i=0; i<count; ++i)
+                    dst[pos + i]        = -dst[pos + i];
+            }
+            else
+                lsp::dsp::fill_zero(&dst[pos], count);
+            pos                += count + SAMPLE_RATE / 2 + next_random(&seed) % SAMPLE_RATE;
+        }
+    }
+
+    bool add_synthetic(input_t *in, const char *name, size_t channels, uint32_t seed,
+        void (*gen)(float *dst, size_t length, uint32_t seed), bool linked = false)
+    {
+        snprintf(in->sName, sizeof(in->sName), "%s/%d%s", name, int(channels), (linked) ? "/linked" : "");
+        in->bLinked         = linked;
+        in->nChannels       = channels;
+        in->nSampleRate     = SAMPLE_RATE;
+        in->nLength         = LENGTH;
+        in->vData           = static_cast<float *>(malloc(channels * LENGTH * sizeof(float)));
+        if (in->vData == NULL)
+            return false;
+
+        for (size_t i=0; i<channels; ++i)
+            gen(&in->vData[i * LENGTH], LENGTH, seed + i * 7919);
+        return true;
+    }
+
+    bool add_recorded(input_t *in, const char *name)
+    {
+        lsp::io::Path path;
+        lsp::dspu::Sample sample;
+        if ((path.fmt("%s/%s", resources(), name) <= 0) || (sample.load(&path) != lsp::STATUS_OK))
+            return false;
+        if ((sample.channels() <= 0) || (sample.channels() > MAX_CHANNELS))
+            return false;
+
+        snprintf(in->sName, sizeof(in->sName), "%s", name);
+        in->bLinked         = false;
+        in->nChannels       = sample.channels();
+        in->nSampleRate     = sample.sample_rate();
+        in->nLength         = sample.length();
+        in->vData           = static_cast<float *>(malloc(in->nChannels * in->nLength * sizeof(float)));
+        if (in->vData == NULL)
+            return false;
+
+        for (size_t i=0; i<in->nChannels; ++i)
+            lsp::dsp::copy(&in->vData[i * in->nLength], sample.channel(i), in->nLength);
+        return true;
+    }
+
+    void run(result_t *res, const input_t *in, const engine_t *engine, float *buf)
+    {
+        lsp::io::Path path;
+        UTEST_ASSERT(path.fmt("%s/utest-%s.ddj", tempdir(), full_name()) > 0);
+
+        dd::EventJournal journal;
+        UTEST_ASSERT(journal.open(path.as_native()) == lsp::STATUS_OK);
+
+        dd::DamageDetector dd(in->nChannels);
+        dd.set_sample_rate(in->nSampleRate);
+        dd.set_bypass(true);
+        dd.set_threshold(-40.0f);
+        dd.set_click_detection(true);
+        dd.set_flatline_time(0.5f);
+        dd.set_linked(in->bLinked);
+        dd.set_journal(&journal);
+
+        // The detector processes data in place
+        lsp::dsp::copy(buf, in->vData, in->nChannels * in->nLength);
+
+        uint32_t seed       = engine->nSeed;
+        for (size_t offset=0; offset < in->nLength; )
+        {
+            const size_t block  = (engine->nBlockSize > 0) ? engine->nBlockSize : 1 + next_random(&seed) % MAX_SPLIT_SIZE;
+            const size_t to_do  = lsp::lsp_min(in->nLength - offset, block);
+            for (size_t i=0; i<in->nChannels; ++i)
+            {
+                float *ptr          = &buf[i * in->nLength + offset];
+                dd.bind_input(i, ptr);
+                dd.bind_output(i, ptr);
+            }
+            dd.process(to_do);
+            offset             += to_do;
+        }
+
+        res->nTotal         = dd.total_events();
+        for (size_t i=0; i<in->nChannels; ++i)
+            res->vCount[i]      = dd.events_count(i);
+
+        dd.set_journal(NULL);
+        UTEST_ASSERT(journal.close() == lsp::STATUS_OK);
+
+        // Read records back, the order of records of different channels depends on the block size
+        FILE *fd            = fopen(path.as_native(), "rb");
+        UTEST_ASSERT(fd != NULL);
+        lsp_finally {
+            fclose(fd);
+            remove(path.as_native());
+        };
+
+        dd::journal_header_t hdr;
+        UTEST_ASSERT(fread(&hdr, sizeof(hdr), 1, fd) == 1);
+        res->nRecords       = fread(res->vRecords, sizeof(dd::journal_record_t), MAX_RECORDS, fd);
+        UTEST_ASSERT(res->nRecords < MAX_RECORDS);
+        for (size_t i=0; i<res->nRecords; ++i)
+            UTEST_ASSERT(res->vRecords[i].nType != dd::JR_OVERFLOW);
+
+        qsort(res->vRecords, res->nRecords, sizeof(dd::journal_record_t), compare_records);
+    }
+
+    void compare(const input_t *in, const engine_t *engine, const result_t *ref, const result_t *res)
+    {
+        printf("  %-32s: records=%d, events=%d\n", engine->sName, int(res->nRecords), int(res->nTotal));
+
+        UTEST_ASSERT_MSG(res->nTotal == ref->nTotal,
+            "%s, %s: total events %d, expected %d\n", in->sName, engine->sName, int(res->nTotal), int(ref->nTotal));
+        UTEST_ASSERT_MSG(res->nRecords == ref->nRecords,
+            "%s, %s: %d records, expected %d\n", in->sName, engine->sName, int(res->nRecords), int(ref->nRecords));
+        for (size_t i=0; i<in->nChannels; ++i)
+            UTEST_ASSERT_MSG(res->vCount[i] == ref->vCount[i],
+                "%s, %s: %d events of channel %d, expected %d\n",
+                in->sName, engine->sName, int(res->vCount[i]), int(i), int(ref->vCount[i]));
+
+        for (size_t i=0; i<ref->nRecords; ++i)
+        {
+            const dd::journal_record_t *a = &ref->vRecords[i];
+            const dd::journal_record_t *b = &res->vRecords[i];
+            const float va          = lsp::lsp_max(a->fValue, VALUE_FLOOR);
+            const float vb          = lsp::lsp_max(b->fValue, VALUE_FLOOR);
+
+            UTEST_ASSERT_MSG(
+                (a->nType == b->nType) && (a->nChannel == b->nChannel) &&
+                (a->nStart == b->nStart) && (a->nEnd == b->nEnd) &&
+                (fabsf(va - vb) <= VALUE_TOLERANCE),
+                "%s, %s: record %d is type=%d channel=%d start=%llu end=%llu value=%f, "
+                "expected type=%d channel=%d start=%llu end=%llu value=%f\n",
+                in->sName, engine->sName, int(i),
+                int(b->nType), int(b->nChannel), (unsigned long long)(b->nStart), (unsigned long long)(b->nEnd), b->fValue,
+                int(a->nType), int(a->nChannel), (unsigned long long)(a->nStart), (unsigned long long)(a->nEnd), a->fValue);
+        }
+    }
+
+    void check_baseline(const input_t *in, const engine_t *engine, const result_t *res)
+    {
+        const baseline_t *base  = NULL;
+        for (size_t i=0; i<sizeof(BASELINES)/sizeof(BASELINES[0]); ++i)
+            if (!strcmp(BASELINES[i].sName, in->sName))
+                base                    = &BASELINES[i];
+        if (base == NULL)
+            return;
+
+        // Records are sorted by type, channel and time, the end of the dropout record is the time of the event
+        size_t count            = 0;
+        for (size_t i=0; i<res->nRecords; ++i)
+        {
+            const dd::journal_record_t *r = &res->vRecords[i];
+            if (r->nType != dd::JR_DROPOUT)
+                continue;
+
+            UTEST_ASSERT_MSG(count < base->nEvents,
+                "%s, %s: unexpected dropout channel=%d time=%llu\n",
+                in->sName, engine->sName, int(r->nChannel), (unsigned long long)(r->nEnd));
+
+            const uint32_t *ev      = &base->vEvents[count * 2];
+            const dd::timestamp_t delta = (r->nEnd > ev[1]) ? r->nEnd - ev[1] : ev[1] - r->nEnd;
+            UTEST_ASSERT_MSG((r->nChannel == ev[0]) && (delta <= BASELINE_TOLERANCE),
+                "%s, %s: dropout %d is channel=%d time=%llu, expected channel=%d time=%d\n",
+                in->sName, engine->sName, int(count),
+                int(r->nChannel), (unsigned long long)(r->nEnd), int(ev[0]), int(ev[1]));
+            ++count;
+        }
+
+        UTEST_ASSERT_MSG(count == base->nEvents,
+            "%s, %s: %d dropouts, expected %d\n", in->sName, engine->sName, int(count), int(base->nEvents));
+    }
+
+    UTEST_MAIN
+    {
+        static const engine_t reference = { "reference", REF_BLOCK_SIZE, 0 };
+        static const engine_t engines[] =
+        {
+            { "block=1",                    1,          0 },
+            { "block=7",                    7,          0 },
+            { "block=64",                   64,         0 },
+            { "block=333",                  333,        0 },
+            { "block=1000",                 1000,       0 },
+            { "block=4096",                 0x1000,     0 },
+            { "block=4097",                 0x1001,     0 },
+            { "block=65536",                0x10000,    0 },
+            { "random split 1",             0,          1 },
+            { "random split 2",             0,          2 },
+            { "random split 3",             0,          3 },
+        };
+
+        // Corpus of inputs
+        input_t inputs[16];
+        size_t count    = 0;
+        lsp_finally {
+            for (size_t i=0; i<count; ++i)
+                free(inputs[i].vData);
+        };
+
+        UTEST_ASSERT(add_synthetic(&inputs[count++], "dropouts", 1, 1, gen_dropouts));
+        UTEST_ASSERT(add_synthetic(&inputs[count++], "dropouts", 2, 2, gen_dropouts));
+        UTEST_ASSERT(add_synthetic(&inputs[count++], "dropouts", 3, 3, gen_dropouts));
+        UTEST_ASSERT(add_synthetic(&inputs[count++], "dropouts", 6, 4, gen_dropouts));
+        UTEST_ASSERT(add_synthetic(&inputs[count++], "dropouts", 8, 5, gen_dropouts));
+        UTEST_ASSERT(add_synthetic(&inputs[count++], "chatter", 1, 6, gen_chatter));
+        UTEST_ASSERT(add_synthetic(&inputs[count++], "chatter", 2, 7, gen_chatter));
+        UTEST_ASSERT(add_synthetic(&inputs[count++], "clicks", 2, 8, gen_clicks));
+        UTEST_ASSERT(add_synthetic(&inputs[count++], "clicks", 6, 9, gen_clicks));
+        UTEST_ASSERT(add_synthetic(&inputs[count++], "dropouts", 2, 10, gen_dropouts, true));
+        UTEST_ASSERT(add_synthetic(&inputs[count++], "linked", 2, 11, gen_linked, true));
+        UTEST_ASSERT(add_synthetic(&inputs[count++], "linked", 5, 12, gen_linked, true));
+        if (add_recorded(&inputs[count], "input.wav"))
+            ++count;
+        else
+            printf("Recorded input is not available, skipping\n");
+
+        size_t max_length = 0;
+        for (size_t i=0; i<count; ++i)
+            max_length      = lsp::lsp_max(max_length, inputs[i].nChannels * inputs[i].nLength);
+
+        float *buf      = static_cast<float *>(malloc(max_length * sizeof(float)));
+        result_t *ref   = static_cast<result_t *>(malloc(sizeof(result_t)));
+        result_t *res   = static_cast<result_t *>(malloc(sizeof(result_t)));
+        lsp_finally {
+            free(buf);
+            free(ref);
+            free(res);
+        };
+        UTEST_ASSERT((buf != NULL) && (ref != NULL) && (res != NULL));
+
+        for (size_t i=0; i<count; ++i)
+        {
+            const input_t *in   = &inputs[i];
+            run(ref, in, &reference, buf);
+            printf("%s: records=%d, events=%d\n", in->sName, int(ref->nRecords), int(ref->nTotal));
+            UTEST_ASSERT_MSG(ref->nRecords > 0, "%s: no events detected\n", in->sName);
+            check_baseline(in, &reference, ref);
+
+            for (size_t j=0; j<sizeof(engines)/sizeof(engines[0]); ++j)
+            {
+                run(res, in, &engines[j], buf);
+                compare(in, &engines[j], ref, res);
+                check_baseline(in, &engines[j], res);
+            }
+        }
+    }
+
+UTEST_END
@@ -0,0 +1,90 @@
+/*
+ * Copyright (C) 2024 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2024 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of damage-detector
+ * Created on: 18 окт. 2026 г.
+ *
+ * damage-detector is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * damage-detector is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with damage-detector. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <lsp-plug.in/test-fw/utest.h>
+#include <lsp-plug.in/common/alloc.h>
+#include <lsp-plug.in/common/finally.h>
+#include <lsp-plug.in/dsp/dsp.h>
+#include <lsp-plug.in/stdlib/math.h>
+
+#include <private/DamageDetector.h>
+
+UTEST_BEGIN("damage_detector", hysteresis)
+
+    static constexpr size_t SAMPLE_RATE = 48000;
+    static constexpr size_t LENGTH      = SAMPLE_RATE * 5;
+    static constexpr size_t BLOCK_SIZE  = 0x400;
+
+    size_t process(const float *src, float *buf, float hysteresis, float close_debounce)
+    {
+        lsp::dsp::copy(buf, src, LENGTH);
+
+        dd::DamageDetector dd(1);
+        dd.set_sample_rate(SAMPLE_RATE);
+        dd.set_bypass(true);
+        dd.set_threshold(-40.0f);
+        dd.set_hysteresis(hysteresis);
+        dd.set_close_debounce(close_debounce);
+
+        for (size_t offset=0; offset < LENGTH; offset += BLOCK_SIZE)
+        {
+            const size_t to_do  = lsp::lsp_min(LENGTH - offset, BLOCK_SIZE);
+            dd.bind_input(0, &buf[offset]);
+            dd.bind_output(0, &buf[offset]);
+            dd.process(to_do);
+        }
+
+        return dd.total_events();
+    }
+
+    UTEST_MAIN
+    {
+        uint8_t *data   = NULL;
+        float *src      = lsp::alloc_aligned<float>(data, LENGTH * 2, 64);
+        float *buf      = &src[LENGTH];
+        lsp_finally { lsp::free_aligned(data); };
+
+        // The RMS level of the programme alternates between -38 and -42 dB every 50 ms,
+        // the real 200 ms dropout happens shortly after the pause in the programme
+        const float hi  = M_SQRT2 * expf(-38.0f * M_LN10 / 20.0f);
+        const float lo  = M_SQRT2 * expf(-42.0f * M_LN10 / 20.0f);
+        for (size_t i=0; i<LENGTH; ++i)
+        {
+            const float amp     = ((i / (SAMPLE_RATE / 20)) & 1) ? lo : hi;
+            src[i]              = amp * sinf(2.0f * M_PI * 440.0f * i / SAMPLE_RATE);
+        }
+        lsp::dsp::fill_zero(&src[SAMPLE_RATE * 3], (SAMPLE_RATE * 3) / 10);
+        lsp::dsp::fill_zero(&src[(SAMPLE_RATE * 38) / 10], SAMPLE_RATE / 5);
+
+        // The single threshold chatters, the hysteresis and the close debounce
+        // reject fluctuations but keep the real dropout
+        const size_t chatter    = process(src, buf, 0.0f, -1.0f);
+        const size_t hyst       = process(src, buf, 6.0f, -1.0f);
+        const size_t debounce   = process(src, buf, 0.0f, 100.0f);
+
+        printf("Events: single threshold=%d, hysteresis=%d, debounce=%d\n", int(chatter), int(hyst), int(debounce));
+        UTEST_ASSERT(chatter > 10);
+        UTEST_ASSERT(hyst == 1);
+        UTEST_ASSERT(debounce == 1);
+    }
+
+UTEST_END
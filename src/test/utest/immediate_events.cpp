@@ -0,0 +1,146 @@
+/*
+ * Copyright (C) 2024 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2024 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of damage-detector
+ * Created on: 18 окт. 2026 г.
+ *
+ * damage-detector is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * damage-detector is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with damage-detector. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <lsp-plug.in/test-fw/utest.h>
+#include <lsp-plug.in/common/alloc.h>
+#include <lsp-plug.in/common/finally.h>
+#include <lsp-plug.in/dsp/dsp.h>
+#include <lsp-plug.in/stdlib/math.h>
+
+#include <private/DamageDetector.h>
+
+UTEST_BEGIN("damage_detector", immediate_events)
+
+    static constexpr size_t SAMPLE_RATE = 48000;
+    static constexpr size_t LENGTH      = SAMPLE_RATE * 6;
+    static constexpr size_t THRESHOLD   = 3;
+
+    class Listener: public dd::IEventListener
+    {
+        public:
+            dd::timestamp_t     nAbove;
+            dd::timestamp_t     nBelow;
+            size_t              nCount;
+
+        public:
+            Listener()
+            {
+                nAbove      = 0;
+                nBelow      = 0;
+                nCount      = 0;
+            }
+
+        public:
+            virtual void on_event(const dd::notification_t *event) override
+            {
+                if (event->enType == dd::EVENT_ABOVE)
+                {
+                    if (nAbove == 0)
+                        nAbove      = event->nTimestamp;
+                }
+                else if (nBelow == 0)
+                    nBelow      = event->nTimestamp;
+                ++nCount;
+            }
+    };
+
+    void configure(dd::DamageDetector *dd)
+    {
+        dd->set_sample_rate(SAMPLE_RATE);
+        dd->set_bypass(true);
+        dd->set_detect_time(dd::DamageDetector::MAX_DETECT_TIME);
+        dd->set_estimation_time(dd::DamageDetector::MIN_ESTIMATE_TIME);
+        dd->set_event_threshold(THRESHOLD);
+        dd->set_event_period(dd::DamageDetector::MAX_EV_PERIOD);
+    }
+
+    /**
+     * Process the signal, return the timestamp at which the first notification
+     * about the corrupted stream has been received, 0 if there was no notification
+     */
+    dd::timestamp_t process(const float *src, float *buf, size_t block, Listener *listener)
+    {
+        lsp::dsp::copy(buf, src, LENGTH);
+
+        dd::DamageDetector dd(1);
+        configure(&dd);
+        dd.set_event_listener(listener);
+
+        dd::timestamp_t ts  = 0;
+        for (size_t offset=0; offset < LENGTH; offset += block)
+        {
+            const size_t to_do  = lsp::lsp_min(LENGTH - offset, block);
+            dd.bind_input(0, &buf[offset]);
+            dd.bind_output(0, &buf[offset]);
+            dd.process(to_do);
+
+            if ((ts == 0) && (dd.poll_event() == dd::EVENT_ABOVE))
+                ts                  = dd.timestamp();
+        }
+
+        return (listener != NULL) ? listener->nAbove : ts;
+    }
+
+    UTEST_MAIN
+    {
+        static const size_t blocks[] = { 1, 17, 64, 0x400, 0x1000, SAMPLE_RATE };
+
+        uint8_t *data   = NULL;
+        float *src      = lsp::alloc_aligned<float>(data, LENGTH * 2, 64);
+        float *buf      = &src[LENGTH];
+        lsp_finally { lsp::free_aligned(data); };
+
+        // Burst of 50 ms dropouts every 200 ms during the first second, clean signal after
+        for (size_t i=0; i<LENGTH; ++i)
+        {
+            const size_t pos    = i % (SAMPLE_RATE / 5);
+            src[i]              = ((i < SAMPLE_RATE) && (pos >= SAMPLE_RATE / 10) && (pos < SAMPLE_RATE / 10 + SAMPLE_RATE / 20)) ?
+                                  0.0f : 0.5f * sinf(i * 0.05f);
+        }
+
+        // Immediate delivery reports the exact sample regardless of the block size,
+        // polling at the end of the block delays the notification up to the block size
+        Listener ref;
+        const dd::timestamp_t exact = process(src, buf, 1, &ref);
+        UTEST_ASSERT(exact > 0);
+
+        for (size_t i=0; i<sizeof(blocks)/sizeof(blocks[0]); ++i)
+        {
+            const size_t block  = blocks[i];
+
+            Listener listener;
+            const dd::timestamp_t push  = process(src, buf, block, &listener);
+            const dd::timestamp_t pull  = process(src, buf, block, NULL);
+
+            printf("block=%d: immediate delay=%d, polling delay=%d samples\n",
+                int(block), int(push - exact), (pull > 0) ? int(pull - exact) : -1);
+
+            UTEST_ASSERT_MSG(push == exact, "Immediate notification at %d, expected %d\n", int(push), int(exact));
+            UTEST_ASSERT_MSG(listener.nBelow > push, "Missing the notification about the recovered stream\n");
+            UTEST_ASSERT(listener.nCount == 2);
+
+            UTEST_ASSERT_MSG((pull > exact) && (pull <= exact + block),
+                "Polled notification at %d, expected within (%d, %d]\n", int(pull), int(exact), int(exact + block));
+        }
+    }
+
+UTEST_END
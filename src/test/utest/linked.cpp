@@ -0,0 +1,129 @@
+/*
+ * Copyright (C) 2024 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2024 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of damage-detector
+ * Created on: 18 окт. 2026 г.
+ *
+ * damage-detector is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * damage-detector is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with damage-detector. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <lsp-plug.in/test-fw/utest.h>
+#include <lsp-plug.in/common/alloc.h>
+#include <lsp-plug.in/common/finally.h>
+#include <lsp-plug.in/stdlib/math.h>
+
+#include <private/DamageDetector.h>
+
+UTEST_BEGIN("damage_detector", linked)
+
+    static constexpr size_t SAMPLE_RATE = 48000;
+    static constexpr size_t LENGTH      = SAMPLE_RATE * 4;
+    static constexpr size_t BLOCK_SIZE  = 0x200;
+
+    static bool inside(size_t i, float start, float end)
+    {
+        return (i >= size_t(start * SAMPLE_RATE)) && (i < size_t(end * SAMPLE_RATE));
+    }
+
+    void process(dd::DamageDetector *dd, float *l, float *r, size_t channels,
+        size_t block = BLOCK_SIZE, float reactivity = dd::DamageDetector::DFL_REACTIVITY)
+    {
+        dd->set_sample_rate(SAMPLE_RATE);
+        dd->set_reactivity(reactivity);
+        dd->set_detect_time(dd::DamageDetector::MAX_DETECT_TIME);
+        dd->set_estimation_time(dd::DamageDetector::MAX_ESTIMATE_TIME);
+        dd->set_linked(true);
+
+        for (size_t offset=0; offset < LENGTH; offset += block)
+        {
+            const size_t to_do  = lsp::lsp_min(LENGTH - offset, block);
+            for (size_t j=0; j<channels; ++j)
+            {
+                float *buf          = (j & 1) ? r : l;
+                dd->bind_input(j, &buf[offset]);
+                dd->bind_output(j, &buf[offset]);
+            }
+            dd->process(to_do);
+        }
+    }
+
+    UTEST_MAIN
+    {
+        uint8_t *data   = NULL;
+        float *buf      = lsp::alloc_aligned<float>(data, LENGTH * 2, 64);
+        lsp_finally { lsp::free_aligned(data); };
+        float *l        = buf;
+        float *r        = &buf[LENGTH];
+
+        // Clean correlated stereo signal does not generate events
+        for (size_t i=0; i<LENGTH; ++i)
+        {
+            l[i]            = 0.5f * sinf(i * 0.05f);
+            r[i]            = 0.4f * sinf(i * 0.05f + 0.3f);
+        }
+        {
+            dd::DamageDetector dd(2);
+            process(&dd, l, r, 2);
+            UTEST_ASSERT_MSG(dd.total_events() == 0, "Detected %d events in clean signal\n", int(dd.total_events()));
+        }
+
+        // Dropout of both channels, dropout of the right channel and the phase flip of the right channel
+        for (size_t i=0; i<LENGTH; ++i)
+        {
+            const float s   = 0.5f * sinf(i * 0.05f);
+            l[i]            = (inside(i, 0.5f, 0.55f)) ? 0.0f : s;
+            r[i]            = (inside(i, 0.5f, 0.55f) || inside(i, 1.5f, 1.55f)) ? 0.0f :
+                              (inside(i, 2.5f, 2.7f)) ? -s : s;
+        }
+
+        dd::DamageDetector dd(2);
+        process(&dd, l, r, 2);
+
+        // The mid envelope drops for the dropout of both channels and for the phase flip, but the flip
+        // is counted only once as the event of the right channel, as well as the drop of one channel
+        UTEST_ASSERT_MSG(dd.events_count(0) == 1, "Detected %d events of the mid signal\n", int(dd.events_count(0)));
+        UTEST_ASSERT_MSG(dd.events_count(1) == 2, "Detected %d events of the right channel\n", int(dd.events_count(1)));
+
+        // The odd channel is processed independently
+        dd::DamageDetector dd3(3);
+        process(&dd3, l, r, 3);
+        UTEST_ASSERT(dd3.events_count(0) == 1);
+        UTEST_ASSERT(dd3.events_count(1) == 2);
+        UTEST_ASSERT(dd3.events_count(2) == 1);
+
+        // Single phase flip is counted once whether the mid envelope drops before or after
+        // the flip is detected from the correlation of channels
+        for (size_t i=0; i<LENGTH; ++i)
+        {
+            const float s   = 0.5f * sinf(i * 0.05f);
+            l[i]            = s;
+            r[i]            = (inside(i, 2.5f, 2.7f)) ? -s : s;
+        }
+
+        static const size_t blocks[]    = { 16, BLOCK_SIZE };
+        static const float reactivity[] = { 2.0f, dd::DamageDetector::DFL_REACTIVITY, 20.0f };
+        for (size_t i=0; i<sizeof(blocks)/sizeof(size_t); ++i)
+            for (size_t j=0; j<sizeof(reactivity)/sizeof(float); ++j)
+            {
+                dd::DamageDetector flip(2);
+                process(&flip, l, r, 2, blocks[i], reactivity[j]);
+                printf("Block %d, reactivity %.1f ms: %d events of the mid signal, %d events of the right channel\n",
+                    int(blocks[i]), reactivity[j], int(flip.events_count(0)), int(flip.events_count(1)));
+                UTEST_ASSERT_MSG(flip.total_events() == 1, "Detected %d events for the phase flip\n", int(flip.total_events()));
+            }
+    }
+
+UTEST_END
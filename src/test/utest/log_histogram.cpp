@@ -0,0 +1,171 @@
+/*
+ * Copyright (C) 2024 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2024 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of damage-detector
+ * Created on: 18 окт. 2026 г.
+ *
+ * damage-detector is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * damage-detector is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with damage-detector. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <lsp-plug.in/test-fw/utest.h>
+#include <lsp-plug.in/common/alloc.h>
+#include <lsp-plug.in/common/finally.h>
+#include <lsp-plug.in/dsp/dsp.h>
+#include <lsp-plug.in/stdlib/math.h>
+
+#include <private/DamageDetector.h>
+#include <private/LogHistogram.h>
+
+UTEST_BEGIN("damage_detector", log_histogram)
+
+    static constexpr size_t SAMPLE_RATE = 48000;
+    static constexpr size_t LENGTH      = SAMPLE_RATE * 5 / 2;
+    static constexpr size_t BLOCK_SIZE  = 0x400;
+
+    void test_mapping()
+    {
+        printf("Testing bucket mapping\n");
+
+        // Small values are stored exactly
+        for (size_t i=0; i<dd::LogHistogram::SUB_BUCKETS; ++i)
+        {
+            UTEST_ASSERT(dd::LogHistogram::index(i) == i);
+            UTEST_ASSERT(dd::LogHistogram::lower_bound(i) == i);
+        }
+
+        // Each octave is split into SUB_BUCKETS linear buckets
+        UTEST_ASSERT(dd::LogHistogram::index(4) == 4);
+        UTEST_ASSERT(dd::LogHistogram::index(7) == 7);
+        UTEST_ASSERT(dd::LogHistogram::index(8) == 8);
+        UTEST_ASSERT(dd::LogHistogram::index(9) == 8);
+        UTEST_ASSERT(dd::LogHistogram::index(10) == 9);
+        UTEST_ASSERT(dd::LogHistogram::index(15) == 11);
+        UTEST_ASSERT(dd::LogHistogram::index(16) == 12);
+        UTEST_ASSERT(dd::LogHistogram::lower_bound(11) == 14);
+        UTEST_ASSERT(dd::LogHistogram::lower_bound(12) == 16);
+
+        // The bucket covers values from its lower bound to the lower bound of the next bucket,
+        // the relative error of the value is less than 1/SUB_BUCKETS
+        for (size_t i=0; i<dd::LogHistogram::BUCKETS - 1; ++i)
+        {
+            const uint64_t lo   = dd::LogHistogram::lower_bound(i);
+            const uint64_t hi   = dd::LogHistogram::lower_bound(i + 1);
+            UTEST_ASSERT(hi > lo);
+            UTEST_ASSERT(dd::LogHistogram::index(lo) == i);
+            UTEST_ASSERT(dd::LogHistogram::index(hi - 1) == i);
+            UTEST_ASSERT((hi - lo) * dd::LogHistogram::SUB_BUCKETS <= lo + dd::LogHistogram::SUB_BUCKETS);
+        }
+    }
+
+    void test_overflow()
+    {
+        printf("Testing values above the range\n");
+
+        // Values above the range are accounted by the last bucket
+        const size_t last   = dd::LogHistogram::BUCKETS - 1;
+        const uint64_t top  = dd::LogHistogram::lower_bound(last);
+        UTEST_ASSERT(dd::LogHistogram::index(top) == last);
+        UTEST_ASSERT(dd::LogHistogram::index(top * 2) == last);
+        UTEST_ASSERT(dd::LogHistogram::index(~uint64_t(0)) == last);
+
+        dd::LogHistogram h;
+        h.clear();
+        UTEST_ASSERT(h.total() == 0);
+        h.add(0);
+        h.add(1000);
+        h.add(1000);
+        h.add(~uint64_t(0));
+        UTEST_ASSERT(h.total() == 4);
+        UTEST_ASSERT(h.count(0) == 1);
+        UTEST_ASSERT(h.count(dd::LogHistogram::index(1000)) == 2);
+        UTEST_ASSERT(h.count(last) == 1);
+        h.clear();
+        UTEST_ASSERT(h.total() == 0);
+    }
+
+    void test_dropout(const float *src, float *buf)
+    {
+        printf("Testing histograms of the known dropout\n");
+
+        dd::DamageDetector dd(1);
+        dd.set_sample_rate(SAMPLE_RATE);
+        dd.set_bypass(true);
+        dd.set_threshold(-40.0f);
+        dd.set_close_debounce(1.0f);
+        dd.set_detect_time(dd::DamageDetector::MAX_DETECT_TIME);
+        dd.set_histogram_period(1.0f);
+
+        // Histograms are exported once per period, the export clears them
+        size_t exports      = 0;
+        uint64_t dropouts   = 0;
+        uint64_t delays     = 0;
+        uint64_t intervals  = 0;
+        for (size_t offset=0; offset < LENGTH; offset += BLOCK_SIZE)
+        {
+            const size_t to_do  = lsp::lsp_min(LENGTH - offset, BLOCK_SIZE);
+            lsp::dsp::copy(&buf[offset], &src[offset], to_do);
+            dd.bind_input(0, &buf[offset]);
+            dd.bind_output(0, &buf[offset]);
+            dd.process(to_do);
+
+            if (!dd.poll_histograms())
+                continue;
+
+            ++exports;
+            const dd::LogHistogram *dropout = dd.histogram(0, dd::HIST_DROPOUT);
+            const dd::LogHistogram *delay   = dd.histogram(0, dd::HIST_DELAY);
+            UTEST_ASSERT((dropout != NULL) && (delay != NULL));
+            UTEST_ASSERT(dd.histogram(1, dd::HIST_DROPOUT) == NULL);
+
+            if (exports == 1)
+            {
+                // The dropout of 100 ms is measured from the drop of the RMS level below the threshold
+                // to its recovery, so it is shorter by the reactivity window of 10 ms. The event is
+                // generated when the trigger closes: 1 ms of the debounce time plus one sample later
+                UTEST_ASSERT(dropout->total() == 1);
+                UTEST_ASSERT(dropout->count(dd::LogHistogram::index(90000)) == 1);
+                UTEST_ASSERT(delay->total() == 1);
+                UTEST_ASSERT(delay->count(dd::LogHistogram::index((49 * 1000000) / SAMPLE_RATE)) == 1);
+            }
+            dropouts           += dropout->total();
+            delays             += delay->total();
+            intervals          += dd.histogram(0, dd::HIST_INTERVAL)->total();
+            dd.clear_histograms();
+        }
+
+        UTEST_ASSERT(exports == LENGTH / SAMPLE_RATE);
+        UTEST_ASSERT(dropouts == 1);
+        UTEST_ASSERT(delays == 1);
+        UTEST_ASSERT(intervals == 0);
+    }
+
+    UTEST_MAIN
+    {
+        uint8_t *data   = NULL;
+        float *src      = lsp::alloc_aligned<float>(data, LENGTH * 2, 64);
+        float *buf      = &src[LENGTH];
+        lsp_finally { lsp::free_aligned(data); };
+
+        // Sine with the 100 ms dropout at 0.5 s
+        for (size_t i=0; i<LENGTH; ++i)
+            src[i]          = ((i >= SAMPLE_RATE / 2) && (i < SAMPLE_RATE / 2 + SAMPLE_RATE / 10)) ? 0.0f : 0.5f * sinf(i * 0.05f);
+
+        test_mapping();
+        test_overflow();
+        test_dropout(src, buf);
+    }
+
+UTEST_END
@@ -0,0 +1,161 @@
+/*
+ * Copyright (C) 2024 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2024 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of damage-detector
+ * Created on: 18 окт. 2026 г.
+ *
+ * damage-detector is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * damage-detector is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with damage-detector. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <lsp-plug.in/test-fw/utest.h>
+#include <lsp-plug.in/common/alloc.h>
+#include <lsp-plug.in/common/finally.h>
+#include <lsp-plug.in/dsp/dsp.h>
+#include <lsp-plug.in/stdlib/math.h>
+
+#include <private/DamageDetector.h>
+
+UTEST_BEGIN("damage_detector", rate_change)
+
+    static constexpr size_t RATE_LOW    = 44100;
+    static constexpr size_t RATE_HIGH   = 48000;
+    static constexpr size_t MAX_RATE    = RATE_HIGH;
+    static constexpr size_t BLOCK_SIZE  = 0x400;
+    static constexpr size_t THRESHOLD   = 3;
+
+    class Listener: public dd::IEventListener
+    {
+        public:
+            double              fAbove;
+            double              fBelow;
+            size_t              nCount;
+            size_t              nSampleRate;
+
+        public:
+            Listener()
+            {
+                fAbove      = -1.0;
+                fBelow      = -1.0;
+                nCount      = 0;
+                nSampleRate = RATE_LOW;
+            }
+
+        public:
+            virtual void on_event(const dd::notification_t *event) override
+            {
+                const double time   = double(event->nTimestamp) / double(nSampleRate);
+                if (event->enType == dd::EVENT_ABOVE)
+                {
+                    if (fAbove < 0.0)
+                        fAbove      = time;
+                }
+                else if (fBelow < 0.0)
+                    fBelow      = time;
+                ++nCount;
+            }
+    };
+
+    /**
+     * Process the given number of seconds of the signal at the sample rate: 50 ms dropouts
+     * every 200 ms during the first second of the stream, clean signal after
+     */
+    void process(dd::DamageDetector *dd, Listener *listener, float *buf, size_t sample_rate, double &time, size_t seconds)
+    {
+        dd->set_sample_rate(sample_rate);
+        listener->nSampleRate   = sample_rate;
+
+        const double start  = time;
+        const size_t length = seconds * sample_rate;
+        for (size_t offset=0; offset < length; )
+        {
+            const size_t to_do  = lsp::lsp_min(length - offset, BLOCK_SIZE);
+            for (size_t i=0; i<to_do; ++i)
+            {
+                const double t      = start + double(offset + i) / sample_rate;
+                const double pos    = fmod(t, 0.2);
+                buf[i]              = ((t < 1.0) && (pos >= 0.1) && (pos < 0.15)) ?
+                                      0.0f : 0.5f * sin(2.0 * M_PI * 440.0 * t);
+            }
+
+            dd->bind_input(0, buf);
+            dd->bind_output(0, buf);
+            dd->process(to_do);
+            offset             += to_do;
+        }
+
+        time                = start + seconds;
+    }
+
+    void configure(dd::DamageDetector *dd, Listener *listener)
+    {
+        dd->set_sample_rate(RATE_LOW);
+        dd->set_bypass(true);
+        dd->set_estimation_time(10.0f);
+        dd->set_event_threshold(THRESHOLD);
+        dd->set_event_period(dd::DamageDetector::MAX_EV_PERIOD);
+        dd->set_event_listener(listener);
+    }
+
+    UTEST_MAIN
+    {
+        uint8_t *data   = NULL;
+        float *buf      = lsp::alloc_aligned<float>(data, BLOCK_SIZE, 64);
+        lsp_finally { lsp::free_aligned(data); };
+
+        // Reference: the whole stream at the same sample rate
+        Listener ref;
+        dd::DamageDetector rd(1);
+        configure(&rd, &ref);
+        double time     = 0.0;
+        process(&rd, &ref, buf, RATE_LOW, time, 2);
+        const size_t events = rd.events_count();
+        process(&rd, &ref, buf, RATE_LOW, time, 12);
+
+        printf("Reference: events=%d, above=%.4f s, below=%.4f s\n", int(events), ref.fAbove, ref.fBelow);
+        UTEST_ASSERT(events > THRESHOLD);
+        UTEST_ASSERT(ref.fBelow > ref.fAbove);
+        UTEST_ASSERT(ref.nCount == 2);
+
+        // The sample rate changes after the burst of dropouts several times
+        Listener listener;
+        dd::DamageDetector dd(1);
+        configure(&dd, &listener);
+        time            = 0.0;
+        process(&dd, &listener, buf, RATE_LOW, time, 2);
+        process(&dd, &listener, buf, RATE_HIGH, time, 2);
+
+        // The history is kept and there is no spurious notification
+        printf("After the change: events=%d, notifications=%d\n", int(dd.events_count()), int(listener.nCount));
+        UTEST_ASSERT(dd.events_count() == events);
+        UTEST_ASSERT(listener.nCount == 1);
+        UTEST_ASSERT(dd.timestamp() == 4 * RATE_HIGH);
+        UTEST_ASSERT(dd.time() == 4 * dd::TIME_UNITS);
+
+        process(&dd, &listener, buf, RATE_LOW, time, 3);
+        process(&dd, &listener, buf, RATE_HIGH, time, 1);
+        UTEST_ASSERT(dd.time() == 8 * dd::TIME_UNITS);
+        process(&dd, &listener, buf, RATE_LOW, time, 6);
+
+        // Events expire at the same time as without the change of the sample rate
+        printf("Changed: above=%.4f s, below=%.4f s, notifications=%d\n", listener.fAbove, listener.fBelow, int(listener.nCount));
+        UTEST_ASSERT(listener.nCount == 2);
+        UTEST_ASSERT(fabs(listener.fAbove - ref.fAbove) < 1.0 / RATE_LOW);
+        UTEST_ASSERT_MSG(fabs(listener.fBelow - ref.fBelow) < double(BLOCK_SIZE) / MAX_RATE,
+            "Recovery at %.4f s, expected %.4f s\n", listener.fBelow, ref.fBelow);
+        UTEST_ASSERT(dd.total_events() == rd.total_events());
+    }
+
+UTEST_END
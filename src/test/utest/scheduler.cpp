@@ -0,0 +1,124 @@
+/*
+ * Copyright (C) 2024 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2024 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of damage-detector
+ * Created on: 18 окт. 2026 г.
+ *
+ * damage-detector is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * damage-detector is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with damage-detector. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/test-fw/utest.h>
+#include <lsp-plug.in/common/atomic.h>
+#include <lsp-plug.in/ipc/Thread.h>
+
+#include <private/Scheduler.h>
+
+UTEST_BEGIN("damage_detector", scheduler)
+
+    static constexpr size_t TASKS       = 64;
+    static constexpr size_t ITERATIONS  = 1000;
+
+    class TestTask: public dd::Task
+    {
+        public:
+            uint32_t    nRunning;
+            uint32_t    nOverlaps;
+            size_t      nIterations;
+            size_t      nCost;
+
+        public:
+            explicit TestTask(size_t cost)
+            {
+                nRunning    = 0;
+                nOverlaps   = 0;
+                nIterations = 0;
+                nCost       = cost;
+            }
+
+        public:
+            virtual bool run() override
+            {
+                // Detect concurrent execution of the same task
+                if (lsp::atomic_add(&nRunning, 1) != 0)
+                    lsp::atomic_add(&nOverlaps, 1);
+
+                volatile size_t x = 0;
+                for (size_t i=0; i<nCost; ++i)
+                    x   = x + i;
+
+                bool more   = (++nIterations) < ITERATIONS;
+                lsp::atomic_add(&nRunning, -1);
+                return more;
+            }
+    };
+
+    UTEST_MAIN
+    {
+        dd::Scheduler s;
+        UTEST_ASSERT(s.start(4, TASKS) == lsp::STATUS_OK);
+
+        // Skewed load: few heavy tasks and many light tasks
+        TestTask *tasks[TASKS];
+        for (size_t i=0; i<TASKS; ++i)
+            tasks[i]    = new TestTask(((i % 8) == 0) ? 2000 : 10);
+
+        // Submit tasks several times, repeated submissions should not break serial execution
+        for (size_t j=0; j<4; ++j)
+            for (size_t i=0; i<TASKS; ++i)
+                UTEST_ASSERT(s.submit(tasks[i]));
+
+        // Wait for completion
+        for (size_t wait = 0; wait < 10000; ++wait)
+        {
+            dd::scheduler_stats_t st;
+            s.get_stats(&st);
+            if (st.nExecuted >= TASKS * ITERATIONS)
+                break;
+            lsp::ipc::Thread::sleep(1);
+        }
+        for (size_t wait = 0; wait < 1000; ++wait)
+        {
+            bool done = true;
+            for (size_t i=0; i<TASKS; ++i)
+                if (lsp::atomic_load(&tasks[i]->nIterations) < ITERATIONS)
+                    done    = false;
+            if (done)
+                break;
+            lsp::ipc::Thread::sleep(1);
+        }
+
+        // Statistics are collected from worker queues, they are not available after stop()
+        dd::scheduler_stats_t st;
+        s.get_stats(&st);
+        printf("Executed %d tasks, stolen %d tasks, peak queue size %d\n",
+            int(st.nExecuted), int(st.nStolen), int(st.nPeakQueued));
+        UTEST_ASSERT(st.nQueued == 0);
+        UTEST_ASSERT(st.nExecuted >= TASKS * ITERATIONS);
+
+        // Heavy tasks keep their workers busy, so idle workers should steal the light tasks
+        UTEST_ASSERT(st.nStolen > 0);
+
+        UTEST_ASSERT(s.stop() == lsp::STATUS_OK);
+
+        for (size_t i=0; i<TASKS; ++i)
+        {
+            UTEST_ASSERT_MSG(tasks[i]->nOverlaps == 0, "Task %d has been executed concurrently\n", int(i));
+            UTEST_ASSERT_MSG(tasks[i]->nIterations >= ITERATIONS, "Task %d has not been completed: %d iterations\n",
+                int(i), int(tasks[i]->nIterations));
+            delete tasks[i];
+        }
+    }
+
+UTEST_END
@@ -0,0 +1,186 @@
+/*
+ * Copyright (C) 2024 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2024 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of damage-detector
+ * Created on: 18 окт. 2026 г.
+ *
+ * damage-detector is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * damage-detector is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with damage-detector. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <lsp-plug.in/test-fw/utest.h>
+#include <lsp-plug.in/common/alloc.h>
+#include <lsp-plug.in/common/finally.h>
+#include <lsp-plug.in/dsp/dsp.h>
+#include <lsp-plug.in/ipc/Thread.h>
+#include <lsp-plug.in/stdlib/math.h>
+
+#include <private/DamageDetector.h>
+#include <private/ShmAudioRing.h>
+
+#include <stdio.h>
+#include <unistd.h>
+
+/**
+ * Smoke test of the monitoring path: the producer thread writes interleaved frames to the
+ * shared memory ring the same way as damage-detector-feeder does, the consumer reads the ring
+ * and processes data the same way as damage-detector-daemon does
+ */
+UTEST_BEGIN("damage_detector", shm_stream)
+
+    static constexpr size_t SAMPLE_RATE     = 48000;
+    static constexpr size_t CHANNELS        = 2;
+    static constexpr size_t LENGTH          = SAMPLE_RATE * 5;
+    static constexpr size_t CAPACITY        = 0x1000;   // Capacity of the ring in frames
+    static constexpr size_t FEED_BLOCK      = 0x400;    // Block of the feeder in frames
+    static constexpr size_t DAEMON_BLOCK    = 0x300;    // Block of the daemon in frames
+    static constexpr size_t WAIT_PERIOD     = 1;        // Wait period of the feeder and the daemon, milliseconds
+
+    class Feeder: public lsp::ipc::Thread
+    {
+        private:
+            dd::ShmAudioRing   *pRing;
+            const float        *vFrames;
+
+        public:
+            Feeder(dd::ShmAudioRing *ring, const float *frames)
+            {
+                pRing       = ring;
+                vFrames     = frames;
+            }
+
+        public:
+            virtual lsp::status_t run() override
+            {
+                for (size_t offset=0; offset < LENGTH; )
+                {
+                    const size_t to_do      = lsp::lsp_min(LENGTH - offset, FEED_BLOCK);
+                    const size_t written    = pRing->write(&vFrames[offset * CHANNELS], to_do);
+                    if (written <= 0)
+                        lsp::ipc::Thread::sleep(WAIT_PERIOD);
+                    offset                 += written;
+                }
+
+                pRing->set_eos();
+                return lsp::STATUS_OK;
+            }
+    };
+
+    void init_detector(dd::DamageDetector *dd)
+    {
+        dd->set_sample_rate(SAMPLE_RATE);
+        dd->set_bypass(true);
+        dd->set_threshold(-40.0f);
+    }
+
+    UTEST_MAIN
+    {
+        uint8_t *data   = NULL;
+        float *frames   = lsp::alloc_aligned<float>(data, LENGTH * CHANNELS + DAEMON_BLOCK * CHANNELS * 2, 64);
+        float *buffers  = &frames[LENGTH * CHANNELS];
+        float *planar   = &buffers[DAEMON_BLOCK * CHANNELS];
+        lsp_finally { lsp::free_aligned(data); };
+
+        // Stereo programme, the right channel is broken: only two short bursts pass through it
+        for (size_t i=0; i<LENGTH; ++i)
+        {
+            const float s       = 0.5f * sinf(2.0f * M_PI * 440.0f * i / SAMPLE_RATE);
+            const bool burst    = ((i >= SAMPLE_RATE) && (i < SAMPLE_RATE * 6 / 5)) ||
+                                  ((i >= SAMPLE_RATE * 3) && (i < SAMPLE_RATE * 16 / 5));
+            frames[i * CHANNELS]        = s;
+            frames[i * CHANNELS + 1]    = (burst) ? s : 0.0f;
+        }
+
+        char name[64];
+        snprintf(name, sizeof(name), "/dd-utest-%d", int(getpid()));
+
+        dd::ShmAudioRing producer, consumer;
+        UTEST_ASSERT(producer.create(name, CHANNELS, SAMPLE_RATE, CAPACITY) == lsp::STATUS_OK);
+        lsp_finally { producer.close(); };
+        UTEST_ASSERT(consumer.open(name) == lsp::STATUS_OK);
+        lsp_finally { consumer.close(); };
+        UTEST_ASSERT(consumer.channels() == CHANNELS);
+        UTEST_ASSERT(consumer.sample_rate() == SAMPLE_RATE);
+
+        Feeder feeder(&producer, frames);
+        UTEST_ASSERT(feeder.start() == lsp::STATUS_OK);
+
+        // Process the stream as the daemon does
+        dd::DamageDetector dd(consumer.channels());
+        init_detector(&dd);
+
+        size_t received     = 0;
+        size_t notified     = 0;
+        while (true)
+        {
+            const bool eos      = consumer.eos();
+            size_t count;
+            const float *src    = consumer.read_segment(&count);
+            if (count <= 0)
+            {
+                if (eos)
+                    break;
+                lsp::ipc::Thread::sleep(WAIT_PERIOD);
+                continue;
+            }
+            count               = lsp::lsp_min(count, DAEMON_BLOCK);
+
+            for (size_t i=0; i<CHANNELS; ++i)
+            {
+                float *dst          = &buffers[i * DAEMON_BLOCK];
+                for (size_t j=0; j<count; ++j)
+                    dst[j]              = src[j * CHANNELS + i];
+                dd.bind_input(i, dst);
+                dd.bind_output(i, dst);
+            }
+            consumer.commit_read(count);
+
+            lsp::dsp::context_t ctx;
+            lsp::dsp::start(&ctx);
+            dd.process(count);
+            lsp::dsp::finish(&ctx);
+
+            if (dd.poll_event() == dd::EVENT_ABOVE)
+                ++notified;
+            received           += count;
+        }
+        UTEST_ASSERT(feeder.join() == lsp::STATUS_OK);
+
+        // The same data processed directly
+        dd::DamageDetector ref(CHANNELS);
+        init_detector(&ref);
+        for (size_t offset=0; offset < LENGTH; offset += DAEMON_BLOCK)
+        {
+            const size_t to_do  = lsp::lsp_min(LENGTH - offset, DAEMON_BLOCK);
+            for (size_t i=0; i<CHANNELS; ++i)
+            {
+                float *dst          = &planar[i * DAEMON_BLOCK];
+                for (size_t j=0; j<to_do; ++j)
+                    dst[j]              = frames[(offset + j) * CHANNELS + i];
+                ref.bind_input(i, dst);
+                ref.bind_output(i, dst);
+            }
+            ref.process(to_do);
+        }
+
+        printf("Received %d frames, events=%d, reference=%d\n", int(received), int(dd.total_events()), int(ref.total_events()));
+        UTEST_ASSERT(received == LENGTH);
+        UTEST_ASSERT(dd.total_events() == 2);
+        UTEST_ASSERT(dd.total_events() == ref.total_events());
+        UTEST_ASSERT(dd.events_count(0) == 0);
+        UTEST_ASSERT(dd.events_count(1) == 2);
+    }
+
+UTEST_END
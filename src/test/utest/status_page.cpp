@@ -0,0 +1,154 @@
+/*
+ * Copyright (C) 2024 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2024 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of damage-detector
+ * Created on: 18 окт. 2026 г.
+ *
+ * damage-detector is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * damage-detector is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with damage-detector. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <lsp-plug.in/test-fw/utest.h>
+#include <lsp-plug.in/common/alloc.h>
+#include <lsp-plug.in/common/finally.h>
+#include <lsp-plug.in/dsp/dsp.h>
+#include <lsp-plug.in/io/Path.h>
+#include <lsp-plug.in/stdlib/math.h>
+
+#include <private/DamageDetector.h>
+#include <private/StatusPage.h>
+
+#include <stdio.h>
+#include <string.h>
+
+#ifdef PLATFORM_UNIX_COMPATIBLE
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <unistd.h>
+#endif /* PLATFORM_UNIX_COMPATIBLE */
+
+UTEST_BEGIN("damage_detector", status_page)
+
+    static constexpr size_t SAMPLE_RATE = 48000;
+    static constexpr size_t LENGTH      = SAMPLE_RATE * 2;
+    static constexpr size_t BLOCK_SIZE  = 0x400;
+    static constexpr int64_t SYNC_PTS   = 1000000000;
+
+#ifdef PLATFORM_UNIX_COMPATIBLE
+    void check_page(const dd::status_page_t *st, const dd::DamageDetector *dd)
+    {
+        UTEST_ASSERT(st->nMagic == dd::STATUS_PAGE_MAGIC);
+        UTEST_ASSERT(st->nVersion == dd::STATUS_PAGE_VERSION);
+        UTEST_ASSERT(st->nChannels == 2);
+        UTEST_ASSERT(st->nSampleRate == SAMPLE_RATE);
+        UTEST_ASSERT((st->nSequence & 1) == 0);
+        UTEST_ASSERT(st->nSamples == LENGTH);
+        UTEST_ASSERT(st->nTotalEvents == 1);
+        UTEST_ASSERT(st->nLastEvent == dd->last_event());
+        UTEST_ASSERT(st->nLastEventPts == SYNC_PTS + int64_t(st->nLastEvent * 1000000000) / int64_t(SAMPLE_RATE));
+        UTEST_ASSERT(st->nEvents == dd->events_count());
+        UTEST_ASSERT(st->nFlags == (dd::STATUS_EVENTS | ((dd->corrupted()) ? dd::STATUS_CORRUPTED : 0)));
+        for (size_t i=0; i<dd::EV_WINDOW_TOTAL; ++i)
+            UTEST_ASSERT(st->vWindowEvents[i] == dd->window_events(dd::event_window_t(i)));
+
+        // The dropout of the first channel, the constant signal of the second channel
+        const dd::status_channel_t *c = &st->vChannels[0];
+        UTEST_ASSERT(c->nState == dd->trigger_state(0));
+        UTEST_ASSERT(c->nEvents == 1);
+        UTEST_ASSERT(c->fThreshold == -40.0f);
+        UTEST_ASSERT(c->nFlags == 0);
+
+        c                   = &st->vChannels[1];
+        UTEST_ASSERT(c->nState == dd->trigger_state(1));
+        UTEST_ASSERT(c->nEvents == 0);
+        UTEST_ASSERT(c->fThreshold == -40.0f);
+        UTEST_ASSERT(c->nFlags == dd::STATUS_CH_FLATLINE);
+    }
+
+    UTEST_MAIN
+    {
+        uint8_t *data   = NULL;
+        float *buf      = lsp::alloc_aligned<float>(data, LENGTH * 2, 64);
+        lsp_finally { lsp::free_aligned(data); };
+
+        // Sine with the 50 ms dropout in the first channel, constant signal in the second
+        for (size_t i=0; i<LENGTH; ++i)
+            buf[i]          = ((i >= SAMPLE_RATE / 2) && (i < SAMPLE_RATE / 2 + SAMPLE_RATE / 20)) ? 0.0f : 0.5f * sinf(i * 0.05f);
+        lsp::dsp::fill(&buf[LENGTH], 0.25f, LENGTH);
+
+        lsp::io::Path path;
+        UTEST_ASSERT(path.fmt("%s/utest-%s.status", tempdir(), full_name()) > 0);
+        lsp_finally { remove(path.as_native()); };
+
+        dd::StatusPage page;
+        UTEST_ASSERT(page.open(path.as_native()) == lsp::STATUS_OK);
+        UTEST_ASSERT(page.open(path.as_native()) == lsp::STATUS_OPENED);
+        lsp_finally { page.close(); };
+        page.sync(0, SYNC_PTS);
+
+        // Map the page as external readers do
+        int fd              = open(path.as_native(), O_RDONLY);
+        UTEST_ASSERT(fd >= 0);
+        void *addr          = mmap(NULL, sizeof(dd::status_page_t), PROT_READ, MAP_SHARED, fd, 0);
+        close(fd);
+        UTEST_ASSERT(addr != MAP_FAILED);
+        lsp_finally { munmap(addr, sizeof(dd::status_page_t)); };
+        const dd::status_page_t *mapped = static_cast<const dd::status_page_t *>(addr);
+
+        dd::DamageDetector dd(2);
+        dd.set_sample_rate(SAMPLE_RATE);
+        dd.set_bypass(true);
+        dd.set_threshold(-40.0f);
+        dd.set_detect_time(dd::DamageDetector::MAX_DETECT_TIME);
+        dd.set_flatline_time(0.5f);
+
+        size_t updates      = 0;
+        for (size_t offset=0; offset < LENGTH; offset += BLOCK_SIZE)
+        {
+            const size_t to_do  = lsp::lsp_min(LENGTH - offset, BLOCK_SIZE);
+            for (size_t i=0; i<2; ++i)
+            {
+                dd.bind_input(i, &buf[i * LENGTH + offset]);
+                dd.bind_output(i, &buf[i * LENGTH + offset]);
+            }
+            dd.process(to_do);
+            page.publish(&dd);
+            ++updates;
+        }
+
+        // Each update increments the sequence twice
+        dd::status_page_t st;
+        UTEST_ASSERT(dd::StatusPage::read(&st, mapped));
+        UTEST_ASSERT(st.nSequence == updates * 2);
+        check_page(&st, &dd);
+
+        // The odd sequence means that the writer is updating the page, the reader should retry
+        dd::status_page_t copy, dst;
+        memcpy(&copy, &st, sizeof(copy));
+        ++copy.nSequence;
+        UTEST_ASSERT(!dd::StatusPage::read(&dst, &copy));
+        ++copy.nSequence;
+        UTEST_ASSERT(dd::StatusPage::read(&dst, &copy));
+        UTEST_ASSERT(dst.nSequence == st.nSequence + 2);
+        UTEST_ASSERT(dst.nTotalEvents == st.nTotalEvents);
+    }
+#else
+    UTEST_MAIN
+    {
+        printf("Status page is not supported on this platform, skipping\n");
+    }
+#endif /* PLATFORM_UNIX_COMPATIBLE */
+
+UTEST_END
@@ -0,0 +1,142 @@
+/*
+ * Copyright (C) 2024 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2024 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of damage-detector
+ * Created on: 18 окт. 2026 г.
+ *
+ * damage-detector is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * damage-detector is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with damage-detector. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <lsp-plug.in/test-fw/utest.h>
+#include <lsp-plug.in/common/alloc.h>
+#include <lsp-plug.in/common/finally.h>
+#include <lsp-plug.in/dsp/dsp.h>
+#include <lsp-plug.in/stdlib/math.h>
+
+#include <private/DamageDetector.h>
+
+UTEST_BEGIN("damage_detector", storm)
+
+    static constexpr size_t SAMPLE_RATE = 48000;
+    static constexpr size_t LENGTH      = SAMPLE_RATE * 20;
+    static constexpr size_t STORM_END   = SAMPLE_RATE * 8;
+    static constexpr size_t BLOCK_SIZE  = 0x400;
+    static constexpr size_t CLICK_STEP  = SAMPLE_RATE / 100;
+
+    void init_detector(dd::DamageDetector *dd, size_t threshold)
+    {
+        dd->set_sample_rate(SAMPLE_RATE);
+        dd->set_bypass(true);
+        dd->set_threshold(-60.0f);
+        dd->set_estimation_time(5.0f);
+        dd->set_event_threshold(threshold);
+        dd->set_click_detection(true);
+    }
+
+    void test_dropouts(float *src, float *buf)
+    {
+        // Short bursts of the signal, each burst is a dropout event
+        static constexpr size_t BURST   = SAMPLE_RATE / 200;
+        static constexpr size_t PERIOD  = SAMPLE_RATE / 50;
+
+        lsp::dsp::fill_zero(src, LENGTH);
+        for (size_t i=0; i<STORM_END; i += PERIOD)
+            for (size_t j=0; j<BURST; ++j)
+                src[i + j]      = 0.1f * sinf(2.0f * M_PI * 440.0f * j / SAMPLE_RATE);
+
+        dd::DamageDetector dd(1);
+        init_detector(&dd, 1);
+        dd.set_estimation_time(10.0f);
+        dd.set_click_detection(false);
+
+        bool storm      = false;
+        for (size_t offset=0; offset < LENGTH; offset += BLOCK_SIZE)
+        {
+            const size_t to_do  = lsp::lsp_min(LENGTH - offset, BLOCK_SIZE);
+            lsp::dsp::copy(buf, &src[offset], to_do);
+            dd.bind_input(0, buf);
+            dd.bind_output(0, buf);
+            dd.process(to_do);
+            storm          |= dd.storm_active(0);
+        }
+
+        // Durations are measured only for logged dropouts
+        const uint64_t logged   = dd.histogram(0, dd::HIST_DELAY)->total();
+        const uint64_t measured = dd.histogram(0, dd::HIST_DROPOUT)->total();
+        printf("Dropouts: total=%d, coalesced=%d, logged=%d, measured=%d\n",
+            int(dd.total_events()), int(dd.coalesced_events()), int(logged), int(measured));
+        UTEST_ASSERT(storm);
+        UTEST_ASSERT(dd.coalesced_events() > 0);
+        UTEST_ASSERT(logged == dd.total_events() - dd.coalesced_events());
+        UTEST_ASSERT(measured <= logged);
+    }
+
+    UTEST_MAIN
+    {
+        uint8_t *data   = NULL;
+        float *src      = lsp::alloc_aligned<float>(data, LENGTH * 2, 64);
+        float *buf      = &src[LENGTH];
+        lsp_finally { lsp::free_aligned(data); };
+
+        // The programme is broken by clicks every 10 ms, then it becomes clean
+        for (size_t i=0; i<LENGTH; ++i)
+            src[i]          = 0.1f * sinf(2.0f * M_PI * 440.0f * i / SAMPLE_RATE);
+        for (size_t i=SAMPLE_RATE; i<STORM_END; i += CLICK_STEP)
+            src[i]         += 0.5f;
+
+        // The detector with the low event threshold enters the storm mode,
+        // the detector with the high threshold accounts each event
+        dd::DamageDetector ds(1);
+        dd::DamageDetector dr(1);
+        init_detector(&ds, 1);
+        init_detector(&dr, 1000);
+
+        bool storm      = false;
+        for (size_t offset=0; offset < LENGTH; offset += BLOCK_SIZE)
+        {
+            const size_t to_do  = lsp::lsp_min(LENGTH - offset, BLOCK_SIZE);
+            lsp::dsp::copy(buf, &src[offset], to_do);
+            ds.bind_input(0, buf);
+            ds.bind_output(0, buf);
+            ds.process(to_do);
+
+            lsp::dsp::copy(buf, &src[offset], to_do);
+            dr.bind_input(0, buf);
+            dr.bind_output(0, buf);
+            dr.process(to_do);
+
+            // Coalesced events are accounted at the end of the block
+            UTEST_ASSERT(ds.total_events() == dr.total_events());
+            UTEST_ASSERT_MSG(ds.events_count() >= dr.events_count(),
+                "Events: storm=%d, regular=%d\n", int(ds.events_count()), int(dr.events_count()));
+            UTEST_ASSERT(!dr.storm_active(0));
+            storm          |= ds.storm_active(0);
+        }
+
+        printf("Events: total=%d, coalesced=%d\n", int(ds.total_events()), int(ds.coalesced_events()));
+        UTEST_ASSERT(storm);
+        UTEST_ASSERT(ds.total_events() > 500);
+        UTEST_ASSERT(ds.coalesced_events() > ds.total_events() / 2);
+        UTEST_ASSERT(dr.coalesced_events() == 0);
+
+        // The storm mode is left once the events went out of the estimation time
+        UTEST_ASSERT(!ds.storm_active(0));
+        UTEST_ASSERT(ds.events_count() == 0);
+
+        test_dropouts(src, buf);
+    }
+
+UTEST_END
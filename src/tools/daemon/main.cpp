@@ -0,0 +1,585 @@
+/*
+ * Copyright (C) 2024 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2024 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of damage-detector
+ * Created on: 18 окт. 2026 г.
+ *
+ * damage-detector is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * damage-detector is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with damage-detector. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/common/atomic.h>
+#include <lsp-plug.in/common/finally.h>
+#include <lsp-plug.in/common/types.h>
+#include <lsp-plug.in/dsp/dsp.h>
+#include <lsp-plug.in/ipc/Mutex.h>
+#include <lsp-plug.in/ipc/Thread.h>
+#include <lsp-plug.in/runtime/system.h>
+
+#include <private/Arena.h>
+#include <private/DamageDetector.h>
+#include <private/Scheduler.h>
+#include <private/ShmAudioRing.h>
+
+#include <new>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+namespace dd
+{
+    namespace daemon
+    {
+        static constexpr size_t     DFL_BLOCK_SIZE      = 0x400;    // Maximum number of frames processed at once
+        static constexpr size_t     POLL_PERIOD         = 5;        // Period of polling idle streams, milliseconds
+        static constexpr float      DFL_STATS_PERIOD    = 10.0f;    // Default period of statistics reports, seconds
+        static constexpr size_t     RETRY_PERIOD        = 500;      // Period of reopening unavailable stream, milliseconds
+        static constexpr size_t     MAX_NODES           = 64;       // Maximum number of NUMA nodes with own arenas
+
+        enum memory_mode_t
+        {
+            MEM_HEAP,           // State of detectors is allocated from the heap
+            MEM_NUMA,           // State of detectors is placed on the NUMA node of the worker
+            MEM_HUGE            // Same as MEM_NUMA, backed by huge pages
+        };
+
+        typedef struct config_t
+        {
+            size_t              nWorkers;       // Number of worker threads
+            size_t              nBlockSize;     // Maximum number of frames processed at once
+            float               fThreshold;     // Detector threshold
+            float               fDetectTime;    // Detection time
+            float               fReactivity;    // Reactivity
+            float               fEstimateTime;  // Estimation time
+            float               fEventPeriod;   // Event period
+            size_t              nEventThreshold;// Event threshold
+            float               fStatsPeriod;   // Period of statistics reports
+            float               fClickRatio;    // Click detection ratio, negative if click detection is disabled
+            memory_mode_t       enMemory;       // Placement of the state of detectors
+            const char         *sOutput;        // Output file
+        } config_t;
+
+        typedef struct stream_t
+        {
+            const char         *sName;          // Name of the shared memory object
+            ShmAudioRing        sRing;          // Audio ring
+            DamageDetector     *pDetector;      // Damage detector, available while the ring is opened
+            Arena              *pArena;         // Arena of the detector and buffers, NULL for the heap
+            float              *vBuffers;       // De-interleaved channel data
+            wssize_t            nRetryTime;     // Time of the next attempt to open the ring
+            wsize_t             nFrames;        // Number of processed frames
+        } stream_t;
+
+        /**
+         * Aggregated output of events from all streams, one JSON object per line
+         */
+        class EventSink
+        {
+            private:
+                lsp::ipc::Mutex     sLock;
+                FILE               *hOut;
+
+            public:
+                explicit EventSink(FILE *out)
+                {
+                    hOut        = out;
+                }
+
+            public:
+                void emit(const stream_t *s, const char *event)
+                {
+                    const DamageDetector *d = s->pDetector;
+                    const timestamp_t ts    = (d != NULL) ? d->timestamp() : 0;
+                    const size_t sr         = (d != NULL) ? d->sample_rate() : 0;
+                    const size_t events     = (d != NULL) ? d->events_count() : 0;
+                    unsigned int windows[EV_WINDOW_TOTAL];
+                    for (size_t i=0; i<EV_WINDOW_TOTAL; ++i)
+                        windows[i]              = (d != NULL) ? d->window_events(event_window_t(i)) : 0;
+
+                    sLock.lock();
+                    lsp_finally { sLock.unlock(); };
+
+                    fprintf(hOut, "{\"stream\":\"%s\",\"event\":\"%s\",\"timestamp\":%llu,\"time\":%.3f,\"events\":%u,"
+                        "\"events_1s\":%u,\"events_10s\":%u,\"events_1m\":%u,\"events_10m\":%u}\n",
+                        s->sName, event,
+                        (unsigned long long)(ts),
+                        (sr > 0) ? double(ts) / double(sr) : 0.0,
+                        (unsigned int)(events),
+                        windows[EV_WINDOW_1S], windows[EV_WINDOW_10S], windows[EV_WINDOW_1M], windows[EV_WINDOW_10M]);
+                    fflush(hOut);
+                }
+
+                void emit_flatline(const stream_t *s, const flatline_t *flat)
+                {
+                    const DamageDetector *d = s->pDetector;
+                    const size_t sr         = d->sample_rate();
+
+                    sLock.lock();
+                    lsp_finally { sLock.unlock(); };
+
+                    fprintf(hOut, "{\"stream\":\"%s\",\"event\":\"%s\",\"channel\":%u,\"value\":%g,\"start\":%llu,\"timestamp\":%llu,\"time\":%.3f}\n",
+                        s->sName,
+                        (flat->bActive) ? "flatline" : "flatline_end",
+                        (unsigned int)(flat->nChannel),
+                        flat->fValue,
+                        (unsigned long long)(flat->nStart),
+                        (unsigned long long)(d->timestamp()),
+                        (sr > 0) ? double(d->timestamp()) / double(sr) : 0.0);
+                    fflush(hOut);
+                }
+
+                void emit_stats(const scheduler_stats_t *st, float throughput)
+                {
+                    sLock.lock();
+                    lsp_finally { sLock.unlock(); };
+
+                    fprintf(hOut, "{\"event\":\"stats\",\"frames_per_second\":%.0f,\"tasks\":%llu,\"stolen\":%llu,\"queued\":%u,\"peak_queued\":%u}\n",
+                        throughput,
+                        (unsigned long long)(st->nExecuted),
+                        (unsigned long long)(st->nStolen),
+                        (unsigned int)(st->nQueued),
+                        (unsigned int)(st->nPeakQueued));
+                    fflush(hOut);
+                }
+        };
+
+        /**
+         * Arenas of the detector state, one per NUMA node. Streams are opened by the worker
+         * that processes them, so the state of the detector is placed on the node of that worker
+         */
+        class ArenaSet
+        {
+            private:
+                lsp::ipc::Mutex     sLock;
+                Arena              *vArenas[MAX_NODES];
+                size_t              nFlags;
+
+            public:
+                explicit ArenaSet(size_t flags)
+                {
+                    for (size_t i=0; i<MAX_NODES; ++i)
+                        vArenas[i]      = NULL;
+                    nFlags      = flags;
+                }
+
+                ~ArenaSet()
+                {
+                    for (size_t i=0; i<MAX_NODES; ++i)
+                        delete vArenas[i];
+                }
+
+            public:
+                Arena *get()
+                {
+                    const ssize_t node      = Arena::current_node();
+                    const size_t index      = (node >= 0) ? size_t(node) % MAX_NODES : 0;
+
+                    sLock.lock();
+                    lsp_finally { sLock.unlock(); };
+
+                    Arena *a                = vArenas[index];
+                    if (a != NULL)
+                        return a;
+
+                    a                       = new Arena();
+                    if (a->init(node, nFlags) != lsp::STATUS_OK)
+                    {
+                        delete a;
+                        return NULL;
+                    }
+                    vArenas[index]          = a;
+
+                    return a;
+                }
+        };
+
+        static volatile sig_atomic_t    bTerminate  = 0;
+
+        static void on_signal(int signum)
+        {
+            bTerminate      = 1;
+        }
+
+        static void close_stream(stream_t *s)
+        {
+            Arena *arena    = s->pArena;
+            if (s->pDetector != NULL)
+            {
+                if (arena != NULL)
+                {
+                    s->pDetector->~DamageDetector();
+                    arena->free(s->pDetector);
+                }
+                else
+                    delete s->pDetector;
+                s->pDetector    = NULL;
+            }
+            if (s->vBuffers != NULL)
+            {
+                if (arena != NULL)
+                    arena->free(s->vBuffers);
+                else
+                    delete [] s->vBuffers;
+                s->vBuffers     = NULL;
+            }
+            s->pArena       = NULL;
+            s->sRing.close();
+        }
+
+        static bool open_stream(stream_t *s, const config_t *cfg, ArenaSet *arenas)
+        {
+            const wssize_t time = lsp::system::get_time_millis();
+            if (time < s->nRetryTime)
+                return false;
+            s->nRetryTime   = time + RETRY_PERIOD;
+
+            if (s->sRing.open(s->sName) != lsp::STATUS_OK)
+                return false;
+
+            const size_t channels   = s->sRing.channels();
+            Arena *arena            = (arenas != NULL) ? arenas->get() : NULL;
+            DamageDetector *d       = NULL;
+            float *buffers          = NULL;
+            if (arena != NULL)
+            {
+                void *ptr               = arena->alloc(sizeof(DamageDetector));
+                d                       = (ptr != NULL) ? new (ptr) DamageDetector(channels, arena) : NULL;
+                buffers                 = static_cast<float *>(arena->alloc(channels * cfg->nBlockSize * sizeof(float)));
+            }
+            else
+            {
+                d                       = new DamageDetector(channels);
+                buffers                 = new float[channels * cfg->nBlockSize];
+            }
+
+            s->pDetector    = d;
+            s->pArena       = arena;
+            s->vBuffers     = buffers;
+            if ((d == NULL) || (buffers == NULL))
+            {
+                close_stream(s);
+                return false;
+            }
+
+            d->set_sample_rate(s->sRing.sample_rate());
+            d->set_threshold(cfg->fThreshold);
+            d->set_detect_time(cfg->fDetectTime);
+            d->set_reactivity(cfg->fReactivity);
+            d->set_estimation_time(cfg->fEstimateTime);
+            d->set_event_period(cfg->fEventPeriod);
+            d->set_event_threshold(cfg->nEventThreshold);
+            d->set_click_detection(cfg->fClickRatio >= 0.0f);
+            if (cfg->fClickRatio >= 0.0f)
+                d->set_click_ratio(cfg->fClickRatio);
+
+            return true;
+        }
+
+        /**
+         * Process the next portion of the stream
+         * @return true if some audio data has been processed
+         */
+        static bool process_stream(stream_t *s, const config_t *cfg, EventSink *sink, ArenaSet *arenas)
+        {
+            if (!s->sRing.opened())
+            {
+                if (open_stream(s, cfg, arenas))
+                    sink->emit(s, "open");
+                return false;
+            }
+
+            // Check the end of stream before reading: the producer may write the last
+            // frames and set the flag between the read and the check
+            const bool eos          = s->sRing.eos();
+
+            // Fetch the contiguous segment of the ring
+            size_t count;
+            const float *frames     = s->sRing.read_segment(&count);
+            if (count <= 0)
+            {
+                if (eos)
+                {
+                    sink->emit(s, "eos");
+                    close_stream(s);
+                }
+                return false;
+            }
+            count                   = lsp::lsp_min(count, cfg->nBlockSize);
+
+            // De-interleave data
+            DamageDetector *d       = s->pDetector;
+            const size_t channels   = s->sRing.channels();
+            for (size_t i=0; i<channels; ++i)
+            {
+                float *dst              = &s->vBuffers[i * cfg->nBlockSize];
+                const float *src        = &frames[i];
+                for (size_t j=0; j<count; ++j, src += channels)
+                    dst[j]                  = *src;
+
+                d->bind_input(i, dst);
+                d->bind_output(i, dst);
+            }
+            s->sRing.commit_read(count);
+            lsp::atomic_add(&s->nFrames, count);
+
+            // Process data and report events, the DSP context is set up by each worker thread
+            lsp::dsp::context_t ctx;
+            lsp::dsp::start(&ctx);
+            d->process(count);
+            lsp::dsp::finish(&ctx);
+
+            switch (d->poll_event())
+            {
+                case EVENT_ABOVE: sink->emit(s, "above"); break;
+                case EVENT_BELOW: sink->emit(s, "below"); break;
+                default: break;
+            }
+
+            flatline_t flat;
+            while (d->poll_flatline(&flat))
+                sink->emit_flatline(s, &flat);
+
+            return true;
+        }
+
+        /**
+         * Processing of the stream, executed by the scheduler. The task requeues itself while
+         * the stream has data, idle streams are submitted again by the polling loop.
+         */
+        class StreamTask: public Task
+        {
+            private:
+                stream_t           *pStream;
+                const config_t     *pConfig;
+                EventSink          *pSink;
+                ArenaSet           *pArenas;
+
+            public:
+                StreamTask(stream_t *stream, const config_t *cfg, EventSink *sink, ArenaSet *arenas)
+                {
+                    pStream     = stream;
+                    pConfig     = cfg;
+                    pSink       = sink;
+                    pArenas     = arenas;
+                }
+
+            public:
+                virtual bool run() override
+                {
+                    return process_stream(pStream, pConfig, pSink, pArenas);
+                }
+        };
+
+        static void print_usage(const char *name)
+        {
+            fprintf(stderr, "Usage: %s [options] <stream> [<stream> ...]\n", name);
+            fprintf(stderr, "Monitors audio streams published in shared memory for damages.\n");
+            fprintf(stderr, "Events of all streams are written as JSON lines.\n");
+            fprintf(stderr, "Options:\n");
+            fprintf(stderr, "  -b <frames>   maximum number of frames processed at once (default %d)\n", int(DFL_BLOCK_SIZE));
+            fprintf(stderr, "  -c <dB>       enable click detection with the specified click ratio\n");
+            fprintf(stderr, "  -d <seconds>  detection time\n");
+            fprintf(stderr, "  -e <seconds>  estimation time\n");
+            fprintf(stderr, "  -m <mode>     placement of the detector state: heap, numa (default) or huge\n");
+            fprintf(stderr, "                numa places it on the NUMA node of the worker, huge also uses huge pages\n");
+            fprintf(stderr, "  -n <count>    event threshold\n");
+            fprintf(stderr, "  -o <file>     output file, standard output by default\n");
+            fprintf(stderr, "  -p <seconds>  event period\n");
+            fprintf(stderr, "  -r <millis>   reactivity\n");
+            fprintf(stderr, "  -s <seconds>  period of scheduler statistics reports, 0 to disable (default %.0f)\n", DFL_STATS_PERIOD);
+            fprintf(stderr, "  -t <dB>       threshold\n");
+            fprintf(stderr, "  -w <count>    number of worker threads, number of CPU cores by default\n");
+        }
+
+        static int parse_args(config_t *cfg, size_t *first, int argc, const char **argv)
+        {
+            cfg->nWorkers           = lsp::ipc::Thread::system_cores();
+            cfg->nBlockSize         = DFL_BLOCK_SIZE;
+            cfg->fThreshold         = DamageDetector::DFL_THRESHOLD;
+            cfg->fDetectTime        = DamageDetector::DFL_DETECT_TIME;
+            cfg->fReactivity        = DamageDetector::DFL_REACTIVITY;
+            cfg->fEstimateTime      = DamageDetector::DFL_ESTIMATE_TIME;
+            cfg->fEventPeriod       = DamageDetector::DFL_EV_PERIOD;
+            cfg->nEventThreshold    = DamageDetector::DFL_EV_TRHESHOLD;
+            cfg->fStatsPeriod       = DFL_STATS_PERIOD;
+            cfg->fClickRatio        = -1.0f;
+            cfg->enMemory           = MEM_NUMA;
+            cfg->sOutput            = NULL;
+
+            int i = 1;
+            for ( ; i < argc; ++i)
+            {
+                const char *opt = argv[i];
+                if ((!strcmp(opt, "-h")) || (!strcmp(opt, "--help")))
+                    return -1;
+                if ((opt[0] != '-') || (opt[1] == '\0') || (opt[2] != '\0'))
+                    break;
+                if (++i >= argc)
+                {
+                    fprintf(stderr, "Missing value for option %s\n", opt);
+                    return 1;
+                }
+
+                const char *value = argv[i];
+                switch (opt[1])
+                {
+                    case 'b': cfg->nBlockSize       = lsp::lsp_max(atol(value), 1L); break;
+                    case 'c': cfg->fClickRatio      = lsp::lsp_max(atof(value), 0.0); break;
+                    case 'd': cfg->fDetectTime      = atof(value); break;
+                    case 'e': cfg->fEstimateTime    = atof(value); break;
+                    case 'm':
+                        if (!strcmp(value, "heap"))
+                            cfg->enMemory           = MEM_HEAP;
+                        else if (!strcmp(value, "numa"))
+                            cfg->enMemory           = MEM_NUMA;
+                        else if (!strcmp(value, "huge"))
+                            cfg->enMemory           = MEM_HUGE;
+                        else
+                        {
+                            fprintf(stderr, "Unknown memory placement %s\n", value);
+                            return 1;
+                        }
+                        break;
+                    case 'n': cfg->nEventThreshold  = lsp::lsp_max(atol(value), 0L); break;
+                    case 'o': cfg->sOutput          = value; break;
+                    case 'p': cfg->fEventPeriod     = atof(value); break;
+                    case 'r': cfg->fReactivity      = atof(value); break;
+                    case 's': cfg->fStatsPeriod     = atof(value); break;
+                    case 't': cfg->fThreshold       = atof(value); break;
+                    case 'w': cfg->nWorkers         = lsp::lsp_max(atol(value), 1L); break;
+                    default:
+                        fprintf(stderr, "Unknown option %s\n", opt);
+                        return 1;
+                }
+            }
+
+            if (i >= argc)
+            {
+                fprintf(stderr, "No streams specified\n");
+                return 1;
+            }
+
+            *first = i;
+            return 0;
+        }
+
+        static int main(int argc, const char **argv)
+        {
+            config_t cfg;
+            size_t first = 0;
+            int res = parse_args(&cfg, &first, argc, argv);
+            if (res != 0)
+            {
+                print_usage(argv[0]);
+                return (res < 0) ? 0 : res;
+            }
+
+            lsp::dsp::init();
+
+            FILE *out = (cfg.sOutput != NULL) ? fopen(cfg.sOutput, "a") : stdout;
+            if (out == NULL)
+            {
+                fprintf(stderr, "Could not open file %s\n", cfg.sOutput);
+                return 1;
+            }
+            lsp_finally {
+                if (out != stdout)
+                    fclose(out);
+            };
+
+            // Initialize streams
+            const size_t nstreams   = argc - first;
+            stream_t *streams       = new stream_t[nstreams];
+            lsp_finally { delete [] streams; };
+            for (size_t i=0; i<nstreams; ++i)
+            {
+                stream_t *s             = &streams[i];
+                s->sName                = argv[first + i];
+                s->pDetector            = NULL;
+                s->pArena               = NULL;
+                s->vBuffers             = NULL;
+                s->nRetryTime           = 0;
+                s->nFrames              = 0;
+            }
+
+            signal(SIGINT, on_signal);
+            signal(SIGTERM, on_signal);
+        #ifdef SIGPIPE
+            signal(SIGPIPE, SIG_IGN);
+        #endif /* SIGPIPE */
+
+            // Arenas should outlive the detectors which are closed after the scheduler stops
+            ArenaSet arenas((cfg.enMemory == MEM_HUGE) ? ARENA_NUMA_BIND | ARENA_HUGE_PAGES : ARENA_NUMA_BIND);
+            ArenaSet *pa            = (cfg.enMemory != MEM_HEAP) ? &arenas : NULL;
+
+            // Create tasks and start the scheduler
+            EventSink sink(out);
+            StreamTask **tasks      = new StreamTask *[nstreams];
+            lsp_finally {
+                for (size_t i=0; i<nstreams; ++i)
+                    delete tasks[i];
+                delete [] tasks;
+            };
+            for (size_t i=0; i<nstreams; ++i)
+                tasks[i]                = new StreamTask(&streams[i], &cfg, &sink, pa);
+
+            Scheduler scheduler;
+            if (scheduler.start(cfg.nWorkers, nstreams) != lsp::STATUS_OK)
+            {
+                fprintf(stderr, "Could not start worker threads\n");
+                return 2;
+            }
+
+            // Poll idle streams and report statistics until termination
+            const wssize_t period   = cfg.fStatsPeriod * 1000.0f;
+            wssize_t stats_time     = lsp::system::get_time_millis();
+            wsize_t stats_frames    = 0;
+
+            while (!bTerminate)
+            {
+                for (size_t i=0; i<nstreams; ++i)
+                    scheduler.submit(tasks[i]);
+                lsp::ipc::Thread::sleep(POLL_PERIOD);
+
+                const wssize_t time     = lsp::system::get_time_millis();
+                if ((period <= 0) || (time < stats_time + period))
+                    continue;
+
+                wsize_t frames          = 0;
+                for (size_t i=0; i<nstreams; ++i)
+                    frames                 += lsp::atomic_load(&streams[i].nFrames);
+
+                scheduler_stats_t st;
+                scheduler.get_stats(&st);
+                sink.emit_stats(&st, float(frames - stats_frames) * 1000.0f / float(time - stats_time));
+
+                stats_time              = time;
+                stats_frames            = frames;
+            }
+
+            scheduler.stop();
+            for (size_t i=0; i<nstreams; ++i)
+                close_stream(&streams[i]);
+
+            return 0;
+        }
+
+    } /* namespace daemon */
+} /* namespace dd */
+
+int main(int argc, const char **argv)
+{
+    return dd::daemon::main(argc, argv);
+}
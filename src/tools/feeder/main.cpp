@@ -0,0 +1,172 @@
+/*
+ * Copyright (C) 2024 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2024 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of damage-detector
+ * Created on: 18 окт. 2026 г.
+ *
+ * damage-detector is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * damage-detector is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with damage-detector. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/common/finally.h>
+#include <lsp-plug.in/common/types.h>
+#include <lsp-plug.in/ipc/Thread.h>
+#include <lsp-plug.in/runtime/system.h>
+
+#include <private/ShmAudioRing.h>
+
+#include <sndfile.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+namespace dd
+{
+    namespace feeder
+    {
+        static constexpr size_t     DFL_CAPACITY        = 0x10000;  // Default capacity of the ring in frames
+        static constexpr size_t     BLOCK_SIZE          = 0x400;    // Number of frames read from file at once
+        static constexpr size_t     WAIT_PERIOD         = 2;        // Wait period for free space in the ring, milliseconds
+
+        static volatile sig_atomic_t    bTerminate  = 0;
+
+        static void on_signal(int signum)
+        {
+            bTerminate      = 1;
+        }
+
+        static void print_usage(const char *name)
+        {
+            fprintf(stderr, "Usage: %s [options] <stream> <audio-file>\n", name);
+            fprintf(stderr, "Publishes the audio file as the shared memory stream for the damage detector daemon.\n");
+            fprintf(stderr, "Options:\n");
+            fprintf(stderr, "  -c <frames>   capacity of the ring buffer in frames (default %d)\n", int(DFL_CAPACITY));
+            fprintf(stderr, "  -k            keep the stream after the end of file until interrupted\n");
+            fprintf(stderr, "  -r            feed data in real time\n");
+        }
+
+        static int feed(ShmAudioRing *ring, SNDFILE *sf, const SF_INFO *info, bool realtime)
+        {
+            const size_t channels   = info->channels;
+            float *buf              = new float[BLOCK_SIZE * channels];
+            lsp_finally { delete [] buf; };
+
+            const wssize_t start    = lsp::system::get_time_millis();
+            wsize_t fed             = 0;
+
+            while (!bTerminate)
+            {
+                // Pace the data if needed
+                if (realtime)
+                {
+                    const wssize_t due  = start + (fed * 1000) / info->samplerate;
+                    const wssize_t time = lsp::system::get_time_millis();
+                    if (time < due)
+                        lsp::ipc::Thread::sleep(due - time);
+                }
+
+                // Read the block
+                const sf_count_t count  = sf_readf_float(sf, buf, BLOCK_SIZE);
+                if (count <= 0)
+                    break;
+
+                // Write the block to the ring
+                for (size_t done = 0; (done < size_t(count)) && (!bTerminate); )
+                {
+                    const size_t written    = ring->write(&buf[done * channels], count - done);
+                    if (written <= 0)
+                        lsp::ipc::Thread::sleep(WAIT_PERIOD);
+                    done                   += written;
+                }
+
+                fed                    += count;
+            }
+
+            return 0;
+        }
+
+        static int main(int argc, const char **argv)
+        {
+            size_t capacity = DFL_CAPACITY;
+            bool realtime   = false;
+            bool keep       = false;
+
+            int i = 1;
+            for ( ; i < argc; ++i)
+            {
+                const char *opt = argv[i];
+                if ((!strcmp(opt, "-h")) || (!strcmp(opt, "--help")))
+                {
+                    print_usage(argv[0]);
+                    return 0;
+                }
+                else if (!strcmp(opt, "-r"))
+                    realtime    = true;
+                else if (!strcmp(opt, "-k"))
+                    keep        = true;
+                else if ((!strcmp(opt, "-c")) && (i + 1 < argc))
+                    capacity    = lsp::lsp_max(atol(argv[++i]), 1L);
+                else
+                    break;
+            }
+
+            if (argc - i != 2)
+            {
+                print_usage(argv[0]);
+                return 1;
+            }
+            const char *name    = argv[i];
+            const char *path    = argv[i + 1];
+
+            // Open the audio file
+            SF_INFO info;
+            memset(&info, 0, sizeof(info));
+            SNDFILE *sf         = sf_open(path, SFM_READ, &info);
+            if (sf == NULL)
+            {
+                fprintf(stderr, "Could not open file %s: %s\n", path, sf_strerror(NULL));
+                return 1;
+            }
+            lsp_finally { sf_close(sf); };
+
+            // Create the stream
+            ShmAudioRing ring;
+            if (ring.create(name, info.channels, info.samplerate, capacity) != lsp::STATUS_OK)
+            {
+                fprintf(stderr, "Could not create shared memory stream %s\n", name);
+                return 1;
+            }
+            lsp_finally { ring.close(); };
+
+            signal(SIGINT, on_signal);
+            signal(SIGTERM, on_signal);
+
+            int res = feed(&ring, sf, &info, realtime);
+            ring.set_eos();
+
+            // Wait until the consumer fetches all data
+            while ((!bTerminate) && ((keep) || (ring.available() > 0)))
+                lsp::ipc::Thread::sleep(WAIT_PERIOD);
+
+            return res;
+        }
+
+    } /* namespace feeder */
+} /* namespace dd */
+
+int main(int argc, const char **argv)
+{
+    return dd::feeder::main(argc, argv);
+}
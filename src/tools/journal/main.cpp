@@ -0,0 +1,97 @@
+/*
+ * Copyright (C) 2024 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2024 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of damage-detector
+ * Created on: 18 окт. 2026 г.
+ *
+ * damage-detector is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * damage-detector is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with damage-detector. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/common/finally.h>
+#include <lsp-plug.in/common/types.h>
+
+#include <private/EventJournal.h>
+
+#include <stdio.h>
+#include <string.h>
+
+namespace dd
+{
+    namespace journal
+    {
+        static void print_usage(const char *name)
+        {
+            fprintf(stderr, "Usage: %s <journal-file> [<output.csv>]\n", name);
+            fprintf(stderr, "Converts the binary event journal of the damage detector to CSV.\n");
+            fprintf(stderr, "If output file is not specified, the data is written to the standard output.\n");
+        }
+
+        static int convert(FILE *out, FILE *in)
+        {
+            switch (EventJournal::export_csv(out, in))
+            {
+                case lsp::STATUS_OK:
+                    return 0;
+                case lsp::STATUS_CORRUPTED:
+                    fprintf(stderr, "Could not read journal header\n");
+                    return 2;
+                case lsp::STATUS_BAD_FORMAT:
+                    fprintf(stderr, "Unsupported journal format\n");
+                    return 2;
+                default:
+                    break;
+            }
+
+            fprintf(stderr, "Error reading journal\n");
+            return 3;
+        }
+
+        static int main(int argc, const char **argv)
+        {
+            if ((argc < 2) || (argc > 3) || (!strcmp(argv[1], "-h")) || (!strcmp(argv[1], "--help")))
+            {
+                print_usage(argv[0]);
+                return (argc < 2) ? 1 : 0;
+            }
+
+            FILE *in = fopen(argv[1], "rb");
+            if (in == NULL)
+            {
+                fprintf(stderr, "Could not open file %s\n", argv[1]);
+                return 1;
+            }
+            lsp_finally { fclose(in); };
+
+            FILE *out = (argc > 2) ? fopen(argv[2], "w") : stdout;
+            if (out == NULL)
+            {
+                fprintf(stderr, "Could not create file %s\n", argv[2]);
+                return 1;
+            }
+            lsp_finally {
+                if (out != stdout)
+                    fclose(out);
+            };
+
+            return convert(out, in);
+        }
+
+    } /* namespace journal */
+} /* namespace dd */
+
+int main(int argc, const char **argv)
+{
+    return dd::journal::main(argc, argv);
+}
@@ -0,0 +1,1000 @@
+/*
+ * Copyright (C) 2024 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2024 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of damage-detector
+ * Created on: 18 окт. 2026 г.
+ *
+ * damage-detector is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * damage-detector is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with damage-detector. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/common/alloc.h>
+#include <lsp-plug.in/common/atomic.h>
+#include <lsp-plug.in/common/finally.h>
+#include <lsp-plug.in/common/types.h>
+#include <lsp-plug.in/dsp/dsp.h>
+#include <lsp-plug.in/ipc/Mutex.h>
+#include <lsp-plug.in/ipc/Thread.h>
+#include <lsp-plug.in/runtime/system.h>
+
+#include <private/DamageDetector.h>
+#include <private/EnvelopeIndex.h>
+#include <private/EventJournal.h>
+#include <private/Scheduler.h>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <sndfile.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace dd
+{
+    namespace scan
+    {
+        static constexpr size_t     DFL_BLOCK_SIZE      = 0x4000;   // Size of the block buffer in samples of all channels
+        static constexpr size_t     BLOCKS_PER_WORKER   = 8;        // Default number of block buffers per worker
+        static constexpr size_t     FILES_PER_WORKER    = 2;        // Number of files processed simultaneously per worker
+        static constexpr size_t     IDLE_PERIOD         = 1;        // Sleep period of the reader waiting for buffers, milliseconds
+        static constexpr wsize_t    READAHEAD_SIZE      = 0x800000; // Size of the readahead window in bytes
+
+        typedef struct config_t
+        {
+            size_t              nWorkers;       // Number of worker threads
+            size_t              nBlocks;        // Number of block buffers, 0 for default
+            size_t              nBlockSize;     // Size of the block buffer in samples of all channels
+            size_t              nDecimation;    // Decimation of the envelope index
+            float               fThreshold;     // Detector threshold
+            float               fDetectTime;    // Detection time
+            float               fReactivity;    // Reactivity
+            float               fEstimateTime;  // Estimation time
+            float               fEventPeriod;   // Event period
+            size_t              nEventThreshold;// Event threshold
+            float               fClickRatio;    // Click detection ratio, negative if click detection is disabled
+            const char         *sJournal;       // Journal file
+            const char         *sIndex;         // Envelope index file to write
+            bool                bReanalyze;     // Input files are envelope indices
+        } config_t;
+
+        typedef struct stats_t
+        {
+            wsize_t             nFiles;         // Number of processed files
+            wsize_t             nFailed;        // Number of files which could not be processed
+            wsize_t             nSamples;       // Number of processed frames
+            wsize_t             nBytes;         // Number of bytes read
+            wsize_t             nEvents;        // Number of detected events
+            wsize_t             nStalls;        // Number of times the reader waited for a free block buffer
+            wsize_t             nDuration;      // Total duration of processed audio in milliseconds
+        } stats_t;
+
+        typedef struct file_list_t
+        {
+            char              **vItems;         // Paths of files
+            size_t              nItems;         // Number of files
+            size_t              nCapacity;      // Capacity of the list
+        } file_list_t;
+
+        /**
+         * Block of audio data passed from the reader to the detector,
+         * channels are stored one after another
+         */
+        typedef struct block_t
+        {
+            block_t            *pNext;          // Next block in the list
+            size_t              nFrames;        // Number of frames in the block
+            float              *vData;          // Planar channel data, nFrames samples per channel
+        } block_t;
+
+        /**
+         * Fixed pool of block buffers, bounds the memory used by data read ahead
+         */
+        class BlockPool
+        {
+            private:
+                lsp::ipc::Mutex     sLock;
+                block_t            *vBlocks;        // All blocks
+                block_t            *pFree;          // List of free blocks
+                size_t              nSize;          // Size of the block in samples
+                uint8_t            *pData;
+
+            public:
+                BlockPool()
+                {
+                    vBlocks     = NULL;
+                    pFree       = NULL;
+                    nSize       = 0;
+                    pData       = NULL;
+                }
+
+                ~BlockPool()
+                {
+                    delete [] vBlocks;
+                    lsp::free_aligned(pData);
+                }
+
+            public:
+                bool init(size_t blocks, size_t size)
+                {
+                    float *data         = lsp::alloc_aligned<float>(pData, blocks * size, DEFAULT_ALIGN);
+                    if (data == NULL)
+                        return false;
+
+                    vBlocks             = new block_t[blocks];
+                    nSize               = size;
+                    for (size_t i=0; i<blocks; ++i)
+                    {
+                        block_t *b          = &vBlocks[i];
+                        b->vData            = &data[i * size];
+                        b->nFrames          = 0;
+                        b->pNext            = pFree;
+                        pFree               = b;
+                    }
+
+                    return true;
+                }
+
+                inline size_t size() const  { return nSize; }
+
+                block_t *alloc()
+                {
+                    sLock.lock();
+                    lsp_finally { sLock.unlock(); };
+
+                    block_t *b          = pFree;
+                    if (b != NULL)
+                        pFree               = b->pNext;
+                    return b;
+                }
+
+                void release(block_t *b)
+                {
+                    sLock.lock();
+                    lsp_finally { sLock.unlock(); };
+
+                    b->pNext            = pFree;
+                    pFree               = b;
+                }
+        };
+
+        class FileTask;
+
+        typedef struct file_t
+        {
+            char               *sPath;          // Path to the file
+            SNDFILE            *hFile;          // Audio file, accessed only by the reader
+            int                 hFD;            // File descriptor of the audio file
+            wsize_t             nAhead;         // End of the requested readahead window
+            size_t              nChannels;      // Number of channels
+            wssize_t            nStart;         // Time when the file has been opened
+            DamageDetector     *pDetector;      // Damage detector
+            EnvelopeIndex       sIndex;         // Envelope index
+            EventJournal        sJournal;       // Journal of the file
+            lsp::ipc::Mutex     sLock;          // Lock of the block queue
+            block_t            *pHead;          // First queued block
+            block_t            *pTail;          // Last queued block
+            bool                bEof;           // All blocks of the file have been queued
+            uint32_t            bDone;          // Processing of the file has been finished
+            FileTask           *pTask;          // Processing task
+        } file_t;
+
+        static volatile sig_atomic_t    bTerminate  = 0;
+
+        static void on_signal(int signum)
+        {
+            bTerminate      = 1;
+        }
+
+        static void print_usage(const char *name)
+        {
+            fprintf(stderr, "Usage: %s [options] <file|directory> [<file|directory> ...]\n", name);
+            fprintf(stderr, "Scans audio files for damages, events are written as JSON lines.\n");
+            fprintf(stderr, "Directories are scanned recursively, files are processed in parallel.\n");
+            fprintf(stderr, "Options:\n");
+            fprintf(stderr, "  -b <samples>  size of the block buffer in samples of all channels (default %d)\n", int(DFL_BLOCK_SIZE));
+            fprintf(stderr, "  -c <dB>       enable click detection with the specified click ratio\n");
+            fprintf(stderr, "  -d <seconds>  detection time\n");
+            fprintf(stderr, "  -e <seconds>  estimation time\n");
+            fprintf(stderr, "  -i            re-analyze: input files are envelope indices written with -x\n");
+            fprintf(stderr, "  -j <file>     write detected events to the journal, %%s is replaced with the file name\n");
+            fprintf(stderr, "  -m <samples>  number of samples per envelope index entry (default %d)\n", int(EnvelopeIndex::DFL_DECIMATION));
+            fprintf(stderr, "  -n <count>    event threshold\n");
+            fprintf(stderr, "  -p <seconds>  event period\n");
+            fprintf(stderr, "  -q <blocks>   number of block buffers (default %d per worker)\n", int(BLOCKS_PER_WORKER));
+            fprintf(stderr, "  -r <millis>   reactivity, taken from the index in re-analysis mode\n");
+            fprintf(stderr, "  -t <dB>       threshold\n");
+            fprintf(stderr, "  -w <count>    number of worker threads, number of CPU cores by default\n");
+            fprintf(stderr, "  -x <file>     write the envelope index of the file, %%s is replaced with the file name\n");
+        }
+
+        static void configure(DamageDetector *d, const config_t *cfg, size_t sample_rate, float reactivity)
+        {
+            d->set_sample_rate(sample_rate);
+            d->set_threshold(cfg->fThreshold);
+            d->set_detect_time(cfg->fDetectTime);
+            d->set_reactivity(reactivity);
+            d->set_estimation_time(cfg->fEstimateTime);
+            d->set_event_period(cfg->fEventPeriod);
+            d->set_event_threshold(cfg->nEventThreshold);
+            d->set_click_detection(cfg->fClickRatio >= 0.0f);
+            if (cfg->fClickRatio >= 0.0f)
+                d->set_click_ratio(cfg->fClickRatio);
+        }
+
+        static void emit(const char *path, const DamageDetector *d, const char *event)
+        {
+            const timestamp_t ts    = d->timestamp();
+            printf("{\"file\":\"%s\",\"event\":\"%s\",\"timestamp\":%llu,\"time\":%.3f,\"events\":%u}\n",
+                path, event,
+                (unsigned long long)(ts),
+                double(ts) / double(d->sample_rate()),
+                (unsigned int)(d->events_count()));
+        }
+
+        static void report(const char *path, DamageDetector *d)
+        {
+            switch (d->poll_event())
+            {
+                case EVENT_ABOVE: emit(path, d, "above"); break;
+                case EVENT_BELOW: emit(path, d, "below"); break;
+                default: break;
+            }
+
+            flatline_t flat;
+            while (d->poll_flatline(&flat))
+                printf("{\"file\":\"%s\",\"event\":\"%s\",\"channel\":%u,\"value\":%g,\"start\":%llu,\"timestamp\":%llu,\"time\":%.3f}\n",
+                    path,
+                    (flat.bActive) ? "flatline" : "flatline_end",
+                    (unsigned int)(flat.nChannel),
+                    flat.fValue,
+                    (unsigned long long)(flat.nStart),
+                    (unsigned long long)(d->timestamp()),
+                    double(d->timestamp()) / double(d->sample_rate()));
+        }
+
+        static void summary(const char *path, const DamageDetector *d, wssize_t elapsed)
+        {
+            const double duration   = double(d->timestamp()) / double(d->sample_rate());
+            const double seconds    = double(lsp::lsp_max(elapsed, wssize_t(1))) * 0.001;
+
+            printf("{\"file\":\"%s\",\"event\":\"summary\",\"samples\":%llu,\"time\":%.3f,\"events\":%llu,\"elapsed\":%.3f,\"speed\":%.1f}\n",
+                path,
+                (unsigned long long)(d->timestamp()),
+                duration,
+                (unsigned long long)(d->total_events()),
+                seconds,
+                duration / seconds);
+            fflush(stdout);
+        }
+
+        static char *expand_path(const char *pattern, const char *path)
+        {
+            const char *subst       = strstr(pattern, "%s");
+            if (subst == NULL)
+                return strdup(pattern);
+
+            const size_t prefix     = subst - pattern;
+            char *res               = static_cast<char *>(malloc(strlen(pattern) + strlen(path) - 1));
+            if (res == NULL)
+                return NULL;
+
+            memcpy(res, pattern, prefix);
+            strcpy(&res[prefix], path);
+            strcat(res, &subst[2]);
+            return res;
+        }
+
+        static void account_file(stats_t *st, const DamageDetector *d)
+        {
+            lsp::atomic_add(&st->nFiles, 1);
+            lsp::atomic_add(&st->nSamples, wsize_t(d->timestamp()));
+            lsp::atomic_add(&st->nEvents, wsize_t(d->total_events()));
+            lsp::atomic_add(&st->nDuration, wsize_t((d->timestamp() * 1000) / d->sample_rate()));
+        }
+
+        /**
+         * Finish processing of the file, executed by the worker after the last block
+         */
+        static void finish_file(file_t *f, stats_t *st)
+        {
+            DamageDetector *d       = f->pDetector;
+            d->set_envelope_index(NULL);
+            if (f->sIndex.close() != lsp::STATUS_OK)
+                fprintf(stderr, "Could not write envelope index for %s\n", f->sPath);
+            if (f->sJournal.opened())
+            {
+                d->set_journal(NULL);
+                f->sJournal.close();
+            }
+
+            summary(f->sPath, d, lsp::system::get_time_millis() - f->nStart);
+            account_file(st, d);
+            lsp::atomic_store(&f->bDone, 1);
+        }
+
+        /**
+         * Process the next block of the file
+         * @return true if the block has been processed
+         */
+        static bool process_file(file_t *f, BlockPool *pool, stats_t *st)
+        {
+            if (lsp::atomic_load(&f->bDone))
+                return false;
+
+            // Fetch the next block
+            f->sLock.lock();
+            block_t *b              = f->pHead;
+            if (b != NULL)
+            {
+                f->pHead                = b->pNext;
+                if (f->pHead == NULL)
+                    f->pTail                = NULL;
+            }
+            const bool eof          = f->bEof;
+            f->sLock.unlock();
+
+            if (b == NULL)
+            {
+                if (eof)
+                    finish_file(f, st);
+                return false;
+            }
+
+            // Process data and report events
+            DamageDetector *d       = f->pDetector;
+            for (size_t i=0; i<f->nChannels; ++i)
+            {
+                float *ptr              = &b->vData[i * b->nFrames];
+                d->bind_input(i, ptr);
+                d->bind_output(i, ptr);
+            }
+            d->process(b->nFrames);
+            report(f->sPath, d);
+            pool->release(b);
+
+            return true;
+        }
+
+        /**
+         * Processing of the file, executed by the scheduler. Blocks of the file are
+         * processed in order since the task is never executed by two workers at once.
+         */
+        class FileTask: public Task
+        {
+            private:
+                file_t             *pFile;
+                BlockPool          *pPool;
+                stats_t            *pStats;
+
+            public:
+                FileTask(file_t *file, BlockPool *pool, stats_t *stats)
+                {
+                    pFile       = file;
+                    pPool       = pool;
+                    pStats      = stats;
+                }
+
+            public:
+                virtual bool run() override
+                {
+                    return process_file(pFile, pPool, pStats);
+                }
+        };
+
+        static void close_file(file_t *f, BlockPool *pool)
+        {
+            for (block_t *b = f->pHead; b != NULL; )
+            {
+                block_t *next           = b->pNext;
+                pool->release(b);
+                b                       = next;
+            }
+            if (f->hFile != NULL)
+                sf_close(f->hFile);
+
+            delete f->pTask;
+            delete f->pDetector;
+            free(f->sPath);
+            delete f;
+        }
+
+        static file_t *open_file(const char *path, const config_t *cfg, BlockPool *pool, stats_t *st, EventJournal *journal)
+        {
+            int fd                  = ::open(path, O_RDONLY);
+            if (fd < 0)
+            {
+                fprintf(stderr, "Could not open file %s\n", path);
+                return NULL;
+            }
+
+            // Let the kernel read the file ahead while the detector is busy
+            struct stat sb;
+            const wsize_t bytes     = (fstat(fd, &sb) == 0) ? sb.st_size : 0;
+        #ifdef POSIX_FADV_SEQUENTIAL
+            posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+            posix_fadvise(fd, 0, READAHEAD_SIZE, POSIX_FADV_WILLNEED);
+        #endif /* POSIX_FADV_SEQUENTIAL */
+
+            SF_INFO info;
+            memset(&info, 0, sizeof(info));
+            SNDFILE *sf             = sf_open_fd(fd, SFM_READ, &info, SF_TRUE);
+            if (sf == NULL)
+            {
+                fprintf(stderr, "Could not open file %s: %s\n", path, sf_strerror(NULL));
+                ::close(fd);
+                return NULL;
+            }
+            if ((info.channels <= 0) || (size_t(info.channels) > pool->size()))
+            {
+                fprintf(stderr, "Unsupported number of channels %d in file %s\n", info.channels, path);
+                sf_close(sf);
+                return NULL;
+            }
+
+            file_t *f               = new file_t;
+            f->sPath                = strdup(path);
+            f->hFile                = sf;
+            f->hFD                  = fd;
+            f->nAhead               = READAHEAD_SIZE;
+            f->nChannels            = info.channels;
+            f->nStart               = lsp::system::get_time_millis();
+            f->pDetector            = new DamageDetector(f->nChannels);
+            f->pHead                = NULL;
+            f->pTail                = NULL;
+            f->bEof                 = false;
+            f->bDone                = 0;
+            f->pTask                = new FileTask(f, pool, st);
+
+            DamageDetector *d       = f->pDetector;
+            configure(d, cfg, info.samplerate, cfg->fReactivity);
+
+            // Open the journal of the file or use the shared one
+            if ((cfg->sJournal != NULL) && (journal == NULL))
+            {
+                char *jpath             = expand_path(cfg->sJournal, path);
+                if ((jpath == NULL) || (f->sJournal.open(jpath) != lsp::STATUS_OK))
+                    fprintf(stderr, "Could not open journal for %s\n", path);
+                free(jpath);
+                if (f->sJournal.opened())
+                    journal                 = &f->sJournal;
+            }
+            d->set_journal(journal);
+            if (journal != NULL)
+                journal->submit_format(info.samplerate, f->nChannels);
+
+            // Create the envelope index
+            if (cfg->sIndex != NULL)
+            {
+                char *ipath             = expand_path(cfg->sIndex, path);
+                if ((ipath == NULL) ||
+                    (f->sIndex.create(ipath, f->nChannels, info.samplerate, cfg->nDecimation, cfg->fReactivity) != lsp::STATUS_OK))
+                    fprintf(stderr, "Could not create envelope index for %s\n", path);
+                free(ipath);
+                if (f->sIndex.opened())
+                    d->set_envelope_index(&f->sIndex);
+            }
+
+            lsp::atomic_add(&st->nBytes, bytes);
+
+            return f;
+        }
+
+        /**
+         * Read the next block of the file
+         * @return true if the block has been read, false at the end of file
+         */
+        static bool read_block(file_t *f, block_t *b, float *buf, size_t size)
+        {
+            const size_t channels   = f->nChannels;
+            const sf_count_t count  = sf_readf_float(f->hFile, buf, size / channels);
+            if (count <= 0)
+                return false;
+
+            // De-interleave data
+            for (size_t i=0; i<channels; ++i)
+            {
+                float *dst              = &b->vData[i * count];
+                const float *src        = &buf[i];
+                for (sf_count_t j=0; j<count; ++j, src += channels)
+                    dst[j]                  = *src;
+            }
+            b->nFrames              = count;
+
+        #ifdef POSIX_FADV_WILLNEED
+            // Extend the readahead window when the half of it has been consumed
+            const off_t pos         = lseek(f->hFD, 0, SEEK_CUR);
+            if ((pos >= 0) && (wsize_t(pos) + READAHEAD_SIZE / 2 >= f->nAhead))
+            {
+                posix_fadvise(f->hFD, f->nAhead, READAHEAD_SIZE, POSIX_FADV_WILLNEED);
+                f->nAhead              += READAHEAD_SIZE;
+            }
+        #endif /* POSIX_FADV_WILLNEED */
+
+            return true;
+        }
+
+        /**
+         * Scan audio files: the calling thread reads blocks of all opened files in the
+         * round-robin order and queues them to the detection tasks executed by the pool
+         * of workers. The number of block buffers is fixed, so the reader waits when the
+         * detection does not keep up with reading.
+         */
+        static int scan_files(const file_list_t *list, const config_t *cfg, stats_t *st, EventJournal *journal, scheduler_stats_t *sst)
+        {
+            const size_t workers    = cfg->nWorkers;
+            const size_t blocks     = (cfg->nBlocks > 0) ? cfg->nBlocks : workers * BLOCKS_PER_WORKER;
+            const size_t max_open   = (journal != NULL) ? 1 : lsp::lsp_min(workers * FILES_PER_WORKER, blocks);
+
+            BlockPool pool;
+            if (!pool.init(blocks, cfg->nBlockSize))
+            {
+                fprintf(stderr, "Could not allocate block buffers\n");
+                return 2;
+            }
+            float *buf              = new float[cfg->nBlockSize];
+            lsp_finally { delete [] buf; };
+            file_t **slots          = new file_t *[max_open];
+            lsp_finally { delete [] slots; };
+            for (size_t i=0; i<max_open; ++i)
+                slots[i]                = NULL;
+
+            Scheduler scheduler;
+            if (scheduler.start(workers, max_open) != lsp::STATUS_OK)
+            {
+                fprintf(stderr, "Could not start worker threads\n");
+                return 2;
+            }
+
+            size_t next             = 0;
+            size_t active           = 0;
+            while (!bTerminate)
+            {
+                // Release finished files and open new ones
+                for (size_t i=0; i<max_open; ++i)
+                {
+                    file_t *f               = slots[i];
+                    if ((f == NULL) || (!lsp::atomic_load(&f->bDone)) || (!f->pTask->idle()))
+                        continue;
+
+                    close_file(f, &pool);
+                    slots[i]                = NULL;
+                    --active;
+                }
+
+                for (size_t i=0; (i<max_open) && (next < list->nItems); ++i)
+                {
+                    if (slots[i] != NULL)
+                        continue;
+                    while ((slots[i] == NULL) && (next < list->nItems))
+                    {
+                        const char *path        = list->vItems[next++];
+                        if ((slots[i] = open_file(path, cfg, &pool, st, journal)) != NULL)
+                            ++active;
+                        else
+                            lsp::atomic_add(&st->nFailed, 1);
+                    }
+                }
+
+                if ((active <= 0) && (next >= list->nItems))
+                    break;
+
+                // Read one block of each file
+                bool done               = false;
+                bool stall              = false;
+                for (size_t i=0; i<max_open; ++i)
+                {
+                    file_t *f               = slots[i];
+                    if ((f == NULL) || (f->bEof))
+                        continue;
+
+                    block_t *b              = pool.alloc();
+                    if (b == NULL)
+                    {
+                        stall                   = true;
+                        break;
+                    }
+
+                    const bool read         = read_block(f, b, buf, pool.size());
+                    f->sLock.lock();
+                    if (read)
+                    {
+                        b->pNext                = NULL;
+                        if (f->pTail != NULL)
+                            f->pTail->pNext         = b;
+                        else
+                            f->pHead                = b;
+                        f->pTail                = b;
+                    }
+                    else
+                        f->bEof                 = true;
+                    f->sLock.unlock();
+
+                    if (!read)
+                        pool.release(b);
+                    scheduler.submit(f->pTask);
+                    done                    = true;
+                }
+
+                if (stall)
+                    ++st->nStalls;
+                if (!done)
+                    lsp::ipc::Thread::sleep(IDLE_PERIOD);
+            }
+
+            scheduler.get_stats(sst);
+            scheduler.stop();
+            for (size_t i=0; i<max_open; ++i)
+            {
+                if (slots[i] != NULL)
+                    close_file(slots[i], &pool);
+            }
+
+            return (bTerminate) ? 1 : 0;
+        }
+
+        static bool add_file(file_list_t *list, const char *path)
+        {
+            if (list->nItems >= list->nCapacity)
+            {
+                const size_t cap        = lsp::lsp_max(list->nCapacity << 1, size_t(0x40));
+                char **items            = static_cast<char **>(realloc(list->vItems, cap * sizeof(char *)));
+                if (items == NULL)
+                    return false;
+                list->vItems            = items;
+                list->nCapacity         = cap;
+            }
+
+            char *item              = strdup(path);
+            if (item == NULL)
+                return false;
+            list->vItems[list->nItems++]    = item;
+            return true;
+        }
+
+        static void free_files(file_list_t *list)
+        {
+            for (size_t i=0; i<list->nItems; ++i)
+                free(list->vItems[i]);
+            free(list->vItems);
+            list->vItems            = NULL;
+            list->nItems            = 0;
+            list->nCapacity         = 0;
+        }
+
+        static int compare_paths(const void *a, const void *b)
+        {
+            return strcmp(*static_cast<char * const *>(a), *static_cast<char * const *>(b));
+        }
+
+        /**
+         * Add the file or all files of the directory and its subdirectories to the list,
+         * hidden files and directories are skipped
+         */
+        static bool walk(file_list_t *list, const char *path)
+        {
+            struct stat sb;
+            if (stat(path, &sb) != 0)
+            {
+                fprintf(stderr, "Could not access %s\n", path);
+                return true;
+            }
+            if (!S_ISDIR(sb.st_mode))
+                return (S_ISREG(sb.st_mode)) ? add_file(list, path) : true;
+
+            DIR *dir                = opendir(path);
+            if (dir == NULL)
+            {
+                fprintf(stderr, "Could not open directory %s\n", path);
+                return true;
+            }
+            lsp_finally { closedir(dir); };
+
+            // Process entries of the directory in the sorted order
+            file_list_t entries;
+            entries.vItems          = NULL;
+            entries.nItems          = 0;
+            entries.nCapacity       = 0;
+            lsp_finally { free_files(&entries); };
+
+            const size_t len        = strlen(path);
+            const bool slash        = (len > 0) && (path[len - 1] == '/');
+            for (struct dirent *de = readdir(dir); de != NULL; de = readdir(dir))
+            {
+                if (de->d_name[0] == '.')
+                    continue;
+
+                char *child             = static_cast<char *>(malloc(len + strlen(de->d_name) + 2));
+                if (child == NULL)
+                    return false;
+                lsp_finally { free(child); };
+
+                strcpy(child, path);
+                if (!slash)
+                    strcat(child, "/");
+                strcat(child, de->d_name);
+                if (!add_file(&entries, child))
+                    return false;
+            }
+
+            qsort(entries.vItems, entries.nItems, sizeof(char *), compare_paths);
+            for (size_t i=0; i<entries.nItems; ++i)
+            {
+                if (!walk(list, entries.vItems[i]))
+                    return false;
+            }
+
+            return true;
+        }
+
+        static int scan_index(const char *path, const config_t *cfg, stats_t *st, EventJournal *journal)
+        {
+            EnvelopeIndex index;
+            if (index.open(path) != lsp::STATUS_OK)
+            {
+                fprintf(stderr, "Could not open envelope index %s\n", path);
+                return 1;
+            }
+            lsp_finally { index.close(); };
+
+            // Each entry is restored as two runs of the envelope: the first extremum
+            // followed by the second one, so the trigger sees all threshold crossings
+            const size_t channels   = index.channels();
+            const size_t decimation = index.decimation();
+            const size_t entries    = lsp::lsp_max(cfg->nBlockSize / (decimation * channels), size_t(1));
+            const size_t block      = entries * decimation;
+            envelope_entry_t *frames= new envelope_entry_t[entries * channels];
+            lsp_finally { delete [] frames; };
+            float *buffers          = new float[block * channels];
+            lsp_finally { delete [] buffers; };
+
+            // Open the journal of the file or use the shared one
+            EventJournal fjournal;
+            if ((cfg->sJournal != NULL) && (journal == NULL))
+            {
+                char *jpath             = expand_path(cfg->sJournal, path);
+                if ((jpath == NULL) || (fjournal.open(jpath) != lsp::STATUS_OK))
+                    fprintf(stderr, "Could not open journal for %s\n", path);
+                free(jpath);
+                if (fjournal.opened())
+                    journal                 = &fjournal;
+            }
+
+            DamageDetector d(channels);
+            configure(&d, cfg, index.sample_rate(), index.reactivity());
+            d.set_journal(journal);
+            if (journal != NULL)
+                journal->submit_format(index.sample_rate(), channels);
+
+            const wssize_t start    = lsp::system::get_time_millis();
+            uint64_t left           = index.samples();
+            while ((left > 0) && (!bTerminate))
+            {
+                const size_t count      = index.read(frames, entries);
+                if (count <= 0)
+                    break;
+
+                size_t samples          = 0;
+                for (size_t i=0; i<channels; ++i)
+                {
+                    float *dst              = &buffers[i * block];
+                    uint64_t remain         = left;
+                    samples                 = 0;
+
+                    for (size_t j=0; (j<count) && (remain > 0); ++j)
+                    {
+                        const envelope_entry_t *e   = &frames[j * channels + i];
+                        const size_t length = lsp::lsp_min(remain, uint64_t(decimation));
+                        const size_t half   = length >> 1;
+
+                        lsp::dsp::fill(&dst[samples], e->fFirst, half);
+                        lsp::dsp::fill(&dst[samples + half], e->fSecond, length - half);
+                        samples            += length;
+                        remain             -= length;
+                    }
+
+                    d.bind_input(i, dst);
+                    d.bind_output(i, dst);
+                }
+
+                d.process_envelope(samples);
+                report(path, &d);
+                left                   -= samples;
+            }
+
+            summary(path, &d, lsp::system::get_time_millis() - start);
+            account_file(st, &d);
+            st->nBytes             += sizeof(envelope_header_t) + index.entries() * channels * sizeof(envelope_entry_t);
+
+            return 0;
+        }
+
+        static void print_report(const stats_t *st, const scheduler_stats_t *sst, size_t workers, size_t blocks, wssize_t elapsed)
+        {
+            const double seconds    = double(lsp::lsp_max(elapsed, wssize_t(1))) * 0.001;
+            const double duration   = double(st->nDuration) * 0.001;
+
+            printf("{\"event\":\"report\",\"files\":%llu,\"failed\":%llu,\"samples\":%llu,\"bytes\":%llu,\"time\":%.3f,\"events\":%llu,"
+                "\"elapsed\":%.3f,\"speed\":%.1f,\"frames_per_second\":%.0f,\"mbytes_per_second\":%.1f,"
+                "\"workers\":%u,\"buffers\":%u,\"stalls\":%llu,\"tasks\":%llu,\"stolen\":%llu,\"peak_queued\":%u}\n",
+                (unsigned long long)(st->nFiles),
+                (unsigned long long)(st->nFailed),
+                (unsigned long long)(st->nSamples),
+                (unsigned long long)(st->nBytes),
+                duration,
+                (unsigned long long)(st->nEvents),
+                seconds,
+                duration / seconds,
+                double(st->nSamples) / seconds,
+                double(st->nBytes) / (seconds * 1048576.0),
+                (unsigned int)(workers),
+                (unsigned int)(blocks),
+                (unsigned long long)(st->nStalls),
+                (unsigned long long)(sst->nExecuted),
+                (unsigned long long)(sst->nStolen),
+                (unsigned int)(sst->nPeakQueued));
+            fflush(stdout);
+        }
+
+        static int parse_args(config_t *cfg, size_t *first, int argc, const char **argv)
+        {
+            cfg->nWorkers           = lsp::ipc::Thread::system_cores();
+            cfg->nBlocks            = 0;
+            cfg->nBlockSize         = DFL_BLOCK_SIZE;
+            cfg->nDecimation        = EnvelopeIndex::DFL_DECIMATION;
+            cfg->fThreshold         = DamageDetector::DFL_THRESHOLD;
+            cfg->fDetectTime        = DamageDetector::DFL_DETECT_TIME;
+            cfg->fReactivity        = DamageDetector::DFL_REACTIVITY;
+            cfg->fEstimateTime      = DamageDetector::DFL_ESTIMATE_TIME;
+            cfg->fEventPeriod       = DamageDetector::DFL_EV_PERIOD;
+            cfg->nEventThreshold    = DamageDetector::DFL_EV_TRHESHOLD;
+            cfg->fClickRatio        = -1.0f;
+            cfg->sJournal           = NULL;
+            cfg->sIndex             = NULL;
+            cfg->bReanalyze         = false;
+
+            int i = 1;
+            for ( ; i < argc; ++i)
+            {
+                const char *opt = argv[i];
+                if ((!strcmp(opt, "-h")) || (!strcmp(opt, "--help")))
+                    return -1;
+                if ((opt[0] != '-') || (opt[1] == '\0') || (opt[2] != '\0'))
+                    break;
+                if (opt[1] == 'i')
+                {
+                    cfg->bReanalyze         = true;
+                    continue;
+                }
+                if (++i >= argc)
+                {
+                    fprintf(stderr, "Missing value for option %s\n", opt);
+                    return 1;
+                }
+
+                const char *value = argv[i];
+                switch (opt[1])
+                {
+                    case 'b': cfg->nBlockSize       = lsp::lsp_max(atol(value), 1L); break;
+                    case 'c': cfg->fClickRatio      = lsp::lsp_max(atof(value), 0.0); break;
+                    case 'd': cfg->fDetectTime      = atof(value); break;
+                    case 'e': cfg->fEstimateTime    = atof(value); break;
+                    case 'j': cfg->sJournal         = value; break;
+                    case 'm': cfg->nDecimation      = lsp::lsp_limit(size_t(atol(value)), EnvelopeIndex::MIN_DECIMATION, EnvelopeIndex::MAX_DECIMATION); break;
+                    case 'n': cfg->nEventThreshold  = lsp::lsp_max(atol(value), 0L); break;
+                    case 'p': cfg->fEventPeriod     = atof(value); break;
+                    case 'q': cfg->nBlocks          = lsp::lsp_max(atol(value), 1L); break;
+                    case 'r': cfg->fReactivity      = atof(value); break;
+                    case 't': cfg->fThreshold       = atof(value); break;
+                    case 'w': cfg->nWorkers         = lsp::lsp_max(atol(value), 1L); break;
+                    case 'x': cfg->sIndex           = value; break;
+                    default:
+                        fprintf(stderr, "Unknown option %s\n", opt);
+                        return 1;
+                }
+            }
+
+            if (i >= argc)
+            {
+                fprintf(stderr, "No files specified\n");
+                return 1;
+            }
+            if ((cfg->bReanalyze) && (cfg->sIndex != NULL))
+            {
+                fprintf(stderr, "Options -i and -x are mutually exclusive\n");
+                return 1;
+            }
+
+            *first = i;
+            return 0;
+        }
+
+        static int main(int argc, const char **argv)
+        {
+            config_t cfg;
+            size_t first = 0;
+            int res = parse_args(&cfg, &first, argc, argv);
+            if (res != 0)
+            {
+                print_usage(argv[0]);
+                return (res < 0) ? 0 : res;
+            }
+
+            lsp::dsp::init();
+
+            // Collect files
+            file_list_t files;
+            files.vItems            = NULL;
+            files.nItems            = 0;
+            files.nCapacity         = 0;
+            lsp_finally { free_files(&files); };
+
+            for (int i=first; i<argc; ++i)
+            {
+                if (!walk(&files, argv[i]))
+                {
+                    fprintf(stderr, "Not enough memory\n");
+                    return 2;
+                }
+            }
+
+            // The journal without file name substitution is shared by all files
+            EventJournal journal;
+            if ((cfg.sJournal != NULL) && (strstr(cfg.sJournal, "%s") == NULL))
+            {
+                if (journal.open(cfg.sJournal) != lsp::STATUS_OK)
+                {
+                    fprintf(stderr, "Could not open journal %s\n", cfg.sJournal);
+                    return 1;
+                }
+            }
+            lsp_finally { journal.close(); };
+            EventJournal *pj        = (journal.opened()) ? &journal : NULL;
+
+            signal(SIGINT, on_signal);
+            signal(SIGTERM, on_signal);
+
+            stats_t st;
+            memset(&st, 0, sizeof(st));
+            scheduler_stats_t sst;
+            memset(&sst, 0, sizeof(sst));
+
+            const wssize_t start    = lsp::system::get_time_millis();
+            if (cfg.bReanalyze)
+            {
+                for (size_t i=0; (i<files.nItems) && (!bTerminate); ++i)
+                {
+                    if (scan_index(files.vItems[i], &cfg, &st, pj) != 0)
+                        ++st.nFailed;
+                }
+            }
+            else
+                res     = scan_files(&files, &cfg, &st, pj, &sst);
+
+            const size_t blocks     = (cfg.nBlocks > 0) ? cfg.nBlocks : cfg.nWorkers * BLOCKS_PER_WORKER;
+            print_report(&st, &sst, (cfg.bReanalyze) ? 1 : cfg.nWorkers, (cfg.bReanalyze) ? 0 : blocks,
+                lsp::system::get_time_millis() - start);
+
+            return ((res == 0) && (st.nFailed > 0)) ? 1 : res;
+        }
+
+    } /* namespace scan */
+} /* namespace dd */
+
+int main(int argc, const char **argv)
+{
+    return dd::scan::main(argc, argv);
+}
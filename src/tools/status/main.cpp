@@ -0,0 +1,171 @@
+/*
+ * Copyright (C) 2024 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2024 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of damage-detector
+ * Created on: 18 окт. 2026 г.
+ *
+ * damage-detector is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * damage-detector is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with damage-detector. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <lsp-plug.in/common/finally.h>
+#include <lsp-plug.in/common/types.h>
+
+#include <private/StatusPage.h>
+
+#include <stdio.h>
+#include <string.h>
+
+#ifdef PLATFORM_UNIX_COMPATIBLE
+    #include <fcntl.h>
+    #include <sched.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif /* PLATFORM_UNIX_COMPATIBLE */
+
+namespace dd
+{
+    namespace status
+    {
+        static constexpr size_t READ_ATTEMPTS   = 1000;
+
+        static void print_usage(const char *name)
+        {
+            fprintf(stderr, "Usage: %s <status-file> [<status-file>...]\n", name);
+            fprintf(stderr, "Prints the status pages of damage detectors as JSON lines.\n");
+        }
+
+    #ifdef PLATFORM_UNIX_COMPATIBLE
+        static const status_page_t *map_page(const char *path)
+        {
+            int fd = open(path, O_RDONLY);
+            if (fd < 0)
+                return NULL;
+            lsp_finally { close(fd); };
+
+            struct stat st;
+            if ((fstat(fd, &st) != 0) || (size_t(st.st_size) < sizeof(status_page_t)))
+                return NULL;
+
+            void *addr = mmap(NULL, sizeof(status_page_t), PROT_READ, MAP_SHARED, fd, 0);
+            return (addr != MAP_FAILED) ? static_cast<const status_page_t *>(addr) : NULL;
+        }
+
+        static void unmap_page(const status_page_t *page)
+        {
+            munmap(const_cast<status_page_t *>(page), sizeof(status_page_t));
+        }
+
+        static void print_page(const char *path, const status_page_t *st)
+        {
+            printf("{\"file\":\"%s\",\"sample_rate\":%u,\"samples\":%llu,\"events\":%u,\"total_events\":%llu,"
+                "\"corrupted\":%s,\"events_1s\":%u,\"events_10s\":%u,\"events_1m\":%u,\"events_10m\":%u",
+                path,
+                (unsigned int)(st->nSampleRate),
+                (unsigned long long)(st->nSamples),
+                (unsigned int)(st->nEvents),
+                (unsigned long long)(st->nTotalEvents),
+                (st->nFlags & STATUS_CORRUPTED) ? "true" : "false",
+                (unsigned int)(st->vWindowEvents[EV_WINDOW_1S]),
+                (unsigned int)(st->vWindowEvents[EV_WINDOW_10S]),
+                (unsigned int)(st->vWindowEvents[EV_WINDOW_1M]),
+                (unsigned int)(st->vWindowEvents[EV_WINDOW_10M]));
+            if (st->nFlags & STATUS_EVENTS)
+            {
+                printf(",\"last_event\":%llu", (unsigned long long)(st->nLastEvent));
+                if (st->nLastEventPts != STATUS_NO_PTS)
+                    printf(",\"last_event_pts\":%lld", (long long)(st->nLastEventPts));
+            }
+
+            printf(",\"channels\":[");
+            const size_t channels = lsp::lsp_min(size_t(st->nChannels), STATUS_MAX_CHANNELS);
+            for (size_t i=0; i<channels; ++i)
+            {
+                const status_channel_t *c = &st->vChannels[i];
+                printf("%s{\"state\":%u,\"events\":%u,\"threshold\":%.1f,\"flatline\":%s}",
+                    (i > 0) ? "," : "",
+                    (unsigned int)(c->nState),
+                    (unsigned int)(c->nEvents),
+                    c->fThreshold,
+                    (c->nFlags & STATUS_CH_FLATLINE) ? "true" : "false");
+            }
+            printf("]}\n");
+        }
+
+        static int main(int argc, const char **argv)
+        {
+            if ((argc < 2) || (!strcmp(argv[1], "-h")) || (!strcmp(argv[1], "--help")))
+            {
+                print_usage(argv[0]);
+                return (argc < 2) ? 1 : 0;
+            }
+
+            int res = 0;
+            for (int i=1; i<argc; ++i)
+            {
+                const status_page_t *page = map_page(argv[i]);
+                if (page == NULL)
+                {
+                    fprintf(stderr, "Could not open status page %s\n", argv[i]);
+                    res = 1;
+                    continue;
+                }
+                lsp_finally { unmap_page(page); };
+
+                if ((page->nMagic != STATUS_PAGE_MAGIC) || (page->nVersion != STATUS_PAGE_VERSION))
+                {
+                    fprintf(stderr, "Unsupported status page format %s\n", argv[i]);
+                    res = 2;
+                    continue;
+                }
+
+                // Retry while the page is being updated by the streaming thread
+                status_page_t st;
+                bool read = false;
+                for (size_t j=0; (j < READ_ATTEMPTS) && (!read); ++j)
+                {
+                    read = StatusPage::read(&st, page);
+                    if (!read)
+                        sched_yield();
+                }
+
+                if (!read)
+                {
+                    fprintf(stderr, "Could not read consistent status page %s\n", argv[i]);
+                    res = 3;
+                    continue;
+                }
+
+                print_page(argv[i], &st);
+            }
+
+            return res;
+        }
+    #else
+        static int main(int argc, const char **argv)
+        {
+            fprintf(stderr, "Status pages are not supported on this platform\n");
+            return 1;
+        }
+    #endif /* PLATFORM_UNIX_COMPATIBLE */
+
+    } /* namespace status */
+} /* namespace dd */
+
+int main(int argc, const char **argv)
+{
+    return dd::status::main(argc, argv);
+}